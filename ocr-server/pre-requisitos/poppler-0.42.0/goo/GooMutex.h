@@ -76,7 +76,11 @@ inline void gInitMutex(GooMutex *m) {
 class MutexLocker {
 public:
   MutexLocker(GooMutex *mutexA) : mutex(mutexA) { gLockMutex(mutex); }
-  ~MutexLocker() { gUnlockMutex(mutex); }
+  // Only locks the mutex if lock is true.
+  MutexLocker(GooMutex *mutexA, bool lock) : mutex(lock ? mutexA : NULL) {
+    if (mutex) gLockMutex(mutex);
+  }
+  ~MutexLocker() { if (mutex) gUnlockMutex(mutex); }
 
 private:
   GooMutex *mutex;
@@ -31,6 +31,7 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #include "goo/gmem.h"
 #include "Object.h"
 #include "Array.h"
@@ -46,8 +47,9 @@
 
 Array::Array(XRef *xrefA) {
   xref = xrefA;
-  elems = NULL;
-  size = length = 0;
+  elems = inlineElems;
+  size = arrayInlineSize;
+  length = 0;
   ref = 1;
 #if MULTITHREADED
   gInitMutex(&mutex);
@@ -59,7 +61,9 @@ Array::~Array() {
 
   for (i = 0; i < length; ++i)
     elems[i].free();
-  gfree(elems);
+  if (elems != inlineElems) {
+    gfree(elems);
+  }
 #if MULTITHREADED
   gDestroyMutex(&mutex);
 #endif
@@ -90,12 +94,13 @@ int Array::decRef() {
 void Array::add(Object *elem) {
   arrayLocker();
   if (length == size) {
-    if (length == 0) {
-      size = 8;
+    size *= 2;
+    if (elems == inlineElems) {
+      elems = (Object *)gmallocn(size, sizeof(Object));
+      memcpy(elems, inlineElems, length * sizeof(Object));
     } else {
-      size *= 2;
+      elems = (Object *)greallocn(elems, size, sizeof(Object));
     }
-    elems = (Object *)greallocn(elems, size, sizeof(Object));
   }
   elems[length] = *elem;
   ++length;
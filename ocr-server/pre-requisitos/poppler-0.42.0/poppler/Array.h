@@ -39,6 +39,10 @@ class XRef;
 // Array
 //------------------------------------------------------------------------
 
+// Arrays with up to this many elements, such as rectangles, matrices and
+// the stream list of a Lexer, keep them in the Array object itself.
+#define arrayInlineSize 8
+
 class Array {
 public:
 
@@ -73,6 +77,7 @@ private:
 
   XRef *xref;			// the xref table for this PDF file
   Object *elems;		// array of elements
+  Object inlineElems[arrayInlineSize]; // <elems> of small arrays
   int size;			// size of <elems> array
   int length;			// number of elements in array
   int ref;			// reference count
@@ -74,6 +74,7 @@ DCTStream::DCTStream(Stream *strA, int colorXformA, Object *dict, int recursion)
     obj.free();
   } else
     err.height = err.width = 0;
+  reduction = 1;
   init();
 }
 
@@ -191,6 +192,11 @@ void DCTStream::reset() {
 	break;
       }
 
+      // libjpeg scales in the DCT domain, skipping most of the IDCT and
+      // color conversion work
+      cinfo.scale_num = 1;
+      cinfo.scale_denom = reduction;
+
       jpeg_start_decompress(&cinfo);
 
       row_stride = cinfo.output_width * cinfo.output_components;
@@ -248,6 +254,12 @@ int DCTStream::lookChar() {
   return *current;
 }
 
+int DCTStream::reduceResolution(int factor) {
+  // the scale factors every libjpeg version supports
+  for (reduction = 8; reduction > 1 && reduction > factor; reduction /= 2) ;
+  return reduction;
+}
+
 GooString *DCTStream::getPSFilter(int psLevel, const char *indent) {
   GooString *s;
 
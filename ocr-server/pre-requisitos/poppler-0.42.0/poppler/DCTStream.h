@@ -72,6 +72,7 @@ public:
   virtual int lookChar();
   virtual GooString *getPSFilter(int psLevel, const char *indent);
   virtual GBool isBinary(GBool last = gTrue);
+  virtual int reduceResolution(int factor);
 
 private:
   void init();
@@ -80,6 +81,7 @@ private:
   virtual int getChars(int nChars, Guchar *buffer);
 
   int colorXform;
+  int reduction;		// libjpeg scale_denom: 1, 2, 4 or 8
   JSAMPLE *current;
   JSAMPLE *limit;
   struct jpeg_decompress_struct cinfo;
@@ -77,8 +77,9 @@ static int binarySearch(const char *key, DictEntry *entries, int length)
 
 Dict::Dict(XRef *xrefA) {
   xref = xrefA;
-  entries = NULL;
-  size = length = 0;
+  entries = inlineEntries;
+  size = dictInlineSize;
+  length = 0;
   ref = 1;
   sorted = gFalse;
 #if MULTITHREADED
@@ -88,16 +89,22 @@ Dict::Dict(XRef *xrefA) {
 
 Dict::Dict(Dict* dictA) {
   xref = dictA->xref;
-  size = length = dictA->length;
+  length = dictA->length;
   ref = 1;
 #if MULTITHREADED
   gInitMutex(&mutex);
 #endif
 
   sorted = dictA->sorted;
-  entries = (DictEntry *)gmallocn(size, sizeof(DictEntry));
+  if (length <= dictInlineSize) {
+    entries = inlineEntries;
+    size = dictInlineSize;
+  } else {
+    entries = (DictEntry *)gmallocn(length, sizeof(DictEntry));
+    size = length;
+  }
   for (int i=0; i<length; i++) {
-    entries[i].key = copyString(dictA->entries[i].key);
+    entries[i].key = copyName(dictA->entries[i].key);
     dictA->entries[i].val.copy(&entries[i].val);
   }
 }
@@ -123,10 +130,12 @@ Dict::~Dict() {
   int i;
 
   for (i = 0; i < length; ++i) {
-    gfree(entries[i].key);
+    freeName(entries[i].key);
     entries[i].val.free();
   }
-  gfree(entries);
+  if (entries != inlineEntries) {
+    gfree(entries);
+  }
 #if MULTITHREADED
   gDestroyMutex(&mutex);
 #endif
@@ -153,12 +162,13 @@ void Dict::add(char *key, Object *val) {
   }
 
   if (length == size) {
-    if (length == 0) {
-      size = 8;
+    size *= 2;
+    if (entries == inlineEntries) {
+      entries = (DictEntry *)gmallocn(size, sizeof(DictEntry));
+      memcpy(entries, inlineEntries, length * sizeof(DictEntry));
     } else {
-      size *= 2;
+      entries = (DictEntry *)greallocn(entries, size, sizeof(DictEntry));
     }
-    entries = (DictEntry *)greallocn(entries, size, sizeof(DictEntry));
   }
   entries[length].key = key;
   entries[length].val = *val;
@@ -199,7 +209,7 @@ void Dict::remove(const char *key) {
     const int pos = binarySearch(key, entries, length);
     if (pos != -1) {
       length -= 1;
-      gfree(entries[pos].key);
+      freeName(entries[pos].key);
       entries[pos].val.free();
       if (pos != length) {
         memmove(&entries[pos], &entries[pos + 1], (length - pos) * sizeof(DictEntry));
@@ -223,7 +233,7 @@ void Dict::remove(const char *key) {
       return;
     }
     //replace the deleted entry with the last entry
-    gfree(entries[i].key);
+    freeName(entries[i].key);
     entries[i].val.free();
     length -= 1;
     tmp = entries[length];
@@ -244,7 +254,7 @@ void Dict::set(const char *key, Object *val) {
     e->val.free();
     e->val = *val;
   } else {
-    add (copyString(key), val);
+    add (copyName(key), val);
   }
 }
 
@@ -40,6 +40,10 @@
 // Dict
 //------------------------------------------------------------------------
 
+// Dictionaries with up to this many entries, which are most of them,
+// keep the entries in the Dict object itself.
+#define dictInlineSize 8
+
 struct DictEntry {
   char *key;
   Object val;
@@ -63,7 +67,8 @@ public:
   // Get number of entries.
   int getLength() { return length; }
 
-  // Add an entry.  NB: does not copy key.
+  // Add an entry.  NB: does not copy key, which is freed with freeName()
+  // (a name atom can be used as is).
   void add(char *key, Object *val);
 
   // Update the value of an existing entry, otherwise create it
@@ -99,6 +104,7 @@ private:
   GBool sorted;
   XRef *xref;			// the xref table for this PDF file
   DictEntry *entries;		// array of entries
+  DictEntry inlineEntries[dictInlineSize]; // <entries> of small dicts
   int size;			// size of <entries> array
   int length;			// number of entries in dictionary
   int ref;			// reference count
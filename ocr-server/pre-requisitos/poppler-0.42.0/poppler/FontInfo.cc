@@ -38,9 +38,15 @@
 #include "Dict.h"
 #include "GfxFont.h"
 #include "Annot.h"
+#include "Lexer.h"
+#include "Parser.h"
 #include "PDFDoc.h"
 #include "FontInfo.h"
 
+// max nesting of form XObjects, patterns and annotation appearances
+// followed by PageTextScanner
+#define maxTextScanDepth 20
+
 FontInfoScanner::FontInfoScanner(PDFDoc *docA, int firstPage) {
   doc = docA;
   currentPage = firstPage + 1;
@@ -243,3 +249,294 @@ FontInfo::~FontInfo() {
   if (substituteName)
     delete substituteName;
 }
+
+//------------------------------------------------------------------------
+// PageTextScanner
+//------------------------------------------------------------------------
+
+PageTextScanner::PageTextScanner(PDFDoc *docA) {
+  doc = docA;
+  xref = doc->getXRef();
+}
+
+PageTextScanner::~PageTextScanner() {
+}
+
+GBool PageTextScanner::pageHasText(int pg) {
+  Page *page;
+  Dict *resDict;
+  Object annots, contents;
+  GBool found;
+
+  if (pg < 1 || pg > doc->getNumPages() || !(page = doc->getPage(pg))) {
+    return gFalse;
+  }
+
+  // no fonts anywhere: nothing can show text, and there is no need to
+  // decode the content streams (the common case for scanned pages)
+  found = pageHasFonts(pg);
+
+  if (found) {
+    resDict = page->getResourceDict();
+    page->getAnnots(&annots);
+    visitedObjects.clear();
+    page->getContents(&contents);
+    found = contentHasText(&contents, resDict, 0) ||
+            scanAnnots(&annots, gTrue);
+    contents.free();
+    annots.free();
+  }
+  return found;
+}
+
+GBool PageTextScanner::pageHasFonts(int pg) {
+  Page *page;
+  Dict *resDict;
+  Object annots;
+  GBool found;
+
+  if (pg < 1 || pg > doc->getNumPages() || !(page = doc->getPage(pg))) {
+    return gFalse;
+  }
+  resDict = page->getResourceDict();
+  page->getAnnots(&annots);
+  visitedObjects.clear();
+  found = (resDict && hasFonts(resDict, 0)) || scanAnnots(&annots, gFalse);
+  annots.free();
+  return found;
+}
+
+GBool PageTextScanner::hasFonts(Dict *resDict, int depth) {
+  Object obj1, obj2, objDict, resObj;
+  GBool found;
+  int i;
+
+  if (depth > maxTextScanDepth) {
+    return gFalse;
+  }
+
+  resDict->lookup("Font", &obj1);
+  found = obj1.isDict() && obj1.dictGetLength() > 0;
+  obj1.free();
+
+  // resource dictionaries of form XObjects and tiling patterns
+  const char *resTypes[] = { "XObject", "Pattern" };
+  for (Guint resType = 0; !found && resType < sizeof(resTypes) / sizeof(resTypes[0]); ++resType) {
+    resDict->lookup(resTypes[resType], &objDict);
+    if (objDict.isDict()) {
+      for (i = 0; !found && i < objDict.dictGetLength(); ++i) {
+        objDict.dictGetValNF(i, &obj1);
+        if (obj1.isRef()) {
+          const Ref r = obj1.getRef();
+          if (visitedObjects.find(r.num) != visitedObjects.end()) {
+            obj1.free();
+            continue;
+          }
+          visitedObjects.insert(r.num);
+        }
+        obj1.fetch(xref, &obj2);
+        if (obj2.isStream()) {
+          obj2.streamGetDict()->lookup("Resources", &resObj);
+          if (resObj.isDict() && resObj.getDict() != resDict) {
+            found = hasFonts(resObj.getDict(), depth + 1);
+          }
+          resObj.free();
+        }
+        obj1.free();
+        obj2.free();
+      }
+    }
+    objDict.free();
+  }
+  return found;
+}
+
+// Looks at the normal appearance streams of the visible annotations in
+// <annots>: for fonts in their resources if <text> is false, for text
+// drawn by them if it is true.
+GBool PageTextScanner::scanAnnots(Object *annots, GBool text) {
+  Object annot, flags, ap, apN, state, res;
+  GBool found;
+  int i, j, n;
+
+  found = gFalse;
+  if (!annots->isArray()) {
+    return found;
+  }
+  for (i = 0; !found && i < annots->arrayGetLength(); ++i) {
+    if (annots->arrayGet(i, &annot)->isDict()) {
+      // skip hidden annotations
+      if (annot.dictLookup("F", &flags)->isInt() && (flags.getInt() & 2)) {
+        flags.free();
+        annot.free();
+        continue;
+      }
+      flags.free();
+      if (annot.dictLookup("AP", &ap)->isDict()) {
+        // N is either a stream or a dictionary of appearance states
+        ap.dictLookup("N", &apN);
+        n = apN.isDict() ? apN.dictGetLength() : 1;
+        for (j = 0; !found && j < n; ++j) {
+          if (apN.isDict()) {
+            apN.dictGetVal(j, &state);
+          } else {
+            apN.copy(&state);
+          }
+          if (state.isStream() &&
+              state.streamGetDict()->lookup("Resources", &res)->isDict()) {
+            if (text) {
+              found = contentHasText(&state, res.getDict(), 1);
+            } else {
+              found = hasFonts(res.getDict(), 1);
+            }
+          }
+          if (state.isStream()) {
+            res.free();
+          }
+          state.free();
+        }
+        apN.free();
+      }
+      ap.free();
+    }
+    annot.free();
+  }
+  return found;
+}
+
+GBool PageTextScanner::contentHasText(Object *content, Dict *resDict,
+                                      int depth) {
+  Parser *parser;
+  Object obj, last, obj2;
+  GooString *s;
+  const char *cmd;
+  GBool found;
+  int i;
+
+  if (depth > maxTextScanDepth) {
+    return gFalse;
+  }
+  if (content->isArray()) {
+    for (i = 0; i < content->arrayGetLength(); ++i) {
+      content->arrayGet(i, &obj);
+      if (!obj.isStream()) {
+        error(errSyntaxError, -1, "Weird page contents");
+        obj.free();
+        return gFalse;
+      }
+      obj.free();
+    }
+  } else if (!content->isStream()) {
+    return gFalse;
+  }
+
+  // only the last operand of each operator matters here
+  found = gFalse;
+  last.initNull();
+  parser = new Parser(xref, new Lexer(xref, content), gFalse);
+  parser->getObj(&obj);
+  while (!found && !obj.isEOF()) {
+    if (obj.isCmd()) {
+      cmd = obj.getCmd();
+      if (!strcmp(cmd, "Tj") || !strcmp(cmd, "'") || !strcmp(cmd, "\"")) {
+        found = last.isString() && last.getString()->getLength() > 0;
+      } else if (!strcmp(cmd, "TJ")) {
+        if (last.isArray()) {
+          for (i = 0; !found && i < last.arrayGetLength(); ++i) {
+            if (last.arrayGet(i, &obj2)->isString()) {
+              s = obj2.getString();
+              found = s->getLength() > 0;
+            }
+            obj2.free();
+          }
+        }
+      } else if (!strcmp(cmd, "Do")) {
+        if (last.isName() && resDict) {
+          found = xObjectHasText(resDict, last.getName(), depth);
+        }
+      } else if (!strcmp(cmd, "BI")) {
+        skipInlineImage(parser);
+      }
+      obj.free();
+      last.free();
+      last.initNull();
+    } else {
+      last.free();
+      last = obj;
+    }
+    parser->getObj(&obj);
+  }
+  obj.free();
+  last.free();
+  delete parser;
+  return found;
+}
+
+GBool PageTextScanner::xObjectHasText(Dict *resDict, const char *name,
+                                      int depth) {
+  Object xObjDict, ref, xObj, subtype, resObj;
+  Dict *formResDict;
+  GBool found;
+
+  found = gFalse;
+  if (resDict->lookup("XObject", &xObjDict)->isDict()) {
+    xObjDict.dictLookupNF(name, &ref);
+    if (ref.isRef()) {
+      const Ref r = ref.getRef();
+      if (visitedObjects.find(r.num) != visitedObjects.end()) {
+        ref.free();
+        xObjDict.free();
+        return gFalse;
+      }
+      visitedObjects.insert(r.num);
+    }
+    ref.fetch(xref, &xObj);
+    if (xObj.isStream() &&
+        xObj.streamGetDict()->lookup("Subtype", &subtype)->isName("Form")) {
+      // forms without their own resources use the ones of the caller
+      xObj.streamGetDict()->lookup("Resources", &resObj);
+      formResDict = resObj.isDict() ? resObj.getDict() : resDict;
+      found = contentHasText(&xObj, formResDict, depth + 1);
+      resObj.free();
+    }
+    if (xObj.isStream()) {
+      subtype.free();
+    }
+    xObj.free();
+    ref.free();
+  }
+  xObjDict.free();
+  return found;
+}
+
+// Skips an inline image: its dictionary up to the ID operator, and then
+// the raw data up to EI, without decoding it.
+void PageTextScanner::skipInlineImage(Parser *parser) {
+  Object obj;
+  Stream *str;
+  int c0, c1, c2, c3;
+
+  parser->getObj(&obj);
+  while (!obj.isCmd("ID") && !obj.isEOF()) {
+    obj.free();
+    parser->getObj(&obj);
+  }
+  if (obj.isEOF() || !(str = parser->getStream())) {
+    obj.free();
+    return;
+  }
+  obj.free();
+
+  // EI must be a token of its own: image data may contain those bytes
+  c0 = ' ';
+  c1 = str->getChar();
+  c2 = str->getChar();
+  c3 = str->getChar();
+  while (c3 != EOF && !(Lexer::isSpace(c0) && c1 == 'E' && c2 == 'I' &&
+                        Lexer::isSpace(c3))) {
+    c0 = c1;
+    c1 = c2;
+    c2 = c3;
+    c3 = str->getChar();
+  }
+}
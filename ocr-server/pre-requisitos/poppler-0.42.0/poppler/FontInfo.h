@@ -31,6 +31,7 @@
 
 class GfxFont;
 class PDFDoc;
+class Parser;
 
 class FontInfo {
 public:
@@ -100,4 +101,45 @@ private:
   void scanFonts(XRef *xrefA, Dict *resDict, GooList *fontsList);
 };
 
+//------------------------------------------------------------------------
+// PageTextScanner
+//
+// Answers "does this page draw any text?" (visible or not, e.g. the
+// invisible layer of an OCRed scan) without building GfxFonts or
+// running Gfx.  A page whose resources, including those of the form
+// XObjects and annotation appearances it uses, have no Font entry is
+// reported as having no text straight away; otherwise the content
+// streams are tokenized until the first text-showing operator with a
+// non-empty string.
+//------------------------------------------------------------------------
+
+class PageTextScanner {
+public:
+
+  // Constructor.
+  PageTextScanner(PDFDoc *docA);
+  // Destructor.
+  ~PageTextScanner();
+
+  // Returns gTrue if page <pg> (1-based) shows any text.
+  GBool pageHasText(int pg);
+
+  // Returns gTrue if page <pg> has any font in its resources (which is
+  // what a non-empty pdffonts listing means), without scanning the
+  // content streams.
+  GBool pageHasFonts(int pg);
+
+private:
+
+  GBool hasFonts(Dict *resDict, int depth);
+  GBool scanAnnots(Object *annots, GBool text);
+  GBool contentHasText(Object *content, Dict *resDict, int depth);
+  GBool xObjectHasText(Dict *resDict, const char *name, int depth);
+  void skipInlineImage(Parser *parser);
+
+  PDFDoc *doc;
+  XRef *xref;
+  std::set<int> visitedObjects;
+};
+
 #endif
@@ -114,17 +114,35 @@ void FormWidget::createWidgetAnnotation() {
   obj1.free();
 }
 
+AnnotWidget *FormWidget::getWidgetAnnotation() const {
+  // created on first use: most documents only need the widget
+  // annotations of the pages which are displayed
+  Form *form = doc->getCatalog()->getForm();
+  AnnotWidget *annot;
+
+  if (form) {
+    form->lockWidgets();
+  }
+  if (!widget) {
+    const_cast<FormWidget *>(this)->createWidgetAnnotation();
+  }
+  annot = widget;
+  if (form) {
+    form->unlockWidgets();
+  }
+  return annot;
+}
+
 GBool FormWidget::inRect(double x, double y) const {
-  return widget ? widget->inRect(x, y) : gFalse;
+  return getWidgetAnnotation()->inRect(x, y);
 }
 
 void FormWidget::getRect(double *x1, double *y1, double *x2, double *y2) const {
-  if (widget)
-    widget->getRect(x1, y1, x2, y2);
+  getWidgetAnnotation()->getRect(x1, y1, x2, y2);
 }
 
 double FormWidget::getFontSize() const {
-  return widget ? widget->getFontSize() : 0.;
+  return getWidgetAnnotation()->getFontSize();
 }
 
 bool FormWidget::isReadOnly() const
@@ -160,11 +178,11 @@ GooString *FormWidget::getFullyQualifiedName() {
 }
 
 LinkAction *FormWidget::getActivationAction() {
-  return widget ? widget->getAction() : NULL;
+  return getWidgetAnnotation()->getAction();
 }
 
 LinkAction *FormWidget::getAdditionalAction(Annot::FormAdditionalActionsType type) {
-  return widget ? widget->getFormAdditionalAction(type) : NULL;
+  return getWidgetAnnotation()->getFormAdditionalAction(type);
 }
 
 FormWidgetButton::FormWidgetButton (PDFDoc *docA, Object *aobj, unsigned num, Ref ref, FormField *p) :
@@ -214,9 +232,7 @@ FormButtonType FormWidgetButton::getButtonType () const
 }
 
 void FormWidgetButton::setAppearanceState(const char *state) {
-  if (!widget)
-    return;
-  widget->setAppearanceState(state);
+  getWidgetAnnotation()->setAppearanceState(state);
 }
 
 void FormWidgetButton::updateWidgetAppearance()
@@ -263,8 +279,7 @@ GooString* FormWidgetText::getContentCopy ()
 
 void FormWidgetText::updateWidgetAppearance()
 {
-  if (widget)
-    widget->updateAppearanceStream();
+  getWidgetAnnotation()->updateAppearanceStream();
 }
 
 bool FormWidgetText::isMultiline () const 
@@ -377,8 +392,7 @@ GooString* FormWidgetChoice::getEditChoice ()
 
 void FormWidgetChoice::updateWidgetAppearance()
 {
-  if (widget)
-    widget->updateAppearanceStream();
+  getWidgetAnnotation()->updateAppearanceStream();
 }
 
 bool FormWidgetChoice::isSelected (int i)
@@ -647,16 +661,6 @@ void FormField::fillChildrenSiblingsID()
   }
 }
 
-void FormField::createWidgetAnnotations() {
-  if (terminal) {
-    for (int i = 0; i < numChildren; i++)
-      widgets[i]->createWidgetAnnotation();
-  } else {
-    for (int i = 0; i < numChildren; i++)
-      children[i]->createWidgetAnnotations();
-  }
-}
-
 void FormField::_createWidget (Object *obj, Ref aref)
 {
   terminal = true;
@@ -683,6 +687,21 @@ void FormField::_createWidget (Object *obj, Ref aref)
   }
 }
 
+void FormField::addWidgetsByRef(std::map<int, FormWidget *> *widgetsByRef)
+{
+  if (terminal) {
+    for (int i = 0; i < numChildren; i++) {
+      // the first one wins, as with findWidgetByRef()
+      widgetsByRef->insert(std::make_pair(widgets[i]->getRef().num,
+                                          widgets[i]));
+    }
+  } else {
+    for (int i = 0; i < numChildren; i++) {
+      children[i]->addWidgetsByRef(widgetsByRef);
+    }
+  }
+}
+
 FormWidget* FormField::findWidgetByRef (Ref aref)
 {
   if (terminal) {
@@ -1559,6 +1578,9 @@ Form::Form(PDFDoc *docA, Object* acroFormA)
   doc = docA;
   xref = doc->getXRef();
   acroForm = acroFormA;
+#if MULTITHREADED
+  gInitMutex(&widgetsMutex);
+#endif
   
   size = 0;
   numFields = 0;
@@ -1643,6 +1665,9 @@ Form::~Form() {
   gfree (rootFields);
   delete defaultAppearance;
   delete defaultResources;
+#if MULTITHREADED
+  gDestroyMutex(&widgetsMutex);
+#endif
   resDict.free();
 }
 
@@ -1708,23 +1733,35 @@ FormField *Form::createFieldFromDict (Object* obj, PDFDoc *docA, const Ref& pref
 
 void Form::postWidgetsLoad()
 {
-  // We create the widget annotations associated to
-  // every form widget here, because the AnnotWidget constructor
-  // needs the form object that gets from the catalog. When constructing
-  // a FormWidget the Catalog is still creating the form object
+  // The widget annotations associated to the form widgets are created
+  // when they are first used (the AnnotWidget constructor needs the form
+  // object that gets from the catalog, which is set by now): a page
+  // only creates its own.  Annots looks each of them up by reference.
   for (int i = 0; i < numFields; i++) {
     rootFields[i]->fillChildrenSiblingsID();
-    rootFields[i]->createWidgetAnnotations();
+    rootFields[i]->addWidgetsByRef(&widgetsByRef);
   }
 }
 
+void Form::lockWidgets() {
+#if MULTITHREADED
+  gLockMutex(&widgetsMutex);
+#endif
+}
+
+void Form::unlockWidgets() {
+#if MULTITHREADED
+  gUnlockMutex(&widgetsMutex);
+#endif
+}
+
 FormWidget* Form::findWidgetByRef (Ref aref)
 {
-  for(int i=0; i<numFields; i++) {
-    FormWidget *result = rootFields[i]->findWidgetByRef(aref);
-    if(result) return result;
+  std::map<int, FormWidget *>::iterator it = widgetsByRef.find(aref.num);
+  if (it == widgetsByRef.end() || it->second->getRef().gen != aref.gen) {
+    return NULL;
   }
-  return NULL;
+  return it->second;
 }
 
 //------------------------------------------------------------------------
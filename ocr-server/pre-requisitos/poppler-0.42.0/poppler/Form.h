@@ -23,9 +23,11 @@
 #pragma interface
 #endif
 
+#include "goo/GooMutex.h"
 #include "Object.h"
 #include "Annot.h"
 
+#include <map>
 #include <set>
 
 class GooString;
@@ -115,7 +117,8 @@ public:
   static void decodeID (unsigned id, unsigned* pageNum, unsigned* fieldNum);
 
   void createWidgetAnnotation();
-  AnnotWidget *getWidgetAnnotation() const { return widget; }
+  // Get the widget annotation, which is created on first use.
+  AnnotWidget *getWidgetAnnotation() const;
 
   virtual void updateWidgetAppearance() = 0;
 
@@ -287,14 +290,13 @@ public:
   GooString *getFullyQualifiedName();
 
   FormWidget* findWidgetByRef (Ref aref);
+  void addWidgetsByRef(std::map<int, FormWidget *> *widgetsByRef);
   int getNumWidgets() { return terminal ? numChildren : 0; }
   FormWidget *getWidget(int i) { return terminal ? widgets[i] : NULL; }
 
   // only implemented in FormFieldButton
   virtual void fillChildrenSiblingsID ();
 
-  void createWidgetAnnotations();
-
 #ifdef DEBUG_FORMS
   void printTree(int indent = 0);
   virtual void print(int indent = 0);
@@ -541,6 +543,11 @@ public:
   FormWidget* findWidgetByRef (Ref aref);
 
   void postWidgetsLoad();
+
+  // Guard the creation of the widget annotations, which are made on
+  // first use, possibly by several threads sharing the document.
+  void lockWidgets();
+  void unlockWidgets();
 private:
   FormField** rootFields;
   int numFields;
@@ -555,6 +562,13 @@ private:
   // Variable Text
   GooString *defaultAppearance;
   VariableTextQuadding quadding;
+
+#if MULTITHREADED
+  GooMutex widgetsMutex;
+#endif
+
+  // the widgets, by the object number of their annotation
+  std::map<int, FormWidget *> widgetsByRef;
 };
 
 //------------------------------------------------------------------------
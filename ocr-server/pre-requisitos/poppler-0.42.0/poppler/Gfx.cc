@@ -311,6 +311,49 @@ Operator Gfx::opTab[] = {
 
 #define numOps (sizeof(opTab) / sizeof(Operator))
 
+// Operators are looked up in a perfect hash table: the multiplicative
+// hash of the (up to three) chars of the operator names in opTab has no
+// collisions in 256 entries.  If opTab is changed and a collision shows
+// up, findOp() falls back to a binary search.
+#define opHashMul 0x8091713fU
+#define opHashSize 256
+
+static inline Guint opHash(Guint key) {
+  return (key * opHashMul) >> 24;
+}
+
+// Returns the key of an operator name, or 0 if it is longer than three
+// chars.
+static inline Guint opKey(const char *name) {
+  Guint key = 0;
+  for (int i = 0; name[i]; ++i) {
+    if (i == 3) {
+      return 0;
+    }
+    key |= (Guint)(Guchar)name[i] << (8 * i);
+  }
+  return key;
+}
+
+Guchar Gfx::opHashTab[opHashSize];
+
+// The table is built before main() runs, so Gfx can be used from any
+// thread.
+GBool Gfx::opHashOk = Gfx::initOpHashTab();
+
+GBool Gfx::initOpHashTab() {
+  memset(opHashTab, 0, sizeof(opHashTab));
+  for (Guint i = 0; i < numOps; ++i) {
+    Guint h = opHash(opKey(opTab[i].name));
+    if (opHashTab[h]) {
+      error(errInternal, -1, "Collision in the Gfx operator hash table");
+      return gFalse;
+    }
+    opHashTab[h] = i + 1;
+  }
+  return gTrue;
+}
+
 static inline GBool isSameGfxColor(const GfxColor &colorA, const GfxColor &colorB, Guint nComps, double delta) {
   for (Guint k = 0; k < nComps; ++k) {
     if (abs(colorA.c[k] - colorB.c[k]) > delta) {
@@ -757,7 +800,10 @@ void Gfx::go(GBool topLevel) {
 	printf("\n");
 	fflush(stdout);
       }
-      GooTimer timer;
+      GooTimer *timer = NULL;
+      if (profileCommands) {
+	timer = new GooTimer();
+      }
 
       // Run the operation
       execOp(&obj, args, numArgs);
@@ -778,8 +824,9 @@ void Gfx::go(GBool topLevel) {
 	    hash->add (cmd_g, data_p);
 	  }
 	  
-	  data_p->addElement(timer.getElapsed ());
+	  data_p->addElement(timer->getElapsed ());
 	}
+	delete timer;
       }
       obj.free();
       for (i = 0; i < numArgs; ++i)
@@ -907,6 +954,18 @@ void Gfx::execOp(Object *cmd, Object args[], int numArgs) {
 Operator *Gfx::findOp(char *name) {
   int a, b, m, cmp;
 
+  if (likely(opHashOk)) {
+    Guint key = opKey(name);
+    if (!key) {
+      return NULL;
+    }
+    int i = opHashTab[opHash(key)];
+    if (i && !strcmp(opTab[i - 1].name, name)) {
+      return &opTab[i - 1];
+    }
+    return NULL;
+  }
+
   a = -1;
   b = numOps;
   cmp = 0; // make gcc happy
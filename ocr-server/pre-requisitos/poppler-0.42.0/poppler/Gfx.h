@@ -234,10 +234,13 @@ private:
   void *abortCheckCbkData;
 
   static Operator opTab[];	// table of operators
+  static Guchar opHashTab[];	// perfect hash table of opTab: index + 1
+  static GBool opHashOk;	// set if opHashTab has no collisions
 
   void go(GBool topLevel);
   void execOp(Object *cmd, Object args[], int numArgs);
   Operator *findOp(char *name);
+  static GBool initOpHashTab();
   GBool checkArg(Object *arg, TchkType type);
   Goffset getPos();
 
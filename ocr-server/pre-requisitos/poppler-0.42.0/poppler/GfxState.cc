@@ -1860,6 +1860,11 @@ class GfxICCBasedColorSpaceKey : public PopplerCacheKey
       return k->num == num && k->gen == gen;
     }
     
+    unsigned int hash() const
+    {
+      return (unsigned int)num * 31 + gen;
+    }
+    
     int num, gen;
 };
 
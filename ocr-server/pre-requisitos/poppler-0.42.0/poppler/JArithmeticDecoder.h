@@ -70,8 +70,18 @@ public:
   // Read any leftover data in the stream.
   void cleanup();
 
-  // Decode one bit.
-  int decodeBit(Guint context, JArithmeticDecoderStats *stats);
+  // Decode one bit.  The common case -- an MPS which needs no
+  // renormalization -- is handled inline.
+  int decodeBit(Guint context, JArithmeticDecoderStats *stats)
+  {
+    Guint cx = stats->cxTab[context];
+    Guint qe = qeTab[cx >> 1];
+    a -= qe;
+    if (c < a && (a & 0x80000000)) {
+      return cx & 1;
+    }
+    return decodeBitRenorm(context, stats, qe);
+  }
 
   // Decode eight bits.
   int decodeByte(Guint context, JArithmeticDecoderStats *stats);
@@ -88,6 +98,8 @@ public:
 private:
 
   Guint readByte();
+  int decodeBitRenorm(Guint context, JArithmeticDecoderStats *stats,
+		      Guint qe);
   int decodeIntBit(JArithmeticDecoderStats *stats);
   void byteIn();
 
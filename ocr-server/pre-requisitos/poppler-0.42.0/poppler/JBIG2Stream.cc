@@ -979,30 +979,50 @@ void JBIG2Bitmap::combine(JBIG2Bitmap *bitmap, int x, int y,
 	xx = x0;
       }
 
-      // middle bytes
-      for (; xx < x1 - 8; xx += 8) {
-	dest = *destPtr;
-	src0 = src1;
-	src1 = *srcPtr++;
-	src = (((src0 << 8) | src1) >> s1) & 0xff;
-	switch (combOp) {
-	case 0: // or
-	  dest |= src;
-	  break;
-	case 1: // and
-	  dest &= src;
-	  break;
-	case 2: // xor
-	  dest ^= src;
-	  break;
-	case 3: // xnor
-	  dest ^= src ^ 0xff;
-	  break;
-	case 4: // replace
-	  dest = src;
-	  break;
+      // middle bytes -- one loop per operator, so the inner loops
+      // stay branch-free
+      switch (combOp) {
+      case 0: // or
+	for (; xx < x1 - 8; xx += 8) {
+	  src0 = src1;
+	  src1 = *srcPtr++;
+	  *destPtr++ |= (Guchar)(((src0 << 8) | src1) >> s1);
 	}
-	*destPtr++ = dest;
+	break;
+      case 1: // and
+	for (; xx < x1 - 8; xx += 8) {
+	  src0 = src1;
+	  src1 = *srcPtr++;
+	  *destPtr++ &= (Guchar)(((src0 << 8) | src1) >> s1);
+	}
+	break;
+      case 2: // xor
+	for (; xx < x1 - 8; xx += 8) {
+	  src0 = src1;
+	  src1 = *srcPtr++;
+	  *destPtr++ ^= (Guchar)(((src0 << 8) | src1) >> s1);
+	}
+	break;
+      case 3: // xnor
+	for (; xx < x1 - 8; xx += 8) {
+	  src0 = src1;
+	  src1 = *srcPtr++;
+	  *destPtr++ ^= (Guchar)~(((src0 << 8) | src1) >> s1);
+	}
+	break;
+      case 4: // replace
+	for (; xx < x1 - 8; xx += 8) {
+	  src0 = src1;
+	  src1 = *srcPtr++;
+	  *destPtr++ = (Guchar)(((src0 << 8) | src1) >> s1);
+	}
+	break;
+      default:
+	for (; xx < x1 - 8; xx += 8) {
+	  src1 = *srcPtr++;
+	  ++destPtr;
+	}
+	break;
       }
 
       // right-most byte
@@ -3224,10 +3244,53 @@ JBIG2Bitmap *JBIG2Stream::readGenericBitmap(GBool mmr, int w, int h,
 	  buf1 = buf0 = 0;
 	}
 
-	if (atx[0] >= -8 && atx[0] <= 8 &&
-	    atx[1] >= -8 && atx[1] <= 8 &&
-	    atx[2] >= -8 && atx[2] <= 8 &&
-	    atx[3] >= -8 && atx[3] <= 8) {
+	if (atx[0] == 3 && aty[0] == -1 && atx[1] == -3 && aty[1] == -1 &&
+	    atx[2] == 2 && aty[2] == -2 && atx[3] == -2 && aty[3] == -2) {
+	  // the nominal adaptive pixels lie in the windows of the two
+	  // previous rows, so the whole context comes from buf0..buf2
+
+	  // decode the row
+	  for (x0 = 0, x = 0; x0 < w; x0 += 8, ++pp) {
+	    if (x0 + 8 < w) {
+	      if (p0) {
+		buf0 |= *p0++;
+	      }
+	      if (p1) {
+		buf1 |= *p1++;
+	      }
+	      buf2 |= *p2++;
+	    }
+	    for (x1 = 0, mask = 0x80; x1 < 8 && x < w; ++x1, ++x, mask >>= 1) {
+
+	      // build the context
+	      cx = ((buf0 >> 1) & 0xe000) | ((buf1 >> 5) & 0x1f00) |
+		   ((buf2 >> 12) & 0x00f0) |
+		   ((buf1 >> 9) & 0x08) |	// (x + 3, y - 1)
+		   ((buf1 >> 16) & 0x04) |	// (x - 3, y - 1)
+		   ((buf0 >> 12) & 0x02) |	// (x + 2, y - 2)
+		   ((buf0 >> 17) & 0x01);	// (x - 2, y - 2)
+
+	      // check for a skipped pixel
+	      if (!(useSkip && skip->getPixel(x, y))) {
+
+		// decode the pixel
+		if ((pix = arithDecoder->decodeBit(cx, genericRegionStats))) {
+		  *pp |= mask;
+		  buf2 |= 0x8000;
+		}
+	      }
+
+	      // update the context
+	      buf0 <<= 1;
+	      buf1 <<= 1;
+	      buf2 <<= 1;
+	    }
+	  }
+
+	} else if (atx[0] >= -8 && atx[0] <= 8 &&
+		   atx[1] >= -8 && atx[1] <= 8 &&
+		   atx[2] >= -8 && atx[2] <= 8 &&
+		   atx[3] >= -8 && atx[3] <= 8) {
 	  // set up the adaptive context
 	  if (y + aty[0] >= 0 && y + aty[0] < bitmap->getHeight()) {
 	    atP0 = bitmap->getDataPtr() + (y + aty[0]) * bitmap->getLineSize();
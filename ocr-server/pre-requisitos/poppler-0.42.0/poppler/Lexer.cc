@@ -65,6 +65,57 @@ static const char specialChars[256] = {
 static const int IntegerSafeLimit = (INT_MAX - 9) / 10;
 static const long long LongLongSafeLimit = (LLONG_MAX - 9) / 10;
 
+//------------------------------------------------------------------------
+// LexerStream
+//
+// The current stream of a buffered lexer, as it is read from the lexer:
+// the chars in the input buffer first, then the stream itself.  The
+// data of inline images is read through it.
+//------------------------------------------------------------------------
+
+class LexerStream: public Stream {
+public:
+
+  LexerStream(Lexer *lexerA) { lexer = lexerA; }
+  virtual StreamKind getKind() { return str()->getKind(); }
+  virtual void reset() {}
+  virtual int getChar()
+    { return lexer->bufPtr < lexer->bufEnd ? *lexer->bufPtr++ : str()->getChar(); }
+  virtual int lookChar()
+    { return lexer->bufPtr < lexer->bufEnd ? *lexer->bufPtr : str()->lookChar(); }
+  virtual int getUnfilteredChar() { return str()->getUnfilteredChar(); }
+  virtual void unfilteredReset() { str()->unfilteredReset(); }
+  virtual Goffset getPos() { return lexer->getPos(); }
+  virtual void setPos(Goffset pos, int dir = 0) { lexer->setPos(pos, dir); }
+  virtual GBool isBinary(GBool last = gTrue) { return str()->isBinary(last); }
+  virtual BaseStream *getBaseStream() { return str()->getBaseStream(); }
+  virtual Stream *getUndecodedStream() { return this; }
+  virtual Dict *getDict() { return str()->getDict(); }
+
+private:
+
+  Stream *str() { return lexer->curStr.getStream(); }
+  virtual GBool hasGetChars() { return true; }
+  virtual int getChars(int nChars, Guchar *buffer);
+
+  Lexer *lexer;
+};
+
+int LexerStream::getChars(int nChars, Guchar *buffer) {
+  int n = lexer->bufEnd - lexer->bufPtr;
+  if (n > nChars) {
+    n = nChars;
+  }
+  if (n > 0) {
+    memcpy(buffer, lexer->bufPtr, n);
+    lexer->bufPtr += n;
+  }
+  if (n < nChars) {
+    n += str()->doGetChars(nChars - n, buffer + n);
+  }
+  return n;
+}
+
 //------------------------------------------------------------------------
 // Lexer
 //------------------------------------------------------------------------
@@ -74,6 +125,8 @@ Lexer::Lexer(XRef *xrefA, Stream *str) {
 
   lookCharLastValueCached = LOOK_VALUE_NOT_CACHED;
   xref = xrefA;
+  inBuf = bufPtr = bufEnd = NULL;
+  lexStr = NULL;
 
   curStr.initStream(str);
   streams = new Array(xref);
@@ -88,6 +141,9 @@ Lexer::Lexer(XRef *xrefA, Object *obj) {
 
   lookCharLastValueCached = LOOK_VALUE_NOT_CACHED;
   xref = xrefA;
+  inBuf = (Guchar *)gmalloc(inBufSize);
+  bufPtr = bufEnd = inBuf;
+  lexStr = NULL;
 
   if (obj->isStream()) {
     streams = new Array(xref);
@@ -112,9 +168,55 @@ Lexer::~Lexer() {
   if (freeArray) {
     delete streams;
   }
+  delete lexStr;
+  gfree(inBuf);
+}
+
+Stream *Lexer::getStream() {
+  if (!curStr.isStream()) {
+    return NULL;
+  }
+  if (!inBuf) {
+    return curStr.getStream();
+  }
+  if (!lexStr) {
+    lexStr = new LexerStream(this);
+  }
+  return lexStr;
 }
 
-int Lexer::getChar(GBool comesFromLook) {
+Goffset Lexer::getPos() {
+  if (!curStr.isStream()) {
+    return -1;
+  }
+  // the chars in the buffer are bytes of the file only if the stream
+  // is not filtered
+  Stream *str = curStr.getStream();
+  if (str->getBaseStream() == str) {
+    return str->getPos() - (bufEnd - bufPtr);
+  }
+  return str->getPos();
+}
+
+// Read the next char from the current stream; a buffered lexer reads the
+// next block.
+int Lexer::readChar() {
+  int n;
+
+  if (!inBuf) {
+    return curStr.streamGetChar();
+  }
+  n = curStr.getStream()->doGetChars(inBufSize, inBuf);
+  if (n <= 0) {
+    bufPtr = bufEnd = inBuf;
+    return EOF;
+  }
+  bufPtr = inBuf;
+  bufEnd = inBuf + n;
+  return *bufPtr++;
+}
+
+int Lexer::getNextChar(GBool comesFromLook) {
   int c;
 
   if (LOOK_VALUE_NOT_CACHED != lookCharLastValueCached) {
@@ -124,7 +226,7 @@ int Lexer::getChar(GBool comesFromLook) {
   }
 
   c = EOF;
-  while (!curStr.isNone() && (c = curStr.streamGetChar()) == EOF) {
+  while (!curStr.isNone() && (c = readChar()) == EOF) {
     if (comesFromLook == gTrue) {
       return EOF;
     } else {
@@ -140,8 +242,16 @@ int Lexer::getChar(GBool comesFromLook) {
   return c;
 }
 
-int Lexer::lookChar() {
-  
+int Lexer::lookNextChar() {
+  int c;
+
+  if (inBuf) {
+    // the char is put back into the buffer it was read into
+    if ((c = getNextChar(gTrue)) != EOF) {
+      --bufPtr;
+    }
+    return c;
+  }
   if (LOOK_VALUE_NOT_CACHED != lookCharLastValueCached) {
     return lookCharLastValueCached;
   }
@@ -34,8 +34,11 @@
 #include "Stream.h"
 
 class XRef;
+class LexerStream;
 
 #define tokBufSize 128		// size of token buffer
+#define inBufSize 4096		// size of the input buffer of content
+				//   stream lexers
 
 //------------------------------------------------------------------------
 // Lexer
@@ -49,7 +52,10 @@ public:
   Lexer(XRef *xrefA, Stream *str);
 
   // Construct a lexer for a stream or array of streams (assumes obj
-  // is either a stream or array of streams).
+  // is either a stream or array of streams).  This is the lexer of
+  // content streams: it reads the streams a block at a time, so the
+  // position of the streams is ahead of the lexer.  The stream returned
+  // by getStream() reads from the lexer (for inline image data).
   Lexer(XRef *xrefA, Object *obj);
 
   // Destructor.
@@ -66,17 +72,15 @@ public:
   void skipChar() { getChar(); }
 
   // Get stream.
-  Stream *getStream()
-    { return curStr.isStream() ? curStr.getStream() : (Stream *)NULL; }
+  Stream *getStream();
 
   // Get current position in file.  This is only used for error
   // messages.
-  Goffset getPos()
-    { return curStr.isStream() ? curStr.streamGetPos() : -1; }
+  Goffset getPos();
 
   // Set position in file.
   void setPos(Goffset pos, int dir = 0)
-    { if (curStr.isStream()) curStr.streamSetPos(pos, dir); }
+    { if (curStr.isStream()) { curStr.streamSetPos(pos, dir); bufPtr = bufEnd; } }
 
   // Returns true if <c> is a whitespace character.
   static GBool isSpace(int c);
@@ -93,16 +97,26 @@ public:
 
 private:
 
-  int getChar(GBool comesFromLook = gFalse);
-  int lookChar();
+  int getChar(GBool comesFromLook = gFalse)
+    { return bufPtr < bufEnd ? *bufPtr++ : getNextChar(comesFromLook); }
+  int lookChar()
+    { return bufPtr < bufEnd ? *bufPtr : lookNextChar(); }
+  int getNextChar(GBool comesFromLook);
+  int lookNextChar();
+  int readChar();
 
   Array *streams;		// array of input streams
   int strPtr;			// index of current stream
   Object curStr;		// current stream
   GBool freeArray;		// should lexer free the streams array?
   char tokBuf[tokBufSize];	// temporary token buffer
+  Guchar *inBuf;		// input buffer (NULL if unbuffered)
+  Guchar *bufPtr, *bufEnd;	// unread chars in inBuf
+  LexerStream *lexStr;		// stream returned by getStream()
 
   XRef *xref;
+
+  friend class LexerStream;
 };
 
 #endif
@@ -18,16 +18,26 @@
 // LocalPDFDocBuilder
 //
 // The LocalPDFDocBuilder implements a PDFDocBuilder for local files.
+//
+// With mapFiles set, the files are read from a memory mapping (see
+// MMapFileStream) when possible.  The file must then not be truncated
+// while the PDFDoc is open.
 //------------------------------------------------------------------------
 
 class LocalPDFDocBuilder : public PDFDocBuilder {
 
 public:
 
+  LocalPDFDocBuilder(GBool mapFilesA = gFalse) { mapFiles = mapFilesA; }
+
   PDFDoc *buildPDFDoc(const GooString &uri, GooString *ownerPassword = NULL,
     GooString *userPassword = NULL, void *guiDataA = NULL);
   GBool supports(const GooString &uri);
 
+private:
+
+  GBool mapFiles;
+
 };
 
 #endif /* LOCALPDFDOCBUILDER_H */
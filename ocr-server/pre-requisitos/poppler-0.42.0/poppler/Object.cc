@@ -28,6 +28,7 @@
 #endif
 
 #include <stddef.h>
+#include <string.h>
 #include "Object.h"
 #include "Array.h"
 #include "Dict.h"
@@ -35,6 +36,119 @@
 #include "Stream.h"
 #include "XRef.h"
 
+//------------------------------------------------------------------------
+// name atoms
+//------------------------------------------------------------------------
+
+#define nameAtomHashSize 1024	// must be a power of 2
+
+const char nameAtomChars[] =
+  "A\0" "AA\0" "AcroForm\0" "Action\0" "ActualText\0" "Alternate\0"
+  "Annot\0" "Annotation\0" "Annots\0" "AP\0" "ArtBox\0" "AS\0" "Ascent\0"
+  "ASCII85Decode\0" "ASCIIHexDecode\0" "AvgWidth\0" "BaseEncoding\0"
+  "BaseFont\0" "BBox\0" "BC\0" "BG\0" "BitsPerComponent\0"
+  "BitsPerCoordinate\0" "BitsPerFlag\0" "BlackIs1\0" "BleedBox\0"
+  "Border\0" "Bounds\0" "BS\0" "C\0" "CA\0" "ca\0" "CapHeight\0"
+  "Catalog\0" "CCITTFaxDecode\0" "CharProcs\0" "CharSet\0" "CIDFontType0\0"
+  "CIDFontType0C\0" "CIDFontType2\0" "CIDSet\0" "CIDSystemInfo\0"
+  "CIDToGIDMap\0" "Colors\0" "ColorSpace\0" "Columns\0" "Contents\0"
+  "Coords\0" "Count\0" "CreationDate\0" "Creator\0" "CropBox\0" "CS\0"
+  "D\0" "DA\0" "DCTDecode\0" "Decode\0" "DecodeParms\0" "DescendantFonts\0"
+  "Descent\0" "Dest\0" "Dests\0" "DeviceCMYK\0" "DeviceGray\0" "DeviceN\0"
+  "DeviceRGB\0" "Differences\0" "Domain\0" "DP\0" "DR\0" "DV\0" "DW\0"
+  "DW2\0" "EarlyChange\0" "Encode\0" "EncodedByteAlign\0" "Encoding\0"
+  "Encrypt\0" "EndOfBlock\0" "EndOfLine\0" "Extend\0" "ExtGState\0" "F\0"
+  "Ff\0" "Fields\0" "Filter\0" "First\0" "FirstChar\0" "Fit\0" "FitH\0"
+  "FitR\0" "Flags\0" "FlateDecode\0" "Font\0" "FontBBox\0"
+  "FontDescriptor\0" "FontFamily\0" "FontFile\0" "FontFile2\0"
+  "FontFile3\0" "FontMatrix\0" "FontName\0" "FontStretch\0" "FontWeight\0"
+  "Form\0" "FormType\0" "FT\0" "Function\0" "FunctionType\0" "Group\0"
+  "Height\0" "I\0" "ICCBased\0" "ID\0" "Identity\0" "Identity-H\0"
+  "Identity-V\0" "Image\0" "ImageMask\0" "Index\0" "Indexed\0" "Info\0"
+  "Intent\0" "Interpolate\0" "IRT\0" "ItalicAngle\0" "JBIG2Decode\0"
+  "JBIG2Globals\0" "JPXDecode\0" "JS\0" "K\0" "Kids\0" "Lang\0" "Last\0"
+  "LastChar\0" "Leading\0" "Length\0" "Length1\0" "Length2\0" "Length3\0"
+  "Limits\0" "Link\0" "LZWDecode\0" "M\0" "MacRomanEncoding\0" "Mask\0"
+  "Matrix\0" "MaxWidth\0" "MCID\0" "MediaBox\0" "Metadata\0"
+  "MissingWidth\0" "MK\0" "ModDate\0" "N\0" "Name\0" "Names\0" "Next\0"
+  "NM\0" "ObjStm\0" "Off\0" "On\0" "OpenAction\0" "Ordering\0" "Outline\0"
+  "Outlines\0" "P\0" "Page\0" "PageLabels\0" "PageLayout\0" "PageMode\0"
+  "Pages\0" "Parent\0" "Pattern\0" "PatternType\0" "Pg\0" "Popup\0"
+  "Predictor\0" "Prev\0" "ProcSet\0" "Producer\0" "Properties\0" "Q\0"
+  "R\0" "Range\0" "Rect\0" "Registry\0" "Resources\0" "Root\0" "Rotate\0"
+  "Rows\0" "RunLengthDecode\0" "S\0" "Separation\0" "Shading\0"
+  "ShadingType\0" "Size\0" "SMask\0" "StandardEncoding\0" "StemH\0"
+  "StemV\0" "StructElem\0" "StructParent\0" "StructParents\0"
+  "StructTreeRoot\0" "Style\0" "Subtype\0" "Supplement\0" "T\0" "Text\0"
+  "Title\0" "ToUnicode\0" "TrimBox\0" "TrueType\0" "Type\0" "Type0\0"
+  "Type1\0" "Type1C\0" "Type3\0" "U\0" "URI\0" "V\0" "Version\0" "W\0"
+  "W2\0" "Widget\0" "Width\0" "Widths\0" "WinAnsiEncoding\0" "XHeight\0"
+  "XObject\0" "XRef\0" "XRefStm\0" "XYZ\0" "Yes\0";
+
+const int nameAtomCharsLength = sizeof(nameAtomChars);
+
+// Open addressing hash table over the names of nameAtomChars.
+struct NameAtomTable {
+  NameAtomTable();
+
+  struct {
+    unsigned short offset;	// offset of the name + 1, or 0 if empty
+    unsigned char length;
+  } slots[nameAtomHashSize];
+};
+
+static inline Guint hashName(const char *s, int len) {
+  Guint h = 2166136261u;
+  for (int i = 0; i < len; ++i) {
+    h = (h ^ (Guchar)s[i]) * 16777619u;
+  }
+  return h;
+}
+
+NameAtomTable::NameAtomTable() {
+  memset(slots, 0, sizeof(slots));
+  for (int offset = 0; offset < nameAtomCharsLength - 1; ) {
+    int len = (int)strlen(nameAtomChars + offset);
+    Guint h = hashName(nameAtomChars + offset, len) & (nameAtomHashSize - 1);
+    while (slots[h].offset) {
+      h = (h + 1) & (nameAtomHashSize - 1);
+    }
+    slots[h].offset = (unsigned short)(offset + 1);
+    slots[h].length = (unsigned char)len;
+    offset += len + 1;
+  }
+}
+
+const char *findNameAtom(const char *s, int len) {
+  static const NameAtomTable table;
+
+  if (len > 255) {
+    return NULL;
+  }
+  Guint h = hashName(s, len) & (nameAtomHashSize - 1);
+  for (; table.slots[h].offset; h = (h + 1) & (nameAtomHashSize - 1)) {
+    if (table.slots[h].length == len) {
+      const char *atom = nameAtomChars + table.slots[h].offset - 1;
+      if (!memcmp(atom, s, len)) {
+        return atom;
+      }
+    }
+  }
+  return NULL;
+}
+
+char *copyName(const char *s) {
+  const char *atom;
+
+  if (isNameAtom(s)) {
+    return (char *)s;
+  }
+  if ((atom = findNameAtom(s, (int)strlen(s)))) {
+    return (char *)atom;
+  }
+  return copyString(s);
+}
+
 //------------------------------------------------------------------------
 // Object
 //------------------------------------------------------------------------
@@ -94,7 +208,9 @@ Object *Object::copy(Object *obj) {
     obj->string = string->copy();
     break;
   case objName:
-    obj->name = copyString(name);
+    if (!shortStr && !isNameAtom(name)) {
+      obj->name = copyString(name);
+    }
     break;
   case objArray:
     array->incRef();
@@ -106,7 +222,9 @@ Object *Object::copy(Object *obj) {
     stream->incRef();
     break;
   case objCmd:
-    obj->cmd = copyString(cmd);
+    if (!shortStr && !isNameAtom(cmd)) {
+      obj->cmd = copyString(cmd);
+    }
     break;
   default:
     break;
@@ -128,7 +246,9 @@ void Object::free() {
     delete string;
     break;
   case objName:
-    gfree(name);
+    if (!shortStr) {
+      freeName(name);
+    }
     break;
   case objArray:
     if (!array->decRef()) {
@@ -146,7 +266,9 @@ void Object::free() {
     }
     break;
   case objCmd:
-    gfree(cmd);
+    if (!shortStr) {
+      freeName(cmd);
+    }
     break;
   default:
     break;
@@ -181,7 +303,7 @@ void Object::print(FILE *f) {
     fprintf(f, ")");
     break;
   case objName:
-    fprintf(f, "/%s", name);
+    fprintf(f, "/%s", getStr(name));
     break;
   case objNull:
     fprintf(f, "null");
@@ -214,7 +336,7 @@ void Object::print(FILE *f) {
     fprintf(f, "%d %d R", ref.num, ref.gen);
     break;
   case objCmd:
-    fprintf(f, "%s", cmd);
+    fprintf(f, "%s", getStr(cmd));
     break;
   case objError:
     fprintf(f, "<error>");
@@ -78,6 +78,37 @@ struct Ref {
   int gen;			// generation number
 };
 
+//------------------------------------------------------------------------
+// name atoms
+//
+// The names which are most common in PDF files -- the keys of the page,
+// resource, font, annotation and stream dictionaries, and the usual
+// filter, color space and font type names -- are stored once, in a
+// table shared by the whole process.  Dict keys and Name objects which
+// are one of these names point into the table instead of having their
+// own copy.
+//------------------------------------------------------------------------
+
+// The table: the names, each followed by a null character.
+extern const char nameAtomChars[];
+extern const int nameAtomCharsLength;
+
+// Returns the shared copy of the <len> characters at <s>, or NULL if
+// they are not one of the names of the table.
+extern const char *findNameAtom(const char *s, int len);
+
+// Returns gTrue if <p> points into the table (it must not be freed).
+static inline GBool isNameAtom(const char *p)
+  { return p >= nameAtomChars && p < nameAtomChars + nameAtomCharsLength; }
+
+// Returns the shared copy of <s> if there is one, otherwise a copy of it
+// made by copyString(); free it with freeName().
+extern char *copyName(const char *s);
+
+// Frees a name returned by copyName() or copyString().
+static inline void freeName(char *p)
+  { if (!isNameAtom(p)) gfree(p); }
+
 //------------------------------------------------------------------------
 // object types
 //------------------------------------------------------------------------
@@ -122,7 +153,7 @@ enum ObjType {
 class Object {
 public:
   // clear the anonymous union as best we can -- clear at least a pointer
-  void zeroUnion() { this->name = NULL; }
+  void zeroUnion() { this->name = NULL; shortStr = gFalse; }
 
   // Default constructor.
   Object():
@@ -138,7 +169,7 @@ public:
   Object *initString(GooString *stringA)
     { initObj(objString); string = stringA; return this; }
   Object *initName(const char *nameA)
-    { initObj(objName); name = copyString(nameA); return this; }
+    { initObj(objName); setStr(&name, nameA); return this; }
   Object *initNull()
     { initObj(objNull); return this; }
   Object *initArray(XRef *xref);
@@ -148,7 +179,7 @@ public:
   Object *initRef(int numA, int genA)
     { initObj(objRef); ref.num = numA; ref.gen = genA; return this; }
   Object *initCmd(char *cmdA)
-    { initObj(objCmd); cmd = copyString(cmdA); return this; }
+    { initObj(objCmd); setStr(&cmd, cmdA); return this; }
   Object *initError()
     { initObj(objError); return this; }
   Object *initEOF()
@@ -192,11 +223,11 @@ public:
 
   // Special type checking.
   GBool isName(const char *nameA)
-    { return type == objName && !strcmp(name, nameA); }
+    { return type == objName && !strcmp(getStr(name), nameA); }
   GBool isDict(const char *dictType);
   GBool isStream(char *dictType);
   GBool isCmd(const char *cmdA)
-    { return type == objCmd && !strcmp(cmd, cmdA); }
+    { return type == objCmd && !strcmp(getStr(cmd), cmdA); }
 
   // Accessors.
   GBool getBool() { OBJECT_TYPE_CHECK(objBool); return booln; }
@@ -212,14 +243,14 @@ public:
   // because the object it's not expected to have a NULL string.
   GooString *takeString() {
     OBJECT_TYPE_CHECK(objString); GooString *s = string; string = NULL; return s; }
-  char *getName() { OBJECT_TYPE_CHECK(objName); return name; }
+  char *getName() { OBJECT_TYPE_CHECK(objName); return getStr(name); }
   Array *getArray() { OBJECT_TYPE_CHECK(objArray); return array; }
   Dict *getDict() { OBJECT_TYPE_CHECK(objDict); return dict; }
   Stream *getStream() { OBJECT_TYPE_CHECK(objStream); return stream; }
   Ref getRef() { OBJECT_TYPE_CHECK(objRef); return ref; }
   int getRefNum() { OBJECT_TYPE_CHECK(objRef); return ref.num; }
   int getRefGen() { OBJECT_TYPE_CHECK(objRef); return ref.gen; }
-  char *getCmd() { OBJECT_TYPE_CHECK(objCmd); return cmd; }
+  char *getCmd() { OBJECT_TYPE_CHECK(objCmd); return getStr(cmd); }
   long long getInt64() { OBJECT_TYPE_CHECK(objInt64); return int64g; }
   long long getIntOrInt64() { OBJECT_2TYPES_CHECK(objInt, objInt64);
     return type == objInt ? intg : int64g; }
@@ -263,7 +294,24 @@ public:
 
 private:
 
+  // Names and commands shorter than the union, such as the operators and
+  // most resource names of content streams, are stored in the object
+  // itself.  A pointer returned by getName() or getCmd() is then only
+  // valid as long as the object is not moved.  Longer ones point to the
+  // name atom if there is one.
+  void setStr(char **p, const char *s) {
+    size_t n = strlen(s);
+    if (n < sizeof(shortStrBuf)) {
+      memcpy(shortStrBuf, s, n + 1);
+      shortStr = gTrue;
+    } else if (!(*p = (char *)findNameAtom(s, (int)n))) {
+      *p = copyString(s);
+    }
+  }
+  char *getStr(char *p) { return shortStr ? shortStrBuf : p; }
+
   ObjType type;			// object type
+  GBool shortStr;		// name or command in shortStrBuf
   union {			// value for each type:
     GBool booln;		//   boolean
     int intg;			//   integer
@@ -276,6 +324,7 @@ private:
     Stream *stream;		//   stream
     Ref ref;			//   indirect reference
     char *cmd;			//   command
+    char shortStrBuf[8];	//   short name or command
   };
 
 #ifdef DEBUG_MEM
@@ -0,0 +1,218 @@
+//========================================================================
+//
+// ObjectStreamWriter.cc
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#ifdef USE_GCC_PRAGMAS
+#pragma implementation
+#endif
+
+#include "goo/GooString.h"
+#include "Error.h"
+#include "PDFDoc.h"
+#include "Stream.h"
+#include "XRef.h"
+#if ENABLE_ZLIB
+#include "FlateEncoder.h"
+#endif
+#include "ObjectStreamWriter.h"
+
+//------------------------------------------------------------------------
+// ObjectStreamWriter
+//------------------------------------------------------------------------
+
+ObjectStreamWriter::ObjectStreamWriter(OutStream *outStrA, XRef *uxrefA,
+				       int firstFreeNumA) {
+  outStr = outStrA;
+  uxref = uxrefA;
+  firstFreeNum = firstFreeNumA;
+  objData = new MemOutStream();
+  nObjects = 0;
+}
+
+ObjectStreamWriter::~ObjectStreamWriter() {
+  if (nObjects > 0) {
+    error(errInternal, -1, "ObjectStreamWriter: {0:d} objects were not written",
+	  nObjects);
+  }
+  delete objData;
+}
+
+void ObjectStreamWriter::setFirstFreeNum(int num) {
+  if (num > firstFreeNum) {
+    firstFreeNum = num;
+  }
+}
+
+void ObjectStreamWriter::writeObject(Object *obj, int num, int gen,
+				     XRef *xRef, Guint numOffset) {
+  if (obj->isStream() || gen != 0) {
+    Goffset offset = outStr->getPos();
+    outStr->printf("%i %i obj\r\n", num, gen);
+    PDFDoc::writeObject(obj, outStr, xRef, numOffset, NULL, cryptRC4, 0, 0, 0);
+    outStr->printf("\r\nendobj\r\n");
+    uxref->add(num, gen, offset, gTrue);
+    return;
+  }
+  offsets[nObjects] = objData->getPos();
+  PDFDoc::writeObject(obj, objData, xRef, numOffset, NULL, cryptRC4, 0, 0, 0);
+  objData->put('\n');
+  addPacked(num);
+}
+
+OutStream *ObjectStreamWriter::beginObject(int num) {
+  offsets[nObjects] = objData->getPos();
+  // reserve the number, in case the pending objects are flushed before
+  // endObject() is called
+  uxref->add(num, 0, 0, gTrue);
+  nums[nObjects] = num;
+  return objData;
+}
+
+void ObjectStreamWriter::endObject() {
+  objData->put('\n');
+  addPacked(nums[nObjects]);
+}
+
+void ObjectStreamWriter::addPacked(int num) {
+  // the entry is completed when the object stream is numbered
+  uxref->add(num, nObjects, 0, gTrue);
+  uxref->getEntry(num)->type = xrefEntryCompressed;
+  nums[nObjects++] = num;
+  if (nObjects == maxObjects) {
+    flush();
+  }
+}
+
+int ObjectStreamWriter::getFreeNum() {
+  int num = uxref->getNumObjects();
+  if (num < firstFreeNum) {
+    num = firstFreeNum;
+  }
+  return num;
+}
+
+void ObjectStreamWriter::flush() {
+  if (nObjects == 0) {
+    return;
+  }
+  int stmNum = getFreeNum();
+
+  // the header of the object stream lists the object numbers and offsets
+  MemOutStream data;
+  for (int i = 0; i < nObjects; ++i) {
+    data.printf("%d %lld ", nums[i], (long long)offsets[i]);
+    uxref->getEntry(nums[i])->offset = stmNum;
+  }
+  data.put('\n');
+  int first = data.getLength();
+  data.write(objData->getData(), objData->getLength());
+
+  Object obj1;
+  Dict *dict = new Dict(uxref);
+  dict->add(copyString("Type"), obj1.initName("ObjStm"));
+  dict->add(copyString("N"), obj1.initInt(nObjects));
+  dict->add(copyString("First"), obj1.initInt(first));
+  writeStream(stmNum, dict, data.getData(), data.getLength());
+  delete dict;
+
+  objData->clear();
+  nObjects = 0;
+}
+
+void ObjectStreamWriter::writeXRefStreamTrailer(Dict *trailerDict, XRef *xRef) {
+  flush();
+
+  // entries which were reserved (marked) but not written still have
+  // offset 0, which is never valid: object 0 and the header are there
+  for (int i = 1; i < uxref->getNumObjects(); ++i) {
+    XRefEntry *e = uxref->getEntry(i);
+    if (e->type != xrefEntryFree && e->offset == 0) {
+      e->type = xrefEntryFree;
+      e->gen = 0;
+    }
+  }
+
+  int num = getFreeNum();
+  Goffset offset = outStr->getPos();
+  uxref->add(num, 0, offset, gTrue);
+
+  Object obj1;
+  trailerDict->set("Size", obj1.initInt(uxref->getNumObjects()));
+  GooString stmData;
+  // a new file has a single section: the numbers missing from a
+  // section would be taken for a damaged cross-reference
+  uxref->writeStreamToBuffer(&stmData, trailerDict, xRef, gTrue);
+#if ENABLE_ZLIB
+  // with the PNG Up predictor the runs of free entries, and the entries
+  // of an object stream, become rows of zeros, which compress well
+  int columns = 0;
+  Object w, obj2;
+  trailerDict->lookup("W", &w);
+  for (int i = 0; i < w.arrayGetLength(); ++i) {
+    columns += w.arrayGet(i, &obj2)->getInt();
+    obj2.free();
+  }
+  w.free();
+  GooString predicted;
+  const char *row = stmData.getCString();
+  for (int i = 0; i < stmData.getLength(); i += columns) {
+    predicted.append((char)2);
+    for (int j = 0; j < columns; ++j) {
+      predicted.append((char)(row[i + j] - (i > 0 ? row[i + j - columns] : 0)));
+    }
+  }
+  obj1.initDict(uxref);
+  obj1.dictAdd(copyString("Columns"), obj2.initInt(columns));
+  obj1.dictAdd(copyString("Predictor"), obj2.initInt(12));
+  trailerDict->set("DecodeParms", &obj1);
+  writeStream(num, trailerDict, predicted.getCString(), predicted.getLength());
+#else
+  writeStream(num, trailerDict, stmData.getCString(), stmData.getLength());
+#endif
+
+  outStr->printf("startxref\r\n");
+  outStr->printf("%lli\r\n", (long long)offset);
+  outStr->printf("%%%%EOF\r\n");
+}
+
+// Write stream object <num> with the entries of <dict> and <data>,
+// compressed if possible.  Filter and Length are set in <dict>.
+void ObjectStreamWriter::writeStream(int num, Dict *dict, char *data,
+				     int length) {
+  Object obj1;
+#if ENABLE_ZLIB
+  MemOutStream encoded;
+  Stream *str = new MemStream(data, 0, length, obj1.initNull());
+  Stream *encStr = new FlateEncoder(str);
+  int c;
+  encStr->reset();
+  while ((c = encStr->getChar()) != EOF) {
+    encoded.put(c);
+  }
+  encStr->close();
+  delete encStr;
+  delete str;
+  data = encoded.getData();
+  length = encoded.getLength();
+  dict->set("Filter", obj1.initName("FlateDecode"));
+#endif
+  dict->set("Length", obj1.initInt(length));
+
+  Goffset offset = outStr->getPos();
+  outStr->printf("%i 0 obj\r\n", num);
+  PDFDoc::writeObject(obj1.initDict(dict), outStr, uxref, 0, NULL, cryptRC4,
+		      0, 0, 0);
+  obj1.free();
+  outStr->printf("\r\nstream\r\n");
+  for (int i = 0; i < length; ++i) {
+    outStr->put(data[i]);
+  }
+  outStr->printf("\r\nendstream\r\nendobj\r\n");
+  uxref->add(num, 0, offset, gTrue);
+}
@@ -0,0 +1,86 @@
+//========================================================================
+//
+// ObjectStreamWriter.h
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#ifndef OBJECTSTREAMWRITER_H
+#define OBJECTSTREAMWRITER_H
+
+#ifdef USE_GCC_PRAGMAS
+#pragma interface
+#endif
+
+#include "goo/gtypes.h"
+#include "Object.h"
+
+class MemOutStream;
+class OutStream;
+class XRef;
+
+//------------------------------------------------------------------------
+// ObjectStreamWriter
+//
+// Writes the objects of a new PDF file the compact way of PDF 1.5: the
+// objects which may be compressed (all but streams and objects with a
+// non-zero generation number) are packed into Flate compressed object
+// streams, and the file ends with a cross-reference stream instead of a
+// cross-reference table and trailer.
+//
+// The caller numbers the objects; the object streams and the
+// cross-reference stream are numbered from the first free number on.
+// The entries of all written objects are added to <uxref>.
+//------------------------------------------------------------------------
+
+class ObjectStreamWriter {
+public:
+
+  // Constructor.  The object streams get numbers from <firstFreeNumA>
+  // on, and above all the objects in <uxrefA>.
+  ObjectStreamWriter(OutStream *outStrA, XRef *uxrefA, int firstFreeNumA = 0);
+
+  // Destructor.  Pending objects are lost: call flush() or
+  // writeXRefStreamTrailer() first.
+  ~ObjectStreamWriter();
+
+  // Reserve the object numbers below <num> for objects the caller has
+  // not written yet.
+  void setFirstFreeNum(int num);
+
+  // Write <obj> as object <num> <gen>, as PDFDoc::writeObject does with
+  // <xRef> and <numOffset> (without encryption).
+  void writeObject(Object *obj, int num, int gen, XRef *xRef, Guint numOffset);
+
+  // Write object <num> (generation 0) from text: the caller prints the
+  // object, without the "obj" and "endobj" keywords, to the returned
+  // stream and then calls endObject().
+  OutStream *beginObject(int num);
+  void endObject();
+
+  // Write the pending objects as an object stream.
+  void flush();
+
+  // Write the pending objects, the cross-reference stream with the
+  // entries of <trailerDict> (Size is set here) and the end of the file.
+  void writeXRefStreamTrailer(Dict *trailerDict, XRef *xRef);
+
+private:
+
+  void addPacked(int num);
+  int getFreeNum();
+  void writeStream(int num, Dict *dict, char *data, int length);
+
+  static const int maxObjects = 100;	// objects per object stream
+
+  OutStream *outStr;
+  XRef *uxref;
+  int firstFreeNum;
+  MemOutStream *objData;	// packed objects of the pending object stream
+  int nums[maxObjects];		// their numbers
+  Goffset offsets[maxObjects];	// their offsets in objData
+  int nObjects;
+};
+
+#endif
@@ -73,6 +73,7 @@
 #include "Parser.h"
 #include "SecurityHandler.h"
 #include "Decrypt.h"
+#include "ObjectStreamWriter.h"
 #ifndef DISABLE_OUTLINE
 #include "Outline.h"
 #endif
@@ -122,6 +123,7 @@ void PDFDoc::init()
   startXRefPos = -1;
   secHdlr = NULL;
   pageCache = NULL;
+  processAnnots = gTrue;
 }
 
 PDFDoc::PDFDoc()
@@ -634,16 +636,20 @@ Hints *PDFDoc::getHints()
   return hints;
 }
 
-int PDFDoc::savePageAs(GooString *name, int pageNo) 
+int PDFDoc::savePageAs(GooString *name, int pageNo, PDFWriteMode mode) 
 {
   FILE *f;
-  OutStream *outStr;
+  OutStream *outStr, *objStr;
   XRef *yRef, *countRef;
+  ObjectStreamWriter *objStms;
   int rootNum = getXRef()->getNumObjects() + 1;
 
   // Make sure that special flags are set, because we are going to read
   // all objects, including Unencrypted ones.
-  xref->scanSpecialFlags();
+  {
+    pdfdocLocker();
+    xref->scanSpecialFlags();
+  }
 
   Guchar *fileKey;
   CryptAlgorithm encAlgorithm;
@@ -658,13 +664,19 @@ int PDFDoc::savePageAs(GooString *name, int pageNo)
   if (getCatalog()->getPage(pageNo)->isCropped()) {
     cropBox = getCatalog()->getPage(pageNo)->getCropBox();
   }
-  replacePageDict(pageNo, 
+  // The page, the trailer, the info and the catalog dictionaries are
+  // copied before they are changed for the output, and markAcroForm and
+  // markAnnotations keep what they change in yRef, so that the document
+  // stays as it is.
+  Ref *refPage = getCatalog()->getPageRef(pageNo);
+  Object page, pageObj;
+  getXRef()->fetch(refPage->num, refPage->gen, &pageObj);
+  page.initDict(pageObj.getDict()->copy(getXRef()));
+  pageObj.free();
+  setPageBoxes(page.getDict(), getXRef(),
     getCatalog()->getPage(pageNo)->getRotate(),
     getCatalog()->getPage(pageNo)->getMediaBox(),
     cropBox);
-  Ref *refPage = getCatalog()->getPageRef(pageNo);
-  Object page;
-  getXRef()->fetch(refPage->num, refPage->gen, &page);
 
   if (!(f = fopen(name->getCString(), "wb"))) {
     error(errIO, -1, "Couldn't open file '{0:t}'", name);
@@ -681,16 +693,33 @@ int PDFDoc::savePageAs(GooString *name, int pageNo)
   countRef = new XRef();
   Object *trailerObj = getXRef()->getTrailerDict();
   if (trailerObj->isDict()) {
-    markPageObjects(trailerObj->getDict(), yRef, countRef, 0, refPage->num, rootNum + 2);
+    Object trailerCopy;
+    trailerCopy.initDict(trailerObj->getDict()->copy(getXRef()));
+    markPageObjects(trailerCopy.getDict(), yRef, countRef, 0, refPage->num, rootNum + 2);
+    trailerCopy.free();
   }
   yRef->add(0, 65535, 0, gFalse);
-  writeHeader(outStr, getPDFMajorVersion(), getPDFMinorVersion());
+  objStms = NULL;
+  if (mode == writeForceCompact) {
+    if (xref->isEncrypted()) {
+      error(errUnimplemented, -1, "Encrypted pages are not written with object streams");
+    } else {
+      objStms = new ObjectStreamWriter(outStr, yRef, rootNum + 3);
+    }
+  }
+  if (objStms && getPDFMajorVersion() == 1 && getPDFMinorVersion() < 5) {
+    writeHeader(outStr, 1, 5);
+  } else {
+    writeHeader(outStr, getPDFMajorVersion(), getPDFMinorVersion());
+  }
 
   // get and mark info dict
   Object infoObj;
   getXRef()->getDocInfo(&infoObj);
   if (infoObj.isDict()) {
-    Dict *infoDict = infoObj.getDict();
+    Dict *infoDict = infoObj.getDict()->copy(getXRef());
+    infoObj.free();
+    infoObj.initDict(infoDict);
     markPageObjects(infoDict, yRef, countRef, 0, refPage->num, rootNum + 2);
     if (trailerObj->isDict()) {
       Dict *trailerDict = trailerObj->getDict();
@@ -710,24 +739,34 @@ int PDFDoc::savePageAs(GooString *name, int pageNo)
   // get and mark output intents etc.
   Object catObj, pagesObj, resourcesObj, annotsObj, afObj;
   getXRef()->getCatalog(&catObj);
-  Dict *catDict = catObj.getDict();
+  Dict *catDict = catObj.getDict()->copy(getXRef());
+  catObj.free();
+  catObj.initDict(catDict);
   catDict->lookup("Pages", &pagesObj);
   catDict->lookupNF("AcroForm", &afObj);
   if (!afObj.isNull()) {
     markAcroForm(&afObj, yRef, countRef, 0, refPage->num, rootNum + 2);
-    afObj.free();
+    if (afObj.isRef()) {
+      afObj.free();
+    } else {
+      catDict->set("AcroForm", &afObj);
+    }
   }
   Dict *pagesDict = pagesObj.getDict();
   pagesDict->lookup("Resources", &resourcesObj);
-  if (resourcesObj.isDict())
-    markPageObjects(resourcesObj.getDict(), yRef, countRef, 0, refPage->num, rootNum + 2);
+  if (resourcesObj.isDict()) {
+    Dict *resourceDict = resourcesObj.getDict()->copy(getXRef());
+    resourcesObj.free();
+    resourcesObj.initDict(resourceDict);
+    markPageObjects(resourceDict, yRef, countRef, 0, refPage->num, rootNum + 2);
+  }
   markPageObjects(catDict, yRef, countRef, 0, refPage->num, rootNum + 2);
 
   Dict *pageDict = page.getDict();
   if (resourcesObj.isNull() && !pageDict->hasKey("Resources")) {
     Dict *resourceDict = getCatalog()->getPage(pageNo)->getResourceDict();
     if (resourceDict != NULL) {
-      resourcesObj.initDict(resourceDict);
+      resourcesObj.initDict(resourceDict->copy(getXRef()));
       markPageObjects(resourcesObj.getDict(), yRef, countRef, 0, refPage->num, rootNum + 2);
     }
   }
@@ -735,58 +774,81 @@ int PDFDoc::savePageAs(GooString *name, int pageNo)
   pageDict->lookupNF("Annots", &annotsObj);
   if (!annotsObj.isNull()) {
     markAnnotations(&annotsObj, yRef, countRef, 0, refPage->num, rootNum + 2);
-    annotsObj.free();
+    if (annotsObj.isRef()) {
+      annotsObj.free();
+    } else {
+      pageDict->set("Annots", &annotsObj);
+    }
   }
   yRef->markUnencrypted();
-  writePageObjects(outStr, yRef, 0);
+  writePageObjects(outStr, yRef, 0, gFalse, objStms);
 
-  yRef->add(rootNum,0,outStr->getPos(),gTrue);
-  outStr->printf("%d 0 obj\n", rootNum);
-  outStr->printf("<< /Type /Catalog /Pages %d 0 R", rootNum + 1); 
+  if (objStms) {
+    objStr = objStms->beginObject(rootNum);
+  } else {
+    yRef->add(rootNum,0,outStr->getPos(),gTrue);
+    outStr->printf("%d 0 obj\n", rootNum);
+    objStr = outStr;
+  }
+  objStr->printf("<< /Type /Catalog /Pages %d 0 R", rootNum + 1); 
   for (int j = 0; j < catDict->getLength(); j++) {
     const char *key = catDict->getKey(j);
     if (strcmp(key, "Type") != 0 &&
       strcmp(key, "Catalog") != 0 &&
       strcmp(key, "Pages") != 0) 
     {
-      if (j > 0) outStr->printf(" ");
+      if (j > 0) objStr->printf(" ");
       Object value; catDict->getValNF(j, &value);
-      outStr->printf("/%s ", key);
-      writeObject(&value, outStr, getXRef(), 0, NULL, cryptRC4, 0, 0, 0);
+      objStr->printf("/%s ", key);
+      writeObject(&value, objStr, getXRef(), 0, NULL, cryptRC4, 0, 0, 0);
       value.free();
     }
   }
   catObj.free();
   pagesObj.free();
-  outStr->printf(">>\nendobj\n");
-
-  yRef->add(rootNum + 1,0,outStr->getPos(),gTrue);
-  outStr->printf("%d 0 obj\n", rootNum + 1);
-  outStr->printf("<< /Type /Pages /Kids [ %d 0 R ] /Count 1 ", rootNum + 2);
+  objStr->printf(">>\n");
+  if (objStms) {
+    objStms->endObject();
+    objStr = objStms->beginObject(rootNum + 1);
+  } else {
+    outStr->printf("endobj\n");
+    yRef->add(rootNum + 1,0,outStr->getPos(),gTrue);
+    outStr->printf("%d 0 obj\n", rootNum + 1);
+  }
+  objStr->printf("<< /Type /Pages /Kids [ %d 0 R ] /Count 1 ", rootNum + 2);
   if (resourcesObj.isDict()) {
-    outStr->printf("/Resources ");
-    writeObject(&resourcesObj, outStr, getXRef(), 0, NULL, cryptRC4, 0, 0, 0);
+    objStr->printf("/Resources ");
+    writeObject(&resourcesObj, objStr, getXRef(), 0, NULL, cryptRC4, 0, 0, 0);
     resourcesObj.free();
   }
-  outStr->printf(">>\n");
-  outStr->printf("endobj\n");
-
-  yRef->add(rootNum + 2,0,outStr->getPos(),gTrue);
-  outStr->printf("%d 0 obj\n", rootNum + 2);
-  outStr->printf("<< ");
+  objStr->printf(">>\n");
+  if (objStms) {
+    objStms->endObject();
+    objStr = objStms->beginObject(rootNum + 2);
+  } else {
+    outStr->printf("endobj\n");
+    yRef->add(rootNum + 2,0,outStr->getPos(),gTrue);
+    outStr->printf("%d 0 obj\n", rootNum + 2);
+  }
+  objStr->printf("<< ");
   for (int n = 0; n < pageDict->getLength(); n++) {
-    if (n > 0) outStr->printf(" ");
+    if (n > 0) objStr->printf(" ");
     const char *key = pageDict->getKey(n);
     Object value; pageDict->getValNF(n, &value);
     if (strcmp(key, "Parent") == 0) {
-      outStr->printf("/Parent %d 0 R", rootNum + 1);
+      objStr->printf("/Parent %d 0 R", rootNum + 1);
     } else {
-      outStr->printf("/%s ", key);
-      writeObject(&value, outStr, getXRef(), 0, NULL, cryptRC4, 0, 0, 0);
+      objStr->printf("/%s ", key);
+      writeObject(&value, objStr, getXRef(), 0, NULL, cryptRC4, 0, 0, 0);
     }
     value.free();
   }
-  outStr->printf(" >>\nendobj\n");
+  objStr->printf(" >>\n");
+  if (objStms) {
+    objStms->endObject();
+  } else {
+    outStr->printf("endobj\n");
+  }
   page.free();
 
   Goffset uxrefOffset = outStr->getPos();
@@ -795,8 +857,13 @@ int PDFDoc::savePageAs(GooString *name, int pageNo)
   ref.gen = 0;
   Dict *trailerDict = createTrailerDict(rootNum + 3, gFalse, 0, &ref, getXRef(),
                                         name->getCString(), uxrefOffset);
-  writeXRefTableTrailer(trailerDict, yRef, gFalse /* do not write unnecessary entries */,
-                        uxrefOffset, outStr, getXRef());
+  if (objStms) {
+    objStms->writeXRefStreamTrailer(trailerDict, getXRef());
+    delete objStms;
+  } else {
+    writeXRefTableTrailer(trailerDict, yRef, gFalse /* do not write unnecessary entries */,
+                          uxrefOffset, outStr, getXRef());
+  }
   delete trailerDict;
 
   outStr->close();
@@ -840,6 +907,14 @@ int PDFDoc::saveAs(OutStream *outStr, PDFWriteMode mode) {
     saveWithoutChangesAs (outStr);
   } else if (mode == writeForceRewrite) {
     saveCompleteRewrite(outStr);
+  } else if (mode == writeForceCompact) {
+    if (xref->isEncrypted()) {
+      // the objects of object streams are encrypted with the stream
+      error(errUnimplemented, -1, "Encrypted documents are not written with object streams, rewriting them completely");
+      saveCompleteRewrite(outStr);
+    } else {
+      saveCompactRewrite(outStr);
+    }
   } else {
     saveIncrementalUpdate(outStr);
   }
@@ -883,15 +958,21 @@ int PDFDoc::saveWithoutChangesAs(OutStream *outStr) {
 void PDFDoc::saveIncrementalUpdate (OutStream* outStr)
 {
   XRef *uxref;
-  int c;
+  int c, last;
   //copy the original file
   BaseStream *copyStr = str->copy();
   copyStr->reset();
+  last = EOF;
   while ((c = copyStr->getChar()) != EOF) {
     outStr->put(c);
+    last = c;
   }
   copyStr->close();
   delete copyStr;
+  //the update must not start on the %%EOF line
+  if (last != '\n' && last != '\r') {
+    outStr->put('\n');
+  }
 
   Guchar *fileKey;
   CryptAlgorithm encAlgorithm;
@@ -961,7 +1042,10 @@ void PDFDoc::saveCompleteRewrite (OutStream* outStr)
 {
   // Make sure that special flags are set, because we are going to read
   // all objects, including Unencrypted ones.
-  xref->scanSpecialFlags();
+  {
+    pdfdocLocker();
+    xref->scanSpecialFlags();
+  }
 
   Guchar *fileKey;
   CryptAlgorithm encAlgorithm;
@@ -1020,6 +1104,61 @@ void PDFDoc::saveCompleteRewrite (OutStream* outStr)
   delete uxref;
 }
 
+void PDFDoc::saveCompactRewrite (OutStream* outStr)
+{
+  // Make sure that special flags are set (DontRewrite)
+  xref->scanSpecialFlags();
+
+  if (pdfMajorVersion == 1 && pdfMinorVersion < 5) {
+    writeHeader(outStr, 1, 5);
+  } else {
+    writeHeader(outStr, pdfMajorVersion, pdfMinorVersion);
+  }
+  XRef *uxref = new XRef();
+  uxref->add(0, 65535, 0, gFalse);
+  ObjectStreamWriter *objStms = new ObjectStreamWriter(outStr, uxref, xref->getNumObjects());
+  xref->lock();
+  for(int i=0; i<xref->getNumObjects(); i++) {
+    Object obj1;
+    Ref ref;
+    XRefEntryType type = xref->getEntry(i)->type;
+    if (type == xrefEntryFree) {
+      ref.num = i;
+      ref.gen = xref->getEntry(i)->gen;
+      // see saveCompleteRewrite
+      if (ref.gen > 0 && ref.num > 0)
+        uxref->add(ref.num, ref.gen, 0, gFalse);
+    } else if (xref->getEntry(i)->getFlag(XRefEntry::DontRewrite)) {
+      ref.num = i;
+      ref.gen = xref->getEntry(i)->gen + 1;
+      uxref->add(ref.num, ref.gen, 0, gFalse);
+    } else {
+      ref.num = i;
+      ref.gen = type == xrefEntryCompressed ? 0 : xref->getEntry(i)->gen;
+      xref->fetch(ref.num, ref.gen, &obj1, 1);
+      // the objects of the old object streams are written on their own,
+      // and the cross-reference stream is rebuilt
+      if (!obj1.isStream() || (!obj1.streamGetDict()->is("ObjStm") &&
+                               !obj1.streamGetDict()->is("XRef"))) {
+        objStms->writeObject(&obj1, ref.num, ref.gen, xref, 0);
+      }
+      obj1.free();
+    }
+  }
+  xref->unlock();
+
+  const char *fileNameA = fileName ? fileName->getCString() : NULL;
+  Ref rootRef;
+  rootRef.num = getXRef()->getRootNum();
+  rootRef.gen = getXRef()->getRootGen();
+  Dict *trailerDict = createTrailerDict(uxref->getNumObjects(), gFalse, 0, &rootRef, getXRef(),
+                                        fileNameA, outStr->getPos());
+  objStms->writeXRefStreamTrailer(trailerDict, getXRef());
+  delete trailerDict;
+  delete objStms;
+  delete uxref;
+}
+
 void PDFDoc::writeDictionnary (Dict* dict, OutStream* outStr, XRef *xRef, Guint numOffset, Guchar *fileKey,
                                CryptAlgorithm encAlgorithm, int keyLength, int objNum, int objGen)
 {
@@ -1041,7 +1180,7 @@ void PDFDoc::writeStream (Stream* str, OutStream* outStr)
   outStr->printf("stream\r\n");
   str->reset();
   for (int c=str->getChar(); c!= EOF; c=str->getChar()) {
-    outStr->printf("%c", c);  
+    outStr->put(c);
   }
   outStr->printf("\r\nendstream\r\n");
 }
@@ -1070,7 +1209,7 @@ void PDFDoc::writeRawStream (Stream* str, OutStream* outStr)
       error (errSyntaxError, -1, "PDFDoc::writeRawStream: EOF reading stream");
       break;
     }
-    outStr->printf("%c", c);  
+    outStr->put(c);
   }
   str->reset();
   outStr->printf("\r\nendstream\r\n");
@@ -1259,7 +1398,9 @@ void PDFDoc::writeObject (Object* obj, OutStream* outStr, XRef *xRef, Guint numO
           FilterStream *fs = dynamic_cast<FilterStream*>(stream);
           if (fs) {
             BaseStream *bs = fs->getBaseStream();
-            if (bs) {
+            // the stream ends found by the XRef only apply to streams
+            // read from the file, not to data copied to memory
+            if (bs && bs->getKind() != strWeird) {
               Goffset streamEnd;
                 if (xRef->getStreamEnd(bs->getStart(), &streamEnd)) {
                   Object val;
@@ -1520,7 +1661,12 @@ void PDFDoc::markObject (Object* obj, XRef *xRef, XRef *countRef, Guint numOffse
             break;
         } 
         Object obj1;
-        getXRef()->fetch(obj->getRef().num, obj->getRef().gen, &obj1);
+        XRefEntry *entry = xRef->getEntry(obj->getRef().num + numOffset);
+        if (entry->getFlag(XRefEntry::Updated)) {
+          entry->obj.copy(&obj1);
+        } else {
+          getXRef()->fetch(obj->getRef().num, obj->getRef().gen, &obj1);
+        }
         markObject(&obj1, xRef, countRef, numOffset, oldRefNum, newRefNum);
         obj1.free();
       }
@@ -1537,7 +1683,14 @@ void PDFDoc::replacePageDict(int pageNo, int rotate,
   Ref *refPage = getCatalog()->getPageRef(pageNo);
   Object page;
   getXRef()->fetch(refPage->num, refPage->gen, &page);
-  Dict *pageDict = page.getDict();
+  setPageBoxes(page.getDict(), getXRef(), rotate, mediaBox, cropBox);
+  getXRef()->setModifiedObject(&page, *refPage);
+  page.free();
+}
+
+void PDFDoc::setPageBoxes(Dict *pageDict, XRef *xrefA, int rotate,
+                          PDFRectangle *mediaBox, PDFRectangle *cropBox)
+{
   pageDict->remove("MediaBoxssdf");
   pageDict->remove("MediaBox");
   pageDict->remove("CropBox");
@@ -1546,7 +1699,7 @@ void PDFDoc::replacePageDict(int pageNo, int rotate,
   pageDict->remove("TrimBox");
   pageDict->remove("Rotate");
   Object mediaBoxObj;
-  mediaBoxObj.initArray(getXRef());
+  mediaBoxObj.initArray(xrefA);
   Object murx;
   murx.initReal(mediaBox->x1);
   Object mury;
@@ -1562,7 +1715,7 @@ void PDFDoc::replacePageDict(int pageNo, int rotate,
   pageDict->add(copyString("MediaBox"), &mediaBoxObj);
   if (cropBox != NULL) {
     Object cropBoxObj;
-    cropBoxObj.initArray(getXRef());
+    cropBoxObj.initArray(xrefA);
     Object curx;
     curx.initReal(cropBox->x1);
     Object cury;
@@ -1585,8 +1738,6 @@ void PDFDoc::replacePageDict(int pageNo, int rotate,
   Object rotateObj;
   rotateObj.initInt(rotate);
   pageDict->add(copyString("Rotate"), &rotateObj);
-  getXRef()->setModifiedObject(&page, *refPage);
-  page.free();
 }
 
 void PDFDoc::markPageObjects(Dict *pageDict, XRef *xRef, XRef *countRef, Guint numOffset, int oldRefNum, int newRefNum) 
@@ -1616,8 +1767,10 @@ GBool PDFDoc::markAnnotations(Object *annotsObj, XRef *xRef, XRef *countRef, Gui
   annotsObj->fetch(getXRef(), &annots);
   if (annots.isArray()) {
       Array *array = annots.getArray();
+      GBool *removed = (GBool *)gmallocn(array->getLength(), sizeof(GBool));
       for (int i=array->getLength() - 1; i >= 0; i--) {
-        Object obj1;
+        Object obj1, movedAnnot;
+        removed[i] = gFalse;
         if (array->get(i, &obj1)->isDict()) {
           Object type;
           Dict *dict = obj1.getDict();
@@ -1629,10 +1782,21 @@ GBool PDFDoc::markAnnotations(Object *annotsObj, XRef *xRef, XRef *countRef, Gui
                 Object obj3;
                 array->getNF(i, &obj3);
                 if (obj3.isRef()) {
-                  Object *newRef = new Object();
-                  newRef->initRef(newPageNum, 0);
-                  dict->set("P", newRef);
-                  getXRef()->setModifiedObject(&obj1, obj3.getRef());
+                  if (obj3.getRef().num + (int) numOffset < xRef->getNumObjects() &&
+                      xRef->getEntry(obj3.getRef().num + numOffset)->getFlag(XRefEntry::Updated)) {
+                    // already moved, as a field of the AcroForm
+                    obj3.free();
+                    obj1.free();
+                    obj2.free();
+                    type.free();
+                    continue;
+                  }
+                  // the copy with the new /P goes into xRef below
+                  Object newRef;
+                  newRef.initRef(newPageNum, 0);
+                  movedAnnot.initDict(dict->copy(getXRef()));
+                  movedAnnot.dictSet("P", &newRef);
+                  dict = movedAnnot.getDict();
                 }
                 obj3.free();
               } else if (obj2.getRef().num == newPageNum) {
@@ -1661,7 +1825,7 @@ GBool PDFDoc::markAnnotations(Object *annotsObj, XRef *xRef, XRef *countRef, Gui
                 obj1.free();
                 obj2.free();
                 type.free();
-                array->remove(i);
+                removed[i] = gTrue;
                 modified = gTrue;
                 continue;
               }
@@ -1676,6 +1840,8 @@ GBool PDFDoc::markAnnotations(Object *annotsObj, XRef *xRef, XRef *countRef, Gui
         if (obj1.isRef()) {
           if (obj1.getRef().num + (int) numOffset >= xRef->getNumObjects() || xRef->getEntry(obj1.getRef().num + numOffset)->type == xrefEntryFree) {
             if (getXRef()->getEntry(obj1.getRef().num)->type == xrefEntryFree) {
+              movedAnnot.free();
+              obj1.free();
               continue;  // already marked as free => should be replaced
             }
             xRef->add(obj1.getRef().num + numOffset, obj1.getRef().gen, 0, gTrue);
@@ -1691,13 +1857,34 @@ GBool PDFDoc::markAnnotations(Object *annotsObj, XRef *xRef, XRef *countRef, Gui
             XRefEntry *entry = countRef->getEntry(obj1.getRef().num + numOffset);
             entry->gen++;
           } 
+          if (movedAnnot.isDict()) {
+            Ref ref = obj1.getRef();
+            ref.num += numOffset;
+            xRef->setModifiedObject(&movedAnnot, ref);
+          }
         }
+        movedAnnot.free();
         obj1.free();
       }
+      if (modified) {
+        // the array without the annotations of other pages
+        Object kept;
+        kept.initArray(getXRef());
+        for (int i = 0; i < array->getLength(); i++) {
+          if (!removed[i]) {
+            Object obj1;
+            kept.arrayAdd(array->getNF(i, &obj1));
+          }
+        }
+        annots.free();
+        annots = kept;
+      }
+      gfree(removed);
   }
   if (annotsObj->isRef()) {
     if (annotsObj->getRef().num + (int) numOffset >= xRef->getNumObjects() || xRef->getEntry(annotsObj->getRef().num + numOffset)->type == xrefEntryFree) {
       if (getXRef()->getEntry(annotsObj->getRef().num)->type == xrefEntryFree) {
+        annots.free();
         return modified;  // already marked as free => should be replaced
       }
       xRef->add(annotsObj->getRef().num + numOffset, annotsObj->getRef().gen, 0, gTrue);
@@ -1713,14 +1900,21 @@ GBool PDFDoc::markAnnotations(Object *annotsObj, XRef *xRef, XRef *countRef, Gui
       XRefEntry *entry = countRef->getEntry(annotsObj->getRef().num + numOffset);
       entry->gen++;
     } 
-    getXRef()->setModifiedObject(&annots, annotsObj->getRef());
+    if (modified) {
+      Ref ref = annotsObj->getRef();
+      ref.num += numOffset;
+      xRef->setModifiedObject(&annots, ref);
+    }
+  } else if (modified) {
+    annotsObj->free();
+    annots.copy(annotsObj);
   }
   annots.free();
   return modified;
 }
 
 void PDFDoc::markAcroForm(Object *afObj, XRef *xRef, XRef *countRef, Guint numOffset, int oldRefNum, int newRefNum) {
-  Object acroform;
+  Object acroform, trimmedFields;
   GBool modified = gFalse;
   afObj->fetch(getXRef(), &acroform);
   if (acroform.isDict()) {
@@ -1729,6 +1923,9 @@ void PDFDoc::markAcroForm(Object *afObj, XRef *xRef, XRef *countRef, Guint numOf
         if (strcmp(dict->getKey(i), "Fields") == 0) {
           Object fields;
           modified = markAnnotations(dict->getValNF(i, &fields), xRef, countRef, numOffset, oldRefNum, newRefNum);
+          if (modified && !fields.isRef()) {
+            fields.copy(&trimmedFields);
+          }
           fields.free();
         } else {
           Object obj;
@@ -1737,9 +1934,19 @@ void PDFDoc::markAcroForm(Object *afObj, XRef *xRef, XRef *countRef, Guint numOf
         }
       }
   }
+  modified = trimmedFields.isArray();
+  if (modified) {
+    // a copy with the direct /Fields array markAnnotations trimmed
+    Object copy;
+    copy.initDict(acroform.getDict()->copy(getXRef()));
+    copy.dictSet("Fields", &trimmedFields);
+    acroform.free();
+    acroform = copy;
+  }
   if (afObj->isRef()) {
     if (afObj->getRef().num + (int) numOffset >= xRef->getNumObjects() || xRef->getEntry(afObj->getRef().num + numOffset)->type == xrefEntryFree) {
       if (getXRef()->getEntry(afObj->getRef().num)->type == xrefEntryFree) {
+        acroform.free();
         return;  // already marked as free => should be replaced
       }
       xRef->add(afObj->getRef().num + numOffset, afObj->getRef().gen, 0, gTrue);
@@ -1756,14 +1963,20 @@ void PDFDoc::markAcroForm(Object *afObj, XRef *xRef, XRef *countRef, Guint numOf
       entry->gen++;
     } 
     if (modified){
-      getXRef()->setModifiedObject(&acroform, afObj->getRef());
+      Ref ref = afObj->getRef();
+      ref.num += numOffset;
+      xRef->setModifiedObject(&acroform, ref);
     }
+  } else if (modified) {
+    afObj->free();
+    acroform.copy(afObj);
   }
   acroform.free();
   return;
 }
 
-Guint PDFDoc::writePageObjects(OutStream *outStr, XRef *xRef, Guint numOffset, GBool combine) 
+Guint PDFDoc::writePageObjects(OutStream *outStr, XRef *xRef, Guint numOffset, GBool combine,
+                               ObjectStreamWriter *objStms) 
 {
   Guint objectsCount = 0; //count the number of objects in the XRef(s)
   Guchar *fileKey;
@@ -1771,14 +1984,27 @@ Guint PDFDoc::writePageObjects(OutStream *outStr, XRef *xRef, Guint numOffset, G
   int keyLength;
   xRef->getEncryptionParameters(&fileKey, &encAlgorithm, &keyLength);
 
-  for (int n = numOffset; n < xRef->getNumObjects(); n++) {
+  // objStms adds the object streams after the marked objects
+  int numObjects = xRef->getNumObjects();
+  for (int n = numOffset; n < numObjects; n++) {
     if (xRef->getEntry(n)->type != xrefEntryFree) {
       Object obj;
       Ref ref;
       ref.num = n;
       ref.gen = xRef->getEntry(n)->gen;
       objectsCount++;
-      getXRef()->fetch(ref.num - numOffset, ref.gen, &obj);
+      XRefEntry *entry = xRef->getEntry(n);
+      if (entry->getFlag(XRefEntry::Updated)) {
+        entry->obj.copy(&obj);
+        entry->obj.free();
+      } else {
+        getXRef()->fetch(ref.num - numOffset, ref.gen, &obj);
+      }
+      if (objStms) {
+        objStms->writeObject(&obj, ref.num, ref.gen, getXRef(), combine ? numOffset : 0);
+        obj.free();
+        continue;
+      }
       Goffset offset = writeObjectHeader(&ref, outStr);
       if (combine) {
         writeObject(&obj, outStr, getXRef(), numOffset, NULL, cryptRC4, 0, 0, 0);
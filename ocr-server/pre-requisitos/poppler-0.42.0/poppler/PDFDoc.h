@@ -65,11 +65,14 @@ class Linearization;
 class SecurityHandler;
 class Hints;
 class StructTreeRoot;
+class ObjectStreamWriter;
 
 enum PDFWriteMode {
   writeStandard,
   writeForceRewrite,
-  writeForceIncremental
+  writeForceIncremental,
+  writeForceCompact		// complete rewrite with object streams and
+				// a cross-reference stream (PDF 1.5)
 };
 
 //------------------------------------------------------------------------
@@ -118,6 +121,15 @@ public:
   // Get catalog.
   Catalog *getCatalog() { return catalog; }
 
+  // Annotations are processed (parsed by Page::getAnnots(), and so
+  // displayed, and found by the font and link scanners) only if this is
+  // set, which is the default.  Tools which only extract the page
+  // content can clear it: then the pages have no annotations, and the
+  // interactive form is only loaded if it is asked for.
+  void setProcessAnnotations(GBool processAnnotsA)
+    { processAnnots = processAnnotsA; }
+  GBool getProcessAnnotations() { return processAnnots; }
+
   // Get optional content configuration
   OCGs *getOptContentConfig() { return catalog->getOptContentConfig(); }
 
@@ -237,8 +249,10 @@ public:
   //Return the PDF ID in the trailer dictionary (if any).
   GBool getID(GooString *permanent_id, GooString *update_id);
 
-  // Save one page with another name.
-  int savePageAs(GooString *name, int pageNo);
+  // Save one page with another name.  Only writeStandard and
+  // writeForceCompact make a difference.  The document itself is not
+  // changed, so several threads may save pages of it at the same time.
+  int savePageAs(GooString *name, int pageNo, PDFWriteMode mode=writeStandard);
   // Save this file with another name.
   int saveAs(GooString *name, PDFWriteMode mode=writeStandard);
   // Save this file in the given output stream.
@@ -254,10 +268,17 @@ public:
   // rewrite pageDict with MediaBox, CropBox and new page CTM
   void replacePageDict(int pageNo, int rotate, PDFRectangle *mediaBox, PDFRectangle *cropBox);
   void markPageObjects(Dict *pageDict, XRef *xRef, XRef *countRef, Guint numOffset, int oldRefNum, int newRefNum);
+  // markAnnotations and markAcroForm leave the document alone: objects
+  // they change (annotations moved to newPageNum, the arrays without
+  // the annotations of other pages) are kept in xRef, and a direct
+  // annots or acroForm object is replaced by its changed copy
   GBool markAnnotations(Object *annots, XRef *xRef, XRef *countRef, Guint numOffset, int oldPageNum, int newPageNum);
   void markAcroForm(Object *acrpForm, XRef *xRef, XRef *countRef, Guint numOffset, int oldPageNum, int newPageNum);
-  // write all objects used by pageDict to outStr
-  Guint writePageObjects(OutStream *outStr, XRef *xRef, Guint numOffset, GBool combine = gFalse);
+  // write all objects used by pageDict to outStr, or through objStms
+  // (unencrypted documents only); objects kept in xRef are written
+  // instead of the ones of the document
+  Guint writePageObjects(OutStream *outStr, XRef *xRef, Guint numOffset, GBool combine = gFalse,
+                         ObjectStreamWriter *objStms = NULL);
   static void writeObject (Object *obj, OutStream* outStr, XRef *xref, Guint numOffset, Guchar *fileKey,
                            CryptAlgorithm encAlgorithm, int keyLength, int objNum, int objGen);
   static void writeHeader(OutStream *outStr, int major, int minor);
@@ -295,6 +316,11 @@ private:
                            CryptAlgorithm encAlgorithm, int keyLength, int objNum, int objGen);
   void saveIncrementalUpdate (OutStream* outStr);
   void saveCompleteRewrite (OutStream* outStr);
+  void saveCompactRewrite (OutStream* outStr);
+  // set the boxes and the rotation of a page dictionary, for replacePageDict
+  // and savePageAs
+  static void setPageBoxes(Dict *pageDict, XRef *xrefA, int rotate,
+                           PDFRectangle *mediaBox, PDFRectangle *cropBox);
 
   Page *parsePage(int page);
 
@@ -332,6 +358,7 @@ private:
   Outline *outline;
 #endif
   Page **pageCache;
+  GBool processAnnots;
 
   GBool ok;
   int errCode;
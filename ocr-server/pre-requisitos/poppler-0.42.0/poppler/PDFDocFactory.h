@@ -28,13 +28,16 @@ class PDFDocBuilder;
 //
 // You can extend the supported URIs by giving a list of PDFDocBuilders to
 // the constructor, or by registering a new PDFDocBuilder afterwards.
+//
+// With mapLocalFiles set, local files are read from a memory mapping (see
+// LocalPDFDocBuilder).
 //------------------------------------------------------------------------
 
 class PDFDocFactory {
 
 public:
 
-  PDFDocFactory(GooList *pdfDocBuilders = NULL);
+  PDFDocFactory(GooList *pdfDocBuilders = NULL, GBool mapLocalFiles = gFalse);
   ~PDFDocFactory();
 
   // Create a PDFDoc. Returns a PDFDoc. You should check this PDFDoc
@@ -400,7 +400,12 @@ void Page::replaceXRef(XRef *xrefA) {
 Annots *Page::getAnnots(XRef *xrefA) {
   if (!annots) {
     Object obj;
-    annots = new Annots(doc, num, getAnnots(&obj, (xrefA == NULL) ? xref : xrefA));
+    if (doc->getProcessAnnotations()) {
+      getAnnots(&obj, (xrefA == NULL) ? xref : xrefA);
+    } else {
+      obj.initNull();
+    }
+    annots = new Annots(doc, num, &obj);
     obj.free();
   }
 
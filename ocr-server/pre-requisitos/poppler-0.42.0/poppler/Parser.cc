@@ -111,10 +111,10 @@ Object *Parser::getObj(Object *obj, GBool simpleOnly,
 	shift();
       } else {
 	// buf1 might go away in shift(), so construct the key
-	key = copyString(buf1.getName());
+	key = copyName(buf1.getName());
 	shift();
 	if (buf1.isEOF() || buf1.isError()) {
-	  gfree(key);
+	  freeName(key);
 	  if (strict && buf1.isError()) goto err;
 	  break;
 	}
@@ -18,70 +18,139 @@ PopplerCacheKey::~PopplerCacheKey()
 {
 }
 
+unsigned int PopplerCacheKey::hash() const
+{
+  return 0;
+}
+
 PopplerCacheItem::~PopplerCacheItem()
 {
 }
 
+// Items are kept in a list ordered by use, most recent first, and are
+// found through a hash table so lookups don't depend on the cache size.
+struct PopplerCache::Entry {
+  PopplerCacheKey *key;
+  PopplerCacheItem *item;
+  unsigned int hash;
+  Entry *prev, *next;		// use order
+  Entry *nextInBucket;
+};
+
 PopplerCache::PopplerCache(int cacheSizeA)
 {
   cacheSize = cacheSizeA;
-  keys = new PopplerCacheKey*[cacheSize];
-  items = new PopplerCacheItem*[cacheSize];
-  lastValidCacheIndex = -1;
+  first = last = NULL;
+  buckets = NULL;
+  numItems = 0;
+  hitCount = missCount = 0;
+  rehash();
 }
 
 PopplerCache::~PopplerCache()
 {
-  for (int i = 0; i <= lastValidCacheIndex; ++i) {
-    delete keys[i];
-    delete items[i];
+  while (last) {
+    removeLast();
   }
-  delete[] keys;
-  delete[] items;
+  delete[] buckets;
 }
 
-PopplerCacheItem *PopplerCache::lookup(const PopplerCacheKey &key)
+void PopplerCache::rehash()
 {
-  if (lastValidCacheIndex < 0)
-    return 0;
+  // at least twice as many buckets as items
+  unsigned int nBuckets = 2;
+  while ((int)nBuckets < 2 * cacheSize) {
+    nBuckets <<= 1;
+  }
+  delete[] buckets;
+  buckets = new Entry*[nBuckets];
+  for (unsigned int i = 0; i < nBuckets; ++i) {
+    buckets[i] = NULL;
+  }
+  bucketMask = nBuckets - 1;
+  // oldest first, so newer duplicates of a key stay in front of the chain
+  for (Entry *entry = last; entry; entry = entry->prev) {
+    entry->nextInBucket = buckets[entry->hash & bucketMask];
+    buckets[entry->hash & bucketMask] = entry;
+  }
+}
 
-  if (*keys[0] == key) {
-    return items[0];
+void PopplerCache::unlink(Entry *entry)
+{
+  if (entry->prev) {
+    entry->prev->next = entry->next;
+  } else {
+    first = entry->next;
+  }
+  if (entry->next) {
+    entry->next->prev = entry->prev;
+  } else {
+    last = entry->prev;
+  }
+}
+
+void PopplerCache::linkFirst(Entry *entry)
+{
+  entry->prev = NULL;
+  entry->next = first;
+  if (first) {
+    first->prev = entry;
+  } else {
+    last = entry;
   }
-  for (int i = 1; i <= lastValidCacheIndex; i++) {
-    if (*keys[i] == key) {
-      PopplerCacheKey *keyHit = keys[i];
-      PopplerCacheItem *itemHit = items[i];
-
-      for (int j = i; j > 0; j--) {
-        keys[j] = keys[j - 1];
-        items[j] = items[j - 1];
+  first = entry;
+}
+
+void PopplerCache::removeLast()
+{
+  Entry *entry = last;
+  Entry **link = &buckets[entry->hash & bucketMask];
+  while (*link != entry) {
+    link = &(*link)->nextInBucket;
+  }
+  *link = entry->nextInBucket;
+  unlink(entry);
+  delete entry->key;
+  delete entry->item;
+  delete entry;
+  numItems--;
+}
+
+PopplerCacheItem *PopplerCache::lookup(const PopplerCacheKey &key)
+{
+  unsigned int h = key.hash();
+  for (Entry *entry = buckets[h & bucketMask]; entry; entry = entry->nextInBucket) {
+    if (entry->hash == h && *entry->key == key) {
+      if (entry != first) {
+        unlink(entry);
+        linkFirst(entry);
       }
-      
-      keys[0] = keyHit;
-      items[0] = itemHit;
-      return itemHit;
+      hitCount++;
+      return entry->item;
     }
   }
+  missCount++;
   return 0;
 }
 
 void PopplerCache::put(PopplerCacheKey *key, PopplerCacheItem *item)
 {
-  int movingStartIndex = lastValidCacheIndex + 1;
-  if (lastValidCacheIndex == cacheSize - 1) {
-    delete keys[lastValidCacheIndex];
-    delete items[lastValidCacheIndex];
-    movingStartIndex = cacheSize - 1;
-  } else {
-    lastValidCacheIndex++;
+  if (cacheSize <= 0) {
+    delete key;
+    delete item;
+    return;
   }
-  for (int i = movingStartIndex; i > 0; i--) {
-    keys[i] = keys[i - 1];
-    items[i] = items[i - 1];
+  if (numItems == cacheSize) {
+    removeLast();
   }
-  keys[0] = key;
-  items[0] = item;
+  Entry *entry = new Entry;
+  entry->key = key;
+  entry->item = item;
+  entry->hash = key->hash();
+  entry->nextInBucket = buckets[entry->hash & bucketMask];
+  buckets[entry->hash & bucketMask] = entry;
+  linkFirst(entry);
+  numItems++;
 }
 
 int PopplerCache::size()
@@ -89,19 +158,37 @@ int PopplerCache::size()
   return cacheSize;
 }
 
+void PopplerCache::setSize(int cacheSizeA)
+{
+  cacheSize = cacheSizeA;
+  while (numItems > cacheSize && numItems > 0) {
+    removeLast();
+  }
+  rehash();
+}
+
 int PopplerCache::numberOfItems()
 {
-  return lastValidCacheIndex + 1;
+  return numItems;
+}
+
+PopplerCache::Entry *PopplerCache::entryAt(int index)
+{
+  Entry *entry = first;
+  while (index-- > 0) {
+    entry = entry->next;
+  }
+  return entry;
 }
     
 PopplerCacheItem *PopplerCache::item(int index)
 {
-  return items[index];
+  return entryAt(index)->item;
 }
     
 PopplerCacheKey *PopplerCache::key(int index)
 {
-  return keys[index];
+  return entryAt(index)->key;
 }
 
 class ObjectKey : public PopplerCacheKey {
@@ -116,6 +203,11 @@ class ObjectKey : public PopplerCacheKey {
       return k->num == num && k->gen == gen;
     }
 
+    unsigned int hash() const
+    {
+      return (unsigned int)num * 31 + gen;
+    }
+
     int num, gen;
 };
 
@@ -26,6 +26,9 @@ class PopplerCacheKey
   public:
     virtual ~PopplerCacheKey();
     virtual bool operator==(const PopplerCacheKey &key) const = 0;
+    /* Keys that compare equal must have the same hash. Keys that do not
+       override it all share a bucket, which works but is searched linearly */
+    virtual unsigned int hash() const;
 };
 
 class PopplerCache
@@ -43,22 +46,42 @@ class PopplerCache
     /* The max size of the cache */
     int size();
     
+    /* Changes the max size of the cache, the least recently used items
+       that no longer fit are deleted */
+    void setSize(int cacheSizeA);
+    
     /* The number of items in the cache */
     int numberOfItems();
     
-    /* The n-th item in the cache */
+    /* The n-th item in the cache, starting from the most recently used */
     PopplerCacheItem *item(int index);
     
-    /* The n-th key in the cache */
+    /* The n-th key in the cache, starting from the most recently used */
     PopplerCacheKey *key(int index);
+    
+    /* The number of lookups that found / did not find their key */
+    int hits() { return hitCount; }
+    int misses() { return missCount; }
   
   private:
     PopplerCache(const PopplerCache &cache); // not allowed
   
-    PopplerCacheKey **keys;
-    PopplerCacheItem **items;
-    int lastValidCacheIndex;
+    struct Entry;
+    
+    Entry *entryAt(int index);
+    void unlink(Entry *entry);
+    void linkFirst(Entry *entry);
+    void removeLast();
+    void rehash();
+  
+    Entry *first;		// most recently used
+    Entry *last;		// least recently used
+    Entry **buckets;		// hash chains, indexed by hash & bucketMask
+    unsigned int bucketMask;
+    int numItems;
     int cacheSize;
+    int hitCount;
+    int missCount;
 };
 
 class PopplerObjectCache
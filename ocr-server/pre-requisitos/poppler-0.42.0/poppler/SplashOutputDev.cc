@@ -1200,21 +1200,59 @@ static const SplashBlendFunc splashOutBlendFuncs[] = {
 // SplashOutFontFileID
 //------------------------------------------------------------------------
 
+// A font file is identified by the font object of the document it is
+// loaded for, and, once loaded, by its data and its mapping from char
+// codes to glyphs.  The data finds it again for the same font embedded
+// in another document (or in another font object).
 class SplashOutFontFileID: public SplashFontFileID {
 public:
 
-  SplashOutFontFileID(Ref *rA) { r = *rA; }
+  SplashOutFontFileID(Ref *rA, int docSerialA)
+    { r = *rA; docSerial = docSerialA; key = NULL; src = NULL; hash = 0; }
 
-  ~SplashOutFontFileID() {}
+  ~SplashOutFontFileID() {
+    delete key;
+    if (src) {
+      src->unref();
+    }
+  }
 
   GBool matches(SplashFontFileID *id) {
-    return ((SplashOutFontFileID *)id)->r.num == r.num &&
-           ((SplashOutFontFileID *)id)->r.gen == r.gen;
+    SplashOutFontFileID *id2 = (SplashOutFontFileID *)id;
+    if (key && id2->key) {
+      return id2->hash == hash && !id2->key->cmp(key) &&
+	     (src ? id2->src && id2->src->bufLen == src->bufLen &&
+		    !memcmp(id2->src->buf, src->buf, src->bufLen)
+		  : !id2->src);
+    }
+    return id2->docSerial == docSerial &&
+           id2->r.num == r.num && id2->r.gen == r.gen;
+  }
+
+  // Make the font object <id2> is for the one this font file is
+  // looked up with.
+  void setFontObject(SplashOutFontFileID *id2)
+    { r = id2->r; docSerial = id2->docSerial; }
+
+  // Set the data: <keyA> describes the font file (its type, and its
+  // name for an external file) and its mapping, <srcA> is the data of
+  // an embedded font (or NULL), and <hashA> is a hash of both.
+  void setData(GooString *keyA, SplashFontSrc *srcA, Guint hashA) {
+    key = keyA;
+    src = srcA;
+    if (src) {
+      src->ref();
+    }
+    hash = hashA;
   }
 
 private:
 
   Ref r;
+  int docSerial;		// SplashOutputDev::docSerial
+  GooString *key;
+  SplashFontSrc *src;
+  Guint hash;
 };
 
 //------------------------------------------------------------------------
@@ -1369,6 +1407,7 @@ SplashOutputDev::SplashOutputDev(SplashColorMode colorModeA,
   bitmapUpsideDown = gFalse;
   fontAntialias = gTrue;
   vectorAntialias = gTrue;
+  reduceImageResolution = gFalse;
   overprintPreview = overprintPreviewA;
   enableFreeTypeHinting = gFalse;
   enableSlightHinting = gFalse;
@@ -1393,6 +1432,8 @@ SplashOutputDev::SplashOutputDev(SplashColorMode colorModeA,
   splash->clear(paperColor, 0);
 
   fontEngine = NULL;
+  fontEngineFlags = 0;
+  docSerial = 0;
 
   nT3Fonts = 0;
   t3GlyphStack = NULL;
@@ -1477,20 +1518,39 @@ void SplashOutputDev::startDoc(PDFDoc *docA) {
   int i;
 
   doc = docA;
-  if (fontEngine) {
+  ++docSerial;
+
+  // the font engine, with its font files and glyph caches, is kept for
+  // the next documents while its settings stay the same: font files are
+  // found again by their data
+  int fontEngineFlagsA = (getFontAntialias() && colorMode != splashModeMono1)
+#if HAVE_T1LIB_H
+			 | (globalParams->getEnableT1lib() << 1)
+#endif
+#if HAVE_FREETYPE_FREETYPE_H || HAVE_FREETYPE_H
+			 | (globalParams->getEnableFreeType() << 2)
+			 | (enableFreeTypeHinting << 3)
+			 | (enableSlightHinting << 4)
+#endif
+			 ;
+  if (fontEngine && fontEngineFlagsA != fontEngineFlags) {
     delete fontEngine;
+    fontEngine = NULL;
   }
-  fontEngine = new SplashFontEngine(
+  if (!fontEngine) {
+    fontEngine = new SplashFontEngine(
 #if HAVE_T1LIB_H
-				    globalParams->getEnableT1lib(),
+				      globalParams->getEnableT1lib(),
 #endif
 #if HAVE_FREETYPE_FREETYPE_H || HAVE_FREETYPE_H
-				    globalParams->getEnableFreeType(),
-				    enableFreeTypeHinting,
-				    enableSlightHinting,
+				      globalParams->getEnableFreeType(),
+				      enableFreeTypeHinting,
+				      enableSlightHinting,
 #endif
 				      getFontAntialias() &&
 				      colorMode != splashModeMono1);
+    fontEngineFlags = fontEngineFlagsA;
+  }
   for (i = 0; i < nT3Fonts; ++i) {
     delete t3FontCache[i];
   }
@@ -2006,6 +2066,69 @@ void SplashOutputDev::updateFont(GfxState * /*state*/) {
   needFontUpdate = gTrue;
 }
 
+// Look for a loaded font file with the data of <src> (the same embedded
+// font, or the same external font file) and the same mapping from char
+// codes to glyphs (<enc> or <codeToGID>).  If there is one, <id>,
+// <codeToGID> and a file <src> are freed, as the font engine would have
+// done, and it is returned.  Otherwise the data is set in <id> for the
+// font file about to be loaded, and NULL is returned.
+SplashFontFile *SplashOutputDev::findFontFile(SplashOutFontFileID *id,
+					      SplashFontSrc *src,
+					      GfxFontType fontType,
+					      const char **enc,
+					      int *codeToGID, int codeToGIDLen,
+					      int faceIndex) {
+  GooString *key;
+  SplashFontFile *fontFile;
+  SplashOutFontFileID *id2;
+  Guint hash;
+  int step, i;
+
+  key = GooString::format("{0:d} {1:d}\n", (int)fontType, faceIndex);
+  if (src->isFile) {
+    key->append(src->fileName);
+  }
+  if (enc) {
+    for (i = 0; i < 256; ++i) {
+      key->append('\n');
+      if (enc[i]) {
+	key->append(enc[i]);
+      }
+    }
+  }
+  key->append('\n');
+  if (codeToGID) {
+    key->append((char *)codeToGID, codeToGIDLen * (int)sizeof(int));
+  }
+
+  // FNV-1a hash of the key and of (up to) 4096 bytes spread over the
+  // data: matches() compares all of it
+  hash = 2166136261U;
+  for (i = 0; i < key->getLength(); ++i) {
+    hash = (hash ^ (Guchar)key->getChar(i)) * 16777619U;
+  }
+  if (!src->isFile) {
+    hash = (hash ^ (Guint)src->bufLen) * 16777619U;
+    step = src->bufLen / 4096 + 1;
+    for (i = 0; i < src->bufLen; i += step) {
+      hash = (hash ^ (Guchar)src->buf[i]) * 16777619U;
+    }
+  }
+  id->setData(key, src->isFile ? (SplashFontSrc *)NULL : src, hash);
+
+  if (!(fontFile = fontEngine->getFontFile(id))) {
+    return NULL;
+  }
+  id2 = (SplashOutFontFileID *)fontFile->getID();
+  id2->setFontObject(id);
+  delete id;
+  gfree(codeToGID);
+  if (src->isFile) {
+    src->unref();
+  }
+  return fontFile;
+}
+
 void SplashOutputDev::doUpdateFont(GfxState *state) {
   GfxFont *gfxFont;
   GfxFontLoc *fontLoc;
@@ -2055,7 +2178,7 @@ reload:
   if (fontsrc && !fontsrc->isFile)
       fontsrc->unref();
 
-  id = new SplashOutFontFileID(gfxFont->getID());
+  id = new SplashOutFontFileID(gfxFont->getID(), docSerial);
   if ((fontFile = fontEngine->getFontFile(id))) {
     delete id;
 
@@ -2091,7 +2214,10 @@ reload:
     // load the font file
     switch (fontType) {
     case fontType1:
-      if (!(fontFile = fontEngine->loadType1Font(
+      if (!(fontFile = findFontFile(id, fontsrc, fontType,
+			   (const char **)((Gfx8BitFont *)gfxFont)->getEncoding(),
+			   NULL, 0, 0)) &&
+	  !(fontFile = fontEngine->loadType1Font(
 			   id,
 			   fontsrc,
 			   (const char **)((Gfx8BitFont *)gfxFont)->getEncoding()))) {
@@ -2103,7 +2229,10 @@ reload:
       }
       break;
     case fontType1C:
-      if (!(fontFile = fontEngine->loadType1CFont(
+      if (!(fontFile = findFontFile(id, fontsrc, fontType,
+			   (const char **)((Gfx8BitFont *)gfxFont)->getEncoding(),
+			   NULL, 0, 0)) &&
+	  !(fontFile = fontEngine->loadType1CFont(
 			   id,
 			   fontsrc,
 			   (const char **)((Gfx8BitFont *)gfxFont)->getEncoding()))) {
@@ -2115,7 +2244,10 @@ reload:
       }
       break;
     case fontType1COT:
-      if (!(fontFile = fontEngine->loadOpenTypeT1CFont(
+      if (!(fontFile = findFontFile(id, fontsrc, fontType,
+			   (const char **)((Gfx8BitFont *)gfxFont)->getEncoding(),
+			   NULL, 0, 0)) &&
+	  !(fontFile = fontEngine->loadOpenTypeT1CFont(
 			   id,
 			   fontsrc,
 			   (const char **)((Gfx8BitFont *)gfxFont)->getEncoding()))) {
@@ -2151,7 +2283,9 @@ reload:
 	codeToGID = NULL;
 	n = 0;
       }
-      if (!(fontFile = fontEngine->loadTrueTypeFont(
+      if (!(fontFile = findFontFile(id, fontsrc, fontType, NULL,
+				     codeToGID, n, 0)) &&
+	  !(fontFile = fontEngine->loadTrueTypeFont(
 			   id,
 			   fontsrc,
 			   codeToGID, n))) {
@@ -2164,7 +2298,9 @@ reload:
       break;
     case fontCIDType0:
     case fontCIDType0C:
-      if (!(fontFile = fontEngine->loadCIDFont(
+      if (!(fontFile = findFontFile(id, fontsrc, fontType, NULL,
+				     NULL, 0, 0)) &&
+	  !(fontFile = fontEngine->loadCIDFont(
 			   id,
 			   fontsrc))) {
 	error(errSyntaxError, -1, "Couldn't create a font for '{0:s}'",
@@ -2184,7 +2320,9 @@ reload:
 	codeToGID = NULL;
 	n = 0;
       }
-      if (!(fontFile = fontEngine->loadOpenTypeCFFFont(
+      if (!(fontFile = findFontFile(id, fontsrc, fontType, NULL,
+				     codeToGID, n, 0)) &&
+	  !(fontFile = fontEngine->loadOpenTypeCFFFont(
 			   id,
 			   fontsrc,
                            codeToGID, n))) {
@@ -2221,7 +2359,9 @@ reload:
 	codeToGID = ((GfxCIDFont *)gfxFont)->getCodeToGIDMap(ff, &n);
 	delete ff;
       }
-      if (!(fontFile = fontEngine->loadTrueTypeFont(
+      if (!(fontFile = findFontFile(id, fontsrc, fontType, NULL,
+				     codeToGID, n, faceIndex)) &&
+	  !(fontFile = fontEngine->loadTrueTypeFont(
 			   id,
 			   fontsrc,
 			   codeToGID, n, faceIndex))) {
@@ -3510,7 +3650,7 @@ void SplashOutputDev::drawImage(GfxState *state, Object *ref, Stream *str,
   GfxColor deviceN;
 #endif
   Guchar pix;
-  int n, i;
+  int n, i, reduction;
 
   ctm = state->getCTM();
   for (i = 0; i < 6; ++i) {
@@ -3523,6 +3663,26 @@ void SplashOutputDev::drawImage(GfxState *state, Object *ref, Stream *str,
   mat[4] = ctm[2] + ctm[4];
   mat[5] = ctm[3] + ctm[5];
 
+  // Images which are scaled down by at least 2 are decoded at a lower
+  // resolution if the stream supports it, but never below the device
+  // size.  Color key masking needs the exact source pixels.
+  reduction = 1;
+  if (reduceImageResolution && !inlineImg && !maskColors) {
+    double scaledWidth = sqrt(ctm[0] * ctm[0] + ctm[1] * ctm[1]);
+    double scaledHeight = sqrt(ctm[2] * ctm[2] + ctm[3] * ctm[3]);
+    int factor = 1;
+    while (factor < 8 &&
+	   width / (2 * factor) >= scaledWidth &&
+	   height / (2 * factor) >= scaledHeight) {
+      factor *= 2;
+    }
+    if (factor > 1) {
+      reduction = str->reduceResolution(factor);
+      width = (width + reduction - 1) / reduction;
+      height = (height + reduction - 1) / reduction;
+    }
+  }
+
   imgData.imgStr = new ImageStream(str, width,
 				   colorMap->getNumPixelComps(),
 				   colorMap->getBits());
@@ -3640,6 +3800,9 @@ void SplashOutputDev::drawImage(GfxState *state, Object *ref, Stream *str,
   gfree(imgData.lookup);
   delete imgData.imgStr;
   str->close();
+  if (reduction > 1) {
+    str->reduceResolution(1);
+  }
 }
 
 struct SplashOutMaskedImageData {
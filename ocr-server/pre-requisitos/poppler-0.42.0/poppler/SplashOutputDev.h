@@ -41,6 +41,7 @@
 #include "poppler-config.h"
 #include "OutputDev.h"
 #include "GfxState.h"
+#include "GfxFont.h"
 #include "GlobalParams.h"
 
 class PDFDoc;
@@ -50,6 +51,9 @@ class Splash;
 class SplashPath;
 class SplashFontEngine;
 class SplashFont;
+class SplashFontFile;
+class SplashFontSrc;
+class SplashOutFontFileID;
 class T3FontCache;
 struct T3FontCacheTag;
 struct T3GlyphStack;
@@ -393,10 +397,20 @@ public:
   GBool getFontAntialias() { return fontAntialias; }
   void setFontAntialias(GBool anti) { fontAntialias = anti; }
 
+  // Decode images which are drawn at less than half their size at a lower
+  // resolution, where the stream supports it (JPEG).  Faster, but the
+  // result is not identical to scaling the full image.
+  GBool getReduceImageResolution() { return reduceImageResolution; }
+  void setReduceImageResolution(GBool reduce) { reduceImageResolution = reduce; }
+
   void setFreeTypeHinting(GBool enable, GBool enableSlightHinting);
 
 protected:
   void doUpdateFont(GfxState *state);
+  SplashFontFile *findFontFile(SplashOutFontFileID *id, SplashFontSrc *src,
+			       GfxFontType fontType, const char **enc,
+			       int *codeToGID, int codeToGIDLen,
+			       int faceIndex);
 
 private:
   GBool univariateShadedFill(GfxState *state, SplashUnivariatePattern *pattern, double tMin, double tMax);
@@ -439,6 +453,7 @@ private:
   GBool bitmapUpsideDown;
   GBool fontAntialias;
   GBool vectorAntialias;
+  GBool reduceImageResolution;
   GBool overprintPreview;
   GBool enableFreeTypeHinting;
   GBool enableSlightHinting;
@@ -454,6 +469,8 @@ private:
   SplashBitmap *bitmap;
   Splash *splash;
   SplashFontEngine *fontEngine;
+  int fontEngineFlags;		// the settings fontEngine was created with
+  int docSerial;		// incremented by startDoc()
 
   T3FontCache *			// Type 3 font cache
     t3FontCache[splashOutT3FontCacheSize];
@@ -53,6 +53,12 @@
 #endif
 #include <string.h>
 #include <ctype.h>
+#if HAVE_FCNTL_H && HAVE_SYS_MMAN_H && HAVE_SYS_STAT_H
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#define CAN_MMAP_FILES 1
+#endif
 #include "goo/gmem.h"
 #include "goo/gfile.h"
 #include "poppler-config.h"
@@ -411,6 +417,74 @@ void FileOutStream::printf(const char *format, ...)
   va_end (argptr);
 }
 
+//------------------------------------------------------------------------
+// MemOutStream
+//------------------------------------------------------------------------
+
+MemOutStream::MemOutStream ()
+{
+  buf = NULL;
+  length = size = 0;
+}
+
+MemOutStream::~MemOutStream ()
+{
+  gfree(buf);
+}
+
+void MemOutStream::close ()
+{
+
+}
+
+void MemOutStream::grow(int needed)
+{
+  if (length + needed > size) {
+    size = size ? 2 * size : 4096;
+    while (length + needed > size) {
+      size *= 2;
+    }
+    buf = (char *)grealloc(buf, size);
+  }
+}
+
+void MemOutStream::put (char c)
+{
+  if (length == size) {
+    grow(1);
+  }
+  buf[length++] = c;
+}
+
+void MemOutStream::write(const char *data, int len)
+{
+  grow(len);
+  memcpy(buf + length, data, len);
+  length += len;
+}
+
+void MemOutStream::printf(const char *format, ...)
+{
+  va_list argptr;
+  int n;
+
+  // most calls print a number or a name: try the free space first
+  grow(64);
+  va_start (argptr, format);
+  n = vsnprintf(buf + length, size - length, format, argptr);
+  va_end (argptr);
+  if (n < 0) {
+    return;
+  }
+  if (n >= size - length) {
+    grow(n + 1);
+    va_start (argptr, format);
+    vsnprintf(buf + length, size - length, format, argptr);
+    va_end (argptr);
+  }
+  length += n;
+}
+
 
 //------------------------------------------------------------------------
 // BaseStream
@@ -857,6 +931,128 @@ void FileStream::moveStart(Goffset delta) {
   bufPos = start;
 }
 
+//------------------------------------------------------------------------
+// MMapFileStream
+//------------------------------------------------------------------------
+
+MMapFileStream::MMapFileStream(const char *mapA, Goffset mapSizeA,
+			       Goffset startA, GBool limitedA,
+			       Goffset lengthA, Object *dictA):
+    BaseStream(dictA, lengthA) {
+  map = mapA;
+  mapSize = mapSizeA;
+  fileName = NULL;
+  start = startA;
+  limited = limitedA;
+  length = lengthA;
+  setEnd();
+  savePos = 0;
+  saved = gFalse;
+}
+
+MMapFileStream *MMapFileStream::open(GooString *fileNameA, Object *dictA) {
+#ifdef CAN_MMAP_FILES
+  struct stat st;
+  void *p;
+  int fd;
+
+  if ((fd = ::open(fileNameA->getCString(), O_RDONLY)) < 0) {
+    return NULL;
+  }
+  if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+    ::close(fd);
+    return NULL;
+  }
+  p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) {
+    return NULL;
+  }
+  MMapFileStream *str = new MMapFileStream((const char *)p, st.st_size,
+					   0, gFalse, st.st_size, dictA);
+  str->fileName = fileNameA->copy();
+  return str;
+#else
+  return NULL;
+#endif
+}
+
+MMapFileStream::~MMapFileStream() {
+  if (fileName) {
+#ifdef CAN_MMAP_FILES
+    munmap((void *)map, mapSize);
+#endif
+    delete fileName;
+  }
+}
+
+BaseStream *MMapFileStream::copy() {
+  return new MMapFileStream(map, mapSize, start, limited, length, &dict);
+}
+
+Stream *MMapFileStream::makeSubStream(Goffset startA, GBool limitedA,
+				      Goffset lengthA, Object *dictA) {
+  return new MMapFileStream(map, mapSize, startA, limitedA, lengthA, dictA);
+}
+
+// Set the end of the stream and move to its start.
+void MMapFileStream::setEnd() {
+  Goffset s = start < 0 ? 0 : start < mapSize ? start : mapSize;
+
+  if (limited && length >= 0 && length < mapSize - s) {
+    bufEnd = map + s + length;
+  } else {
+    bufEnd = map + mapSize;
+  }
+  bufPtr = map + s;
+}
+
+void MMapFileStream::reset() {
+  savePos = getPos();
+  saved = gTrue;
+  setEnd();
+}
+
+void MMapFileStream::close() {
+  if (saved) {
+    bufPtr = map + savePos;
+    saved = gFalse;
+  }
+}
+
+int MMapFileStream::getChars(int nChars, Guchar *buffer) {
+  int n;
+
+  if (nChars <= 0 || bufPtr >= bufEnd) {
+    return 0;
+  }
+  if (bufEnd - bufPtr < nChars) {
+    n = (int)(bufEnd - bufPtr);
+  } else {
+    n = nChars;
+  }
+  memcpy(buffer, bufPtr, n);
+  bufPtr += n;
+  return n;
+}
+
+void MMapFileStream::setPos(Goffset pos, int dir) {
+  if (dir < 0) {
+    pos = mapSize - pos;
+  }
+  if (pos < 0) {
+    pos = 0;
+  } else if (pos > mapSize) {
+    pos = mapSize;
+  }
+  bufPtr = map + pos;
+}
+
+void MMapFileStream::moveStart(Goffset delta) {
+  start += delta;
+  setEnd();
+}
+
 //------------------------------------------------------------------------
 // CachedFileStream
 //------------------------------------------------------------------------
@@ -1713,407 +1909,406 @@ inline void CCITTFaxStream::addPixelsNeg(int a1, int blackPixels) {
   }
 }
 
-int CCITTFaxStream::lookChar() {
+GBool CCITTFaxStream::readRow() {
   int code1, code2, code3;
-  int b1i, blackPixels, i, bits;
+  int b1i, blackPixels, i, n;
   GBool gotEOL;
 
-  if (buf != EOF) {
-    return buf;
+  // if at eof there are no more rows
+  if (eof) {
+    return gFalse;
   }
 
-  // read the next row
-  if (outputBits == 0) {
-
-    // if at eof just return EOF
-    if (eof) {
-      return EOF;
-    }
-
-    err = gFalse;
-
-    // 2-D encoding
-    if (nextLine2D) {
-      for (i = 0; i < columns && codingLine[i] < columns; ++i) {
-	refLine[i] = codingLine[i];
-      }
-      for (; i < columns + 2; ++i) {
-	refLine[i] = columns;
-      }
-      codingLine[0] = 0;
-      a0i = 0;
-      b1i = 0;
-      blackPixels = 0;
-      // invariant:
-      // refLine[b1i-1] <= codingLine[a0i] < refLine[b1i] < refLine[b1i+1]
-      //                                                             <= columns
-      // exception at left edge:
-      //   codingLine[a0i = 0] = refLine[b1i = 0] = 0 is possible
-      // exception at right edge:
-      //   refLine[b1i] = refLine[b1i+1] = columns is possible
-      while (codingLine[a0i] < columns && !err) {
-	code1 = getTwoDimCode();
-	switch (code1) {
-	case twoDimPass:
-	  if (likely(b1i + 1 < columns + 2)) {
-	    addPixels(refLine[b1i + 1], blackPixels);
-	    if (refLine[b1i + 1] < columns) {
-	      b1i += 2;
-	    }
-	  }
-	  break;
-	case twoDimHoriz:
-	  code1 = code2 = 0;
-	  if (blackPixels) {
-	    do {
-	      code1 += code3 = getBlackCode();
-	    } while (code3 >= 64);
-	    do {
-	      code2 += code3 = getWhiteCode();
-	    } while (code3 >= 64);
-	  } else {
-	    do {
-	      code1 += code3 = getWhiteCode();
-	    } while (code3 >= 64);
-	    do {
-	      code2 += code3 = getBlackCode();
-	    } while (code3 >= 64);
-	  }
-	  addPixels(codingLine[a0i] + code1, blackPixels);
-	  if (codingLine[a0i] < columns) {
-	    addPixels(codingLine[a0i] + code2, blackPixels ^ 1);
-	  }
-	  while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
+  err = gFalse;
+
+  // 2-D encoding
+  if (nextLine2D) {
+    for (i = 0; i < columns && codingLine[i] < columns; ++i) {
+      refLine[i] = codingLine[i];
+    }
+    // b1i never gets more than one past the first guard entry, and
+    // the pass code looks one further, so three guards are enough
+    for (n = i + 3; i < n && i < columns + 2; ++i) {
+      refLine[i] = columns;
+    }
+    codingLine[0] = 0;
+    a0i = 0;
+    b1i = 0;
+    blackPixels = 0;
+    // invariant:
+    // refLine[b1i-1] <= codingLine[a0i] < refLine[b1i] < refLine[b1i+1]
+    //                                                             <= columns
+    // exception at left edge:
+    //   codingLine[a0i = 0] = refLine[b1i = 0] = 0 is possible
+    // exception at right edge:
+    //   refLine[b1i] = refLine[b1i+1] = columns is possible
+    while (codingLine[a0i] < columns && !err) {
+      code1 = getTwoDimCode();
+      switch (code1) {
+      case twoDimPass:
+	if (likely(b1i + 1 < columns + 2)) {
+	  addPixels(refLine[b1i + 1], blackPixels);
+	  if (refLine[b1i + 1] < columns) {
 	    b1i += 2;
-	    if (unlikely(b1i > columns + 1)) {
-	      error(errSyntaxError, getPos(),
-		"Bad 2D code {0:04x} in CCITTFax stream", code1);
-	      err = gTrue;
-	      break;
-	    }
 	  }
-	  break;
-	case twoDimVertR3:
+	}
+	break;
+      case twoDimHoriz:
+	code1 = code2 = 0;
+	if (blackPixels) {
+	  do {
+	    code1 += code3 = getBlackCode();
+	  } while (code3 >= 64);
+	  do {
+	    code2 += code3 = getWhiteCode();
+	  } while (code3 >= 64);
+	} else {
+	  do {
+	    code1 += code3 = getWhiteCode();
+	  } while (code3 >= 64);
+	  do {
+	    code2 += code3 = getBlackCode();
+	  } while (code3 >= 64);
+	}
+	addPixels(codingLine[a0i] + code1, blackPixels);
+	if (codingLine[a0i] < columns) {
+	  addPixels(codingLine[a0i] + code2, blackPixels ^ 1);
+	}
+	while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
+	  b1i += 2;
 	  if (unlikely(b1i > columns + 1)) {
 	    error(errSyntaxError, getPos(),
-	      "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	"Bad 2D code {0:04x} in CCITTFax stream", code1);
 	    err = gTrue;
 	    break;
 	  }
-	  addPixels(refLine[b1i] + 3, blackPixels);
-	  blackPixels ^= 1;
-	  if (codingLine[a0i] < columns) {
-	    ++b1i;
-	    while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
-	      b1i += 2;
-	      if (unlikely(b1i > columns + 1)) {
-		error(errSyntaxError, getPos(),
-		  "Bad 2D code {0:04x} in CCITTFax stream", code1);
-		err = gTrue;
-		break;
-	      }
-	    }
-	  }
+	}
+	break;
+      case twoDimVertR3:
+	if (unlikely(b1i > columns + 1)) {
+	  error(errSyntaxError, getPos(),
+	    "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	  err = gTrue;
 	  break;
-	case twoDimVertR2:
-	  if (unlikely(b1i > columns + 1)) {
-	    error(errSyntaxError, getPos(),
-	      "Bad 2D code {0:04x} in CCITTFax stream", code1);
-	    err = gTrue;
-	    break;
-	  }
-	  addPixels(refLine[b1i] + 2, blackPixels);
-	  blackPixels ^= 1;
-	  if (codingLine[a0i] < columns) {
-	    ++b1i;
-	    while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
-	      b1i += 2;
-	      if (unlikely(b1i > columns + 1)) {
-		error(errSyntaxError, getPos(),
-		  "Bad 2D code {0:04x} in CCITTFax stream", code1);
-		err = gTrue;
-		break;
-	      }
+	}
+	addPixels(refLine[b1i] + 3, blackPixels);
+	blackPixels ^= 1;
+	if (codingLine[a0i] < columns) {
+	  ++b1i;
+	  while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
+	    b1i += 2;
+	    if (unlikely(b1i > columns + 1)) {
+	error(errSyntaxError, getPos(),
+	  "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	err = gTrue;
+	break;
 	    }
 	  }
+	}
+	break;
+      case twoDimVertR2:
+	if (unlikely(b1i > columns + 1)) {
+	  error(errSyntaxError, getPos(),
+	    "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	  err = gTrue;
 	  break;
-	case twoDimVertR1:
-	  if (unlikely(b1i > columns + 1)) {
-	    error(errSyntaxError, getPos(),
-	      "Bad 2D code {0:04x} in CCITTFax stream", code1);
-	    err = gTrue;
-	    break;
-	  }
-	  addPixels(refLine[b1i] + 1, blackPixels);
-	  blackPixels ^= 1;
-	  if (codingLine[a0i] < columns) {
-	    ++b1i;
-	    while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
-	      b1i += 2;
-	      if (unlikely(b1i > columns + 1)) {
-		error(errSyntaxError, getPos(),
-		  "Bad 2D code {0:04x} in CCITTFax stream", code1);
-		err = gTrue;
-		break;
-	      }
+	}
+	addPixels(refLine[b1i] + 2, blackPixels);
+	blackPixels ^= 1;
+	if (codingLine[a0i] < columns) {
+	  ++b1i;
+	  while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
+	    b1i += 2;
+	    if (unlikely(b1i > columns + 1)) {
+	error(errSyntaxError, getPos(),
+	  "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	err = gTrue;
+	break;
 	    }
 	  }
+	}
+	break;
+      case twoDimVertR1:
+	if (unlikely(b1i > columns + 1)) {
+	  error(errSyntaxError, getPos(),
+	    "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	  err = gTrue;
 	  break;
-	case twoDimVert0:
-	  if (unlikely(b1i > columns + 1)) {
-	    error(errSyntaxError, getPos(),
-	      "Bad 2D code {0:04x} in CCITTFax stream", code1);
-	    err = gTrue;
-	    break;
-	  }
-	  addPixels(refLine[b1i], blackPixels);
-	  blackPixels ^= 1;
-	  if (codingLine[a0i] < columns) {
-	    ++b1i;
-	    while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
-	      b1i += 2;
-	      if (unlikely(b1i > columns + 1)) {
-		error(errSyntaxError, getPos(),
-		  "Bad 2D code {0:04x} in CCITTFax stream", code1);
-		err = gTrue;
-		break;
-	      }
+	}
+	addPixels(refLine[b1i] + 1, blackPixels);
+	blackPixels ^= 1;
+	if (codingLine[a0i] < columns) {
+	  ++b1i;
+	  while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
+	    b1i += 2;
+	    if (unlikely(b1i > columns + 1)) {
+	error(errSyntaxError, getPos(),
+	  "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	err = gTrue;
+	break;
 	    }
 	  }
+	}
+	break;
+      case twoDimVert0:
+	if (unlikely(b1i > columns + 1)) {
+	  error(errSyntaxError, getPos(),
+	    "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	  err = gTrue;
 	  break;
-	case twoDimVertL3:
-	  if (unlikely(b1i > columns + 1)) {
-	    error(errSyntaxError, getPos(),
-	      "Bad 2D code {0:04x} in CCITTFax stream", code1);
-	    err = gTrue;
-	    break;
-	  }
-	  addPixelsNeg(refLine[b1i] - 3, blackPixels);
-	  blackPixels ^= 1;
-	  if (codingLine[a0i] < columns) {
-	    if (b1i > 0) {
-	      --b1i;
-	    } else {
-	      ++b1i;
-	    }
-	    while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
-	      b1i += 2;
-	      if (unlikely(b1i > columns + 1)) {
-		error(errSyntaxError, getPos(),
-		  "Bad 2D code {0:04x} in CCITTFax stream", code1);
-		err = gTrue;
-		break;
-	      }
+	}
+	addPixels(refLine[b1i], blackPixels);
+	blackPixels ^= 1;
+	if (codingLine[a0i] < columns) {
+	  ++b1i;
+	  while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
+	    b1i += 2;
+	    if (unlikely(b1i > columns + 1)) {
+	error(errSyntaxError, getPos(),
+	  "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	err = gTrue;
+	break;
 	    }
 	  }
+	}
+	break;
+      case twoDimVertL3:
+	if (unlikely(b1i > columns + 1)) {
+	  error(errSyntaxError, getPos(),
+	    "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	  err = gTrue;
 	  break;
-	case twoDimVertL2:
-	  if (unlikely(b1i > columns + 1)) {
-	    error(errSyntaxError, getPos(),
-	      "Bad 2D code {0:04x} in CCITTFax stream", code1);
-	    err = gTrue;
-	    break;
+	}
+	addPixelsNeg(refLine[b1i] - 3, blackPixels);
+	blackPixels ^= 1;
+	if (codingLine[a0i] < columns) {
+	  if (b1i > 0) {
+	    --b1i;
+	  } else {
+	    ++b1i;
 	  }
-	  addPixelsNeg(refLine[b1i] - 2, blackPixels);
-	  blackPixels ^= 1;
-	  if (codingLine[a0i] < columns) {
-	    if (b1i > 0) {
-	      --b1i;
-	    } else {
-	      ++b1i;
-	    }
-	    while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
-	      b1i += 2;
-	      if (unlikely(b1i > columns + 1)) {
-	        error(errSyntaxError, getPos(),
-		  "Bad 2D code {0:04x} in CCITTFax stream", code1);
-	        err = gTrue;
-	        break;
-	      }
+	  while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
+	    b1i += 2;
+	    if (unlikely(b1i > columns + 1)) {
+	error(errSyntaxError, getPos(),
+	  "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	err = gTrue;
+	break;
 	    }
 	  }
+	}
+	break;
+      case twoDimVertL2:
+	if (unlikely(b1i > columns + 1)) {
+	  error(errSyntaxError, getPos(),
+	    "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	  err = gTrue;
 	  break;
-	case twoDimVertL1:
-	  if (unlikely(b1i > columns + 1)) {
-	    error(errSyntaxError, getPos(),
-	      "Bad 2D code {0:04x} in CCITTFax stream", code1);
-	    err = gTrue;
-	    break;
+	}
+	addPixelsNeg(refLine[b1i] - 2, blackPixels);
+	blackPixels ^= 1;
+	if (codingLine[a0i] < columns) {
+	  if (b1i > 0) {
+	    --b1i;
+	  } else {
+	    ++b1i;
 	  }
-	  addPixelsNeg(refLine[b1i] - 1, blackPixels);
-	  blackPixels ^= 1;
-	  if (codingLine[a0i] < columns) {
-	    if (b1i > 0) {
-	      --b1i;
-	    } else {
-	      ++b1i;
-	    }
-	    while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
-	      b1i += 2;
-	      if (unlikely(b1i > columns + 1)) {
-		error(errSyntaxError, getPos(),
-		  "Bad 2D code {0:04x} in CCITTFax stream", code1);
-		err = gTrue;
-		break;
-	      }
+	  while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
+	    b1i += 2;
+	    if (unlikely(b1i > columns + 1)) {
+	      error(errSyntaxError, getPos(),
+	  "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	      err = gTrue;
+	      break;
 	    }
 	  }
-	  break;
-	case EOF:
-	  addPixels(columns, 0);
-	  eof = gTrue;
-	  break;
-	default:
+	}
+	break;
+      case twoDimVertL1:
+	if (unlikely(b1i > columns + 1)) {
 	  error(errSyntaxError, getPos(),
-		"Bad 2D code {0:04x} in CCITTFax stream", code1);
-	  addPixels(columns, 0);
+	    "Bad 2D code {0:04x} in CCITTFax stream", code1);
 	  err = gTrue;
 	  break;
 	}
-      }
-
-    // 1-D encoding
-    } else {
-      codingLine[0] = 0;
-      a0i = 0;
-      blackPixels = 0;
-      while (codingLine[a0i] < columns) {
-	code1 = 0;
-	if (blackPixels) {
-	  do {
-	    code1 += code3 = getBlackCode();
-	  } while (code3 >= 64);
-	} else {
-	  do {
-	    code1 += code3 = getWhiteCode();
-	  } while (code3 >= 64);
-	}
-	addPixels(codingLine[a0i] + code1, blackPixels);
+	addPixelsNeg(refLine[b1i] - 1, blackPixels);
 	blackPixels ^= 1;
+	if (codingLine[a0i] < columns) {
+	  if (b1i > 0) {
+	    --b1i;
+	  } else {
+	    ++b1i;
+	  }
+	  while (refLine[b1i] <= codingLine[a0i] && refLine[b1i] < columns) {
+	    b1i += 2;
+	    if (unlikely(b1i > columns + 1)) {
+	error(errSyntaxError, getPos(),
+	  "Bad 2D code {0:04x} in CCITTFax stream", code1);
+	err = gTrue;
+	break;
+	    }
+	  }
+	}
+	break;
+      case EOF:
+	addPixels(columns, 0);
+	eof = gTrue;
+	break;
+      default:
+	error(errSyntaxError, getPos(),
+	"Bad 2D code {0:04x} in CCITTFax stream", code1);
+	addPixels(columns, 0);
+	err = gTrue;
+	break;
       }
     }
 
-    // check for end-of-line marker, skipping over any extra zero bits
-    // (if EncodedByteAlign is true and EndOfLine is false, there can
-    // be "false" EOL markers -- i.e., if the last n unused bits in
-    // row i are set to zero, and the first 11-n bits in row i+1
-    // happen to be zero -- so we don't look for EOL markers in this
-    // case)
-    gotEOL = gFalse;
-    if (!endOfBlock && row == rows - 1) {
-      eof = gTrue;
-    } else if (endOfLine || !byteAlign) {
-      code1 = lookBits(12);
-      if (endOfLine) {
-	while (code1 != EOF && code1 != 0x001) {
-	  eatBits(1);
-	  code1 = lookBits(12);
-	}
+  // 1-D encoding
+  } else {
+    codingLine[0] = 0;
+    a0i = 0;
+    blackPixels = 0;
+    while (codingLine[a0i] < columns) {
+      code1 = 0;
+      if (blackPixels) {
+	do {
+	  code1 += code3 = getBlackCode();
+	} while (code3 >= 64);
       } else {
-	while (code1 == 0) {
-	  eatBits(1);
-	  code1 = lookBits(12);
-	}
-      }
-      if (code1 == 0x001) {
-	eatBits(12);
-	gotEOL = gTrue;
+	do {
+	  code1 += code3 = getWhiteCode();
+	} while (code3 >= 64);
       }
+      addPixels(codingLine[a0i] + code1, blackPixels);
+      blackPixels ^= 1;
     }
+  }
 
-    // byte-align the row
-    // (Adobe apparently doesn't do byte alignment after EOL markers
-    // -- I've seen CCITT image data streams in two different formats,
-    // both with the byteAlign flag set:
-    //   1. xx:x0:01:yy:yy
-    //   2. xx:00:1y:yy:yy
-    // where xx is the previous line, yy is the next line, and colons
-    // separate bytes.)
-    if (byteAlign && !gotEOL) {
-      inputBits &= ~7;
+  // check for end-of-line marker, skipping over any extra zero bits
+  // (if EncodedByteAlign is true and EndOfLine is false, there can
+  // be "false" EOL markers -- i.e., if the last n unused bits in
+  // row i are set to zero, and the first 11-n bits in row i+1
+  // happen to be zero -- so we don't look for EOL markers in this
+  // case)
+  gotEOL = gFalse;
+  if (!endOfBlock && row == rows - 1) {
+    eof = gTrue;
+  } else if (endOfLine || !byteAlign) {
+    code1 = lookBits(12);
+    if (endOfLine) {
+      while (code1 != EOF && code1 != 0x001) {
+	eatBits(1);
+	code1 = lookBits(12);
+      }
+    } else {
+      while (code1 == 0) {
+	eatBits(1);
+	code1 = lookBits(12);
+      }
     }
-
-    // check for end of stream
-    if (lookBits(1) == EOF) {
-      eof = gTrue;
+    if (code1 == 0x001) {
+      eatBits(12);
+      gotEOL = gTrue;
     }
+  }
 
-    // get 2D encoding tag
-    if (!eof && encoding > 0) {
-      nextLine2D = !lookBits(1);
-      eatBits(1);
-    }
+  // byte-align the row
+  // (Adobe apparently doesn't do byte alignment after EOL markers
+  // -- I've seen CCITT image data streams in two different formats,
+  // both with the byteAlign flag set:
+  //   1. xx:x0:01:yy:yy
+  //   2. xx:00:1y:yy:yy
+  // where xx is the previous line, yy is the next line, and colons
+  // separate bytes.)
+  if (byteAlign && !gotEOL) {
+    inputBits &= ~7;
+  }
 
-    // check for end-of-block marker
-    if (endOfBlock && !endOfLine && byteAlign) {
-      // in this case, we didn't check for an EOL code above, so we
-      // need to check here
-      code1 = lookBits(24);
-      if (code1 == 0x001001) {
-	eatBits(12);
-	gotEOL = gTrue;
-      }
+  // check for end of stream
+  if (lookBits(1) == EOF) {
+    eof = gTrue;
+  }
+
+  // get 2D encoding tag
+  if (!eof && encoding > 0) {
+    nextLine2D = !lookBits(1);
+    eatBits(1);
+  }
+
+  // check for end-of-block marker
+  if (endOfBlock && !endOfLine && byteAlign) {
+    // in this case, we didn't check for an EOL code above, so we
+    // need to check here
+    code1 = lookBits(24);
+    if (code1 == 0x001001) {
+      eatBits(12);
+      gotEOL = gTrue;
     }
-    if (endOfBlock && gotEOL) {
-      code1 = lookBits(12);
-      if (code1 == 0x001) {
-	eatBits(12);
-	if (encoding > 0) {
-	  lookBits(1);
-	  eatBits(1);
-	}
-	if (encoding >= 0) {
-	  for (i = 0; i < 4; ++i) {
-	    code1 = lookBits(12);
-	    if (code1 != 0x001) {
-	      error(errSyntaxError, getPos(),
-		    "Bad RTC code in CCITTFax stream");
-	    }
-	    eatBits(12);
-	    if (encoding > 0) {
-	      lookBits(1);
-	      eatBits(1);
-	    }
+  }
+  if (endOfBlock && gotEOL) {
+    code1 = lookBits(12);
+    if (code1 == 0x001) {
+      eatBits(12);
+      if (encoding > 0) {
+	lookBits(1);
+	eatBits(1);
+      }
+      if (encoding >= 0) {
+	for (i = 0; i < 4; ++i) {
+	  code1 = lookBits(12);
+	  if (code1 != 0x001) {
+	    error(errSyntaxError, getPos(),
+	    "Bad RTC code in CCITTFax stream");
+	  }
+	  eatBits(12);
+	  if (encoding > 0) {
+	    lookBits(1);
+	    eatBits(1);
 	  }
 	}
-	eof = gTrue;
       }
+      eof = gTrue;
+    }
 
-    // look for an end-of-line marker after an error -- we only do
-    // this if we know the stream contains end-of-line markers because
-    // the "just plow on" technique tends to work better otherwise
-    } else if (err && endOfLine) {
-      while (1) {
-	code1 = lookBits(13);
-	if (code1 == EOF) {
-	  eof = gTrue;
-	  return EOF;
-	}
-	if ((code1 >> 1) == 0x001) {
-	  break;
-	}
-	eatBits(1);
+  // look for an end-of-line marker after an error -- we only do
+  // this if we know the stream contains end-of-line markers because
+  // the "just plow on" technique tends to work better otherwise
+  } else if (err && endOfLine) {
+    while (1) {
+      code1 = lookBits(13);
+      if (code1 == EOF) {
+	eof = gTrue;
+	return gFalse;
       }
-      eatBits(12); 
-      if (encoding > 0) {
-	eatBits(1);
-	nextLine2D = !(code1 & 1);
+      if ((code1 >> 1) == 0x001) {
+	break;
       }
+      eatBits(1);
     }
-
-    // set up for output
-    if (codingLine[0] > 0) {
-      outputBits = codingLine[a0i = 0];
-    } else {
-      outputBits = codingLine[a0i = 1];
+    eatBits(12); 
+    if (encoding > 0) {
+      eatBits(1);
+      nextLine2D = !(code1 & 1);
     }
+  }
 
-    ++row;
+  // set up for output
+  if (codingLine[0] > 0) {
+    outputBits = codingLine[a0i = 0];
+  } else {
+    outputBits = codingLine[a0i = 1];
   }
 
-  // get a byte
+  ++row;
+  return gTrue;
+}
+
+// Returns the next byte of the current row.
+inline int CCITTFaxStream::readRowByte() {
+  int c, bits;
+
   if (outputBits >= 8) {
-    buf = (a0i & 1) ? 0x00 : 0xff;
+    c = (a0i & 1) ? 0x00 : 0xff;
     outputBits -= 8;
     if (outputBits == 0 && codingLine[a0i] < columns) {
       ++a0i;
@@ -2121,19 +2316,19 @@ int CCITTFaxStream::lookChar() {
     }
   } else {
     bits = 8;
-    buf = 0;
+    c = 0;
     do {
       if (outputBits > bits) {
-	buf <<= bits;
+	c <<= bits;
 	if (!(a0i & 1)) {
-	  buf |= 0xff >> (8 - bits);
+	  c |= 0xff >> (8 - bits);
 	}
 	outputBits -= bits;
 	bits = 0;
       } else {
-	buf <<= outputBits;
+	c <<= outputBits;
 	if (!(a0i & 1)) {
-	  buf |= 0xff >> (8 - outputBits);
+	  c |= 0xff >> (8 - outputBits);
 	}
 	bits -= outputBits;
 	outputBits = 0;
@@ -2147,18 +2342,68 @@ int CCITTFaxStream::lookChar() {
 	  }
 	  outputBits = codingLine[a0i] - codingLine[a0i - 1];
 	} else if (bits > 0) {
-	  buf <<= bits;
+	  c <<= bits;
 	  bits = 0;
 	}
       }
     } while (bits);
   }
   if (black) {
-    buf ^= 0xff;
+    c ^= 0xff;
   }
+  return c;
+}
+
+int CCITTFaxStream::lookChar() {
+  if (buf != EOF) {
+    return buf;
+  }
+
+  // read the next row
+  if (outputBits == 0 && !readRow()) {
+    return EOF;
+  }
+
+  buf = readRowByte();
   return buf;
 }
 
+int CCITTFaxStream::getChars(int nChars, Guchar *buffer) {
+  int n, k, c;
+
+  n = 0;
+  if (nChars > 0 && buf != EOF) {
+    buffer[n++] = (Guchar)buf;
+    buf = EOF;
+  }
+  while (n < nChars) {
+    if (outputBits == 0 && !readRow()) {
+      break;
+    }
+    // whole bytes of a single run are filled at once
+    if (outputBits >= 8) {
+      c = (a0i & 1) ? 0x00 : 0xff;
+      if (black) {
+	c ^= 0xff;
+      }
+      k = outputBits >> 3;
+      if (k > nChars - n) {
+	k = nChars - n;
+      }
+      memset(buffer + n, c, k);
+      n += k;
+      outputBits -= k << 3;
+      if (outputBits == 0 && codingLine[a0i] < columns) {
+	++a0i;
+	outputBits = codingLine[a0i] - codingLine[a0i - 1];
+      }
+    } else {
+      buffer[n++] = (Guchar)readRowByte();
+    }
+  }
+  return n;
+}
+
 short CCITTFaxStream::getTwoDimCode() {
   int code;
   const CCITTCode *p;
@@ -2327,10 +2572,12 @@ short CCITTFaxStream::getBlackCode() {
   return 1;
 }
 
-short CCITTFaxStream::lookBits(int n) {
+short CCITTFaxStream::fillBits(int n) {
   int c;
 
-  while (inputBits < n) {
+  // load as many whole bytes as fit, so that the next few lookBits calls
+  // don't have to go back to the underlying stream
+  while (inputBits <= 24) {
     if ((c = str->getChar()) == EOF) {
       if (inputBits == 0) {
 	return EOF;
@@ -2339,7 +2586,10 @@ short CCITTFaxStream::lookBits(int n) {
       // than are available, but there may still be a valid code in
       // however many bits are available -- we need to return correct
       // data in this case
-      return (inputBuf << (n - inputBits)) & (0xffffffff >> (32 - n));
+      if (inputBits < n) {
+	return (inputBuf << (n - inputBits)) & (0xffffffff >> (32 - n));
+      }
+      break;
     }
     inputBuf = (inputBuf << 8) + c;
     inputBits += 8;
@@ -4584,16 +4834,28 @@ int FlateStream::getChar() {
 }
 
 int FlateStream::getChars(int nChars, Guchar *buffer) {
+  int n, m;
+
   if (pred) {
     return pred->getChars(nChars, buffer);
-  } else {
-    for (int i = 0; i < nChars; ++i) {
-      const int c = doGetRawChar();
-      if (likely(c != EOF)) buffer[i] = c;
-      else return i;
+  }
+  // copy out whole runs of the output buffer
+  for (n = 0; n < nChars; n += m) {
+    while (remain == 0) {
+      if (endOfBlock && eof)
+	return n;
+      readSome();
     }
-    return nChars;
+    m = nChars - n;
+    if (m > remain)
+      m = remain;
+    if (m > flateWindow - index)
+      m = flateWindow - index;
+    memcpy(buffer + n, buf + index, m);
+    index = (index + m) & flateMask;
+    remain -= m;
   }
+  return nChars;
 }
 
 int FlateStream::lookChar() {
@@ -4612,8 +4874,27 @@ int FlateStream::lookChar() {
 }
 
 void FlateStream::getRawChars(int nChars, int *buffer) {
-  for (int i = 0; i < nChars; ++i)
-    buffer[i] = doGetRawChar();
+  int n, m, i;
+
+  for (n = 0; n < nChars; n += m) {
+    while (remain == 0) {
+      if (endOfBlock && eof) {
+	for (; n < nChars; ++n)
+	  buffer[n] = EOF;
+	return;
+      }
+      readSome();
+    }
+    m = nChars - n;
+    if (m > remain)
+      m = remain;
+    if (m > flateWindow - index)
+      m = flateWindow - index;
+    for (i = 0; i < m; ++i)
+      buffer[n + i] = buf[index + i];
+    index = (index + m) & flateMask;
+    remain -= m;
+  }
 }
 
 int FlateStream::getRawChar() {
@@ -4637,7 +4918,11 @@ GBool FlateStream::isBinary(GBool last) {
   return str->isBinary(gTrue);
 }
 
+// Decodes into the output buffer, after the <remain> bytes not yet read,
+// until the end of the block or until the buffer could not hold another
+// match.
 void FlateStream::readSome() {
+  FlateCode *code;
   int code1, code2;
   int len, dist;
   int i, j, k;
@@ -4648,47 +4933,69 @@ void FlateStream::readSome() {
       return;
   }
 
+  i = (index + remain) & flateMask;
   if (compressedBlock) {
-    if ((code1 = getHuffmanCodeWord(&litCodeTab)) == EOF)
-      goto err;
-    if (code1 < 256) {
-      buf[index] = code1;
-      remain = 1;
-    } else if (code1 == 256) {
-      endOfBlock = gTrue;
-      remain = 0;
-    } else {
-      code1 -= 257;
-      code2 = lengthDecode[code1].bits;
-      if (code2 > 0 && (code2 = getCodeWord(code2)) == EOF)
-	goto err;
-      len = lengthDecode[code1].first + code2;
-      if ((code1 = getHuffmanCodeWord(&distCodeTab)) == EOF)
+    while (remain <= flateWindow - flateMaxMatch) {
+      // inline fast path of getHuffmanCodeWord for a full code buffer
+      if (codeSize >= litCodeTab.maxLen) {
+	code = &litCodeTab.codes[codeBuf & ((1 << litCodeTab.maxLen) - 1)];
+	if (code->len == 0)
+	  goto err;
+	codeBuf >>= code->len;
+	codeSize -= code->len;
+	code1 = code->val;
+      } else if ((code1 = getHuffmanCodeWord(&litCodeTab)) == EOF) {
 	goto err;
-      code2 = distDecode[code1].bits;
-      if (code2 > 0 && (code2 = getCodeWord(code2)) == EOF)
-	goto err;
-      dist = distDecode[code1].first + code2;
-      i = index;
-      j = (index - dist) & flateMask;
-      for (k = 0; k < len; ++k) {
-	buf[i] = buf[j];
+      }
+      if (code1 < 256) {
+	buf[i] = code1;
 	i = (i + 1) & flateMask;
-	j = (j + 1) & flateMask;
+	++remain;
+      } else if (code1 == 256) {
+	endOfBlock = gTrue;
+	break;
+      } else {
+	code1 -= 257;
+	code2 = lengthDecode[code1].bits;
+	if (code2 > 0 && (code2 = getCodeWord(code2)) == EOF)
+	  goto err;
+	len = lengthDecode[code1].first + code2;
+	if ((code1 = getHuffmanCodeWord(&distCodeTab)) == EOF)
+	  goto err;
+	code2 = distDecode[code1].bits;
+	if (code2 > 0 && (code2 = getCodeWord(code2)) == EOF)
+	  goto err;
+	dist = distDecode[code1].first + code2;
+	j = (i - dist) & flateMask;
+	if (i + len <= flateWindow && j + len <= flateWindow) {
+	  // no wrap around; copy bytewise, the source may overlap the target
+	  for (k = 0; k < len; ++k) {
+	    buf[i + k] = buf[j + k];
+	  }
+	  i = (i + len) & flateMask;
+	} else {
+	  for (k = 0; k < len; ++k) {
+	    buf[i] = buf[j];
+	    i = (i + 1) & flateMask;
+	    j = (j + 1) & flateMask;
+	  }
+	}
+	remain += len;
       }
-      remain = len;
     }
 
   } else {
-    len = (blockLen < flateWindow) ? blockLen : flateWindow;
-    for (i = 0, j = index; i < len; ++i, j = (j + 1) & flateMask) {
+    len = flateWindow - remain;
+    if (blockLen < len)
+      len = blockLen;
+    for (k = 0; k < len; ++k, i = (i + 1) & flateMask) {
       if ((c = str->getChar()) == EOF) {
 	endOfBlock = eof = gTrue;
 	break;
       }
-      buf[j] = c & 0xff;
+      buf[i] = c & 0xff;
     }
-    remain = i;
+    remain += k;
     blockLen -= len;
     if (blockLen == 0)
       endOfBlock = gTrue;
@@ -4697,9 +5004,9 @@ void FlateStream::readSome() {
   return;
 
 err:
+  // keep what was decoded before the error
   error(errSyntaxError, getPos(), "Unexpected end of file in flate stream");
   endOfBlock = eof = gTrue;
-  remain = 0;
 }
 
 GBool FlateStream::startBlock() {
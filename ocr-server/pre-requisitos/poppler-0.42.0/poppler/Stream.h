@@ -220,6 +220,12 @@ public:
   virtual void getImageParams(int * /*bitsPerComponent*/,
 			      StreamColorSpaceMode * /*csMode*/) {}
 
+  // Ask an image stream that can decode at a lower resolution (JPEG) to
+  // decode at 1/<factor> of the image width and height, rounded up, from
+  // the next reset() on.  Returns the factor which will be used, 1 if the
+  // stream always decodes at full resolution.
+  virtual int reduceResolution(int /*factor*/) { return 1; }
+
   // Return the next stream in the "stack".
   virtual Stream *getNextStream() { return NULL; }
 
@@ -295,6 +301,43 @@ private:
 
 };
 
+//------------------------------------------------------------------------
+// MemOutStream
+//
+// Collects the output in a growing memory buffer.
+//------------------------------------------------------------------------
+class MemOutStream : public OutStream {
+public:
+  MemOutStream ();
+
+  virtual ~MemOutStream ();
+
+  virtual void close();
+
+  virtual Goffset getPos() { return length; }
+
+  virtual void put (char c);
+
+  virtual void printf (const char *format, ...);
+
+  // Return the data written so far (not null terminated).
+  char *getData() { return buf; }
+  int getLength() { return length; }
+
+  // Discard the data, keeping the buffer.
+  void clear() { length = 0; }
+
+  // Append <len> bytes of <data>.
+  void write(const char *data, int len);
+
+private:
+  void grow(int needed);
+
+  char *buf;
+  int length;
+  int size;
+};
+
 
 //------------------------------------------------------------------------
 // BaseStream
@@ -506,6 +549,62 @@ private:
   GBool saved;
 };
 
+//------------------------------------------------------------------------
+// MMapFileStream
+//
+// A file stream read from a read-only mapping of the whole file, so
+// getChar, getChars, lookChar and setPos neither copy through a buffer
+// nor call the system.  The stream returned by open() owns the mapping;
+// its substreams and copies must be deleted before it, as for MemStream.
+//------------------------------------------------------------------------
+
+class MMapFileStream: public BaseStream {
+public:
+
+  // Map the file.  Returns NULL if the file can't be opened or mapped
+  // (or mapping is not supported on this system).
+  static MMapFileStream *open(GooString *fileNameA, Object *dictA);
+
+  virtual ~MMapFileStream();
+  virtual BaseStream *copy();
+  virtual Stream *makeSubStream(Goffset startA, GBool limitedA,
+				Goffset lengthA, Object *dictA);
+  virtual StreamKind getKind() { return strFile; }
+  virtual void reset();
+  virtual void close();
+  virtual int getChar()
+    { return (bufPtr < bufEnd) ? (*bufPtr++ & 0xff) : EOF; }
+  virtual int lookChar()
+    { return (bufPtr < bufEnd) ? (*bufPtr & 0xff) : EOF; }
+  virtual Goffset getPos() { return bufPtr - map; }
+  virtual void setPos(Goffset pos, int dir = 0);
+  virtual Goffset getStart() { return start; }
+  virtual void moveStart(Goffset delta);
+  virtual GooString *getFileName() { return fileName; }
+
+  virtual int getUnfilteredChar () { return getChar(); }
+  virtual void unfilteredReset () { reset(); }
+
+private:
+
+  MMapFileStream(const char *mapA, Goffset mapSizeA, Goffset startA,
+		 GBool limitedA, Goffset lengthA, Object *dictA);
+  void setEnd();
+
+  virtual GBool hasGetChars() { return true; }
+  virtual int getChars(int nChars, Guchar *buffer);
+
+  const char *map;		// the whole file
+  Goffset mapSize;
+  GooString *fileName;		// set in the stream that owns the mapping
+  Goffset start;
+  GBool limited;
+  const char *bufEnd;		// end of this stream
+  const char *bufPtr;
+  Goffset savePos;
+  GBool saved;
+};
+
 //------------------------------------------------------------------------
 // CachedFileStream
 //------------------------------------------------------------------------
@@ -797,6 +896,11 @@ public:
 
   virtual void unfilteredReset ();
 
+  // Packed rows are written straight into the buffer, with runs of
+  // whole bytes filled at once.
+  virtual GBool hasGetChars() { return true; }
+  virtual int getChars(int nChars, Guchar *buffer);
+
   int getEncoding() { return encoding; }
   GBool getEndOfLine() { return endOfLine; }
   int getColumns() { return columns; }
@@ -824,12 +928,18 @@ private:
   int outputBits;		// remaining ouput bits
   int buf;			// character buffer
 
+  GBool readRow();
+  int readRowByte();
   void addPixels(int a1, int blackPixels);
   void addPixelsNeg(int a1, int blackPixels);
   short getTwoDimCode();
   short getWhiteCode();
   short getBlackCode();
-  short lookBits(int n);
+  short lookBits(int n)
+    { return inputBits >= n ? (short)((inputBuf >> (inputBits - n)) &
+				      (0xffffffff >> (32 - n)))
+			    : fillBits(n); }
+  short fillBits(int n);
   void eatBits(int n) { if ((inputBits -= n) < 0) inputBits = 0; }
 };
 
@@ -953,6 +1063,7 @@ private:
 #define flateMaxCodeLenCodes    19    // max # code length codes
 #define flateMaxLitCodes       288    // max # literal codes
 #define flateMaxDistCodes       30    // max # distance codes
+#define flateMaxMatch          258    // max length of a match
 
 // Huffman code table entry
 struct FlateCode {
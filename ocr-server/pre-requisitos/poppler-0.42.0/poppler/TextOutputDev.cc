@@ -2357,6 +2357,10 @@ TextPage::TextPage(GBool rawOrderA) {
   blocks = NULL;
   rawWords = NULL;
   rawLastWord = NULL;
+  wordStreamFunc = NULL;
+  wordStream = NULL;
+  wordStreamPage = 0;
+  wordStreamMap = NULL;
   fonts = new GooList();
   lastFindXMin = lastFindYMin = 0;
   haveLastFind = gFalse;
@@ -2377,6 +2381,9 @@ TextPage::~TextPage() {
   delete fonts;
   deleteGooList(underlines, TextUnderline);
   deleteGooList(links, TextLink);
+  if (wordStreamMap) {
+    wordStreamMap->decRefCnt();
+  }
 }
 
 void TextPage::incRefCnt() {
@@ -2732,6 +2739,12 @@ void TextPage::addWord(TextWord *word) {
     return;
   }
 
+  if (wordStreamFunc) {
+    writeStreamWord(word);
+    delete word;
+    return;
+  }
+
   if (rawOrder) {
     if (rawLastWord) {
       rawLastWord->next = word;
@@ -2744,6 +2757,71 @@ void TextPage::addWord(TextWord *word) {
   }
 }
 
+void TextPage::setWordStream(TextOutputFunc func, void *stream, int pageNum) {
+  wordStreamFunc = func;
+  wordStream = stream;
+  wordStreamPage = pageNum;
+  if (func && !wordStreamMap) {
+    GooString enc("UTF-8");
+    wordStreamMap = globalParams->getUnicodeMap(&enc);
+  }
+}
+
+// Write <x> with two decimals, followed by a space, at <p>; returns the
+// number of chars written (at most 24).  printf is much slower, and
+// there are four of these for every word.
+static int formatStreamCoord(double x, char *p) {
+  char digits[24];
+  long long v;
+  int n, i;
+
+  n = 0;
+  if (!(x > -1e15 && x < 1e15)) {
+    x = 0;
+  }
+  if (x < 0) {
+    p[n++] = '-';
+    x = -x;
+  }
+  v = (long long)(x * 100 + 0.5);
+  i = 0;
+  do {
+    digits[i++] = (char)('0' + v % 10);
+    v /= 10;
+  } while (v > 0 || i < 3);
+  while (i > 2) {
+    p[n++] = digits[--i];
+  }
+  p[n++] = '.';
+  p[n++] = digits[1];
+  p[n++] = digits[0];
+  p[n++] = ' ';
+  return n;
+}
+
+void TextPage::writeStreamWord(TextWord *word) {
+  char buf[256];
+  int i, n;
+
+  n = sprintf(buf, "%d ", wordStreamPage);
+  n += formatStreamCoord(word->xMin, buf + n);
+  n += formatStreamCoord(word->yMin, buf + n);
+  n += formatStreamCoord(word->xMax, buf + n);
+  n += formatStreamCoord(word->yMax, buf + n);
+  for (i = 0; i < word->len; ++i) {
+    if (n > (int)sizeof(buf) - 9) {
+      (*wordStreamFunc)(wordStream, buf, n);
+      n = 0;
+    }
+    // keep the word on its line
+    if (word->text[i] >= 0x20 && wordStreamMap) {
+      n += wordStreamMap->mapUnicode(word->text[i], buf + n, 8);
+    }
+  }
+  buf[n++] = '\n';
+  (*wordStreamFunc)(wordStream, buf, n);
+}
+
 void TextPage::addUnderline(double x0, double y0, double x1, double y1) {
   underlines->append(new TextUnderline(x0, y0, x1, y1));
 }
@@ -5554,6 +5632,7 @@ TextOutputDev::TextOutputDev(char *fileName, GBool physLayoutA,
   fixedPitch = physLayout ? fixedPitchA : 0;
   rawOrder = rawOrderA;
   doHTML = gFalse;
+  wordStream = gFalse;
   ok = gTrue;
 
   // open file
@@ -5593,6 +5672,7 @@ TextOutputDev::TextOutputDev(TextOutputFunc func, void *stream,
   fixedPitch = physLayout ? fixedPitchA : 0;
   rawOrder = rawOrderA;
   doHTML = gFalse;
+  wordStream = gFalse;
   text = new TextPage(rawOrderA);
   actualText = new ActualText(text);
   ok = gTrue;
@@ -5613,10 +5693,18 @@ TextOutputDev::~TextOutputDev() {
 
 void TextOutputDev::startPage(int pageNum, GfxState *state, XRef *xref) {
   text->startPage(state);
+  if (wordStream && outputStream) {
+    text->setWordStream(outputFunc, outputStream, pageNum);
+  } else {
+    text->setWordStream(NULL, NULL, 0);
+  }
 }
 
 void TextOutputDev::endPage() {
   text->endPage();
+  if (wordStream) {
+    return;
+  }
   text->coalesce(physLayout, fixedPitch, doHTML);
   if (outputStream) {
     text->dump(outputStream, outputFunc, physLayout);
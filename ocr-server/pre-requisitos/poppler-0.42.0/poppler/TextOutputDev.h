@@ -560,6 +560,14 @@ public:
   // Add a word, sorting it into the list of words.
   void addWord(TextWord *word);
 
+  // Write each word of the page to <func> as soon as it is complete,
+  // instead of keeping it, as a UTF-8 line "<pageNum> <xMin> <yMin>
+  // <xMax> <yMax> <text>".  The words are in content stream order and
+  // only the current word is kept, so coalesce(), dump() and the find
+  // and selection functions have nothing to work on.  Must be called
+  // after startPage(); a NULL <func> turns it off.
+  void setWordStream(TextOutputFunc func, void *stream, int pageNum);
+
   // Add a (potential) underline.
   void addUnderline(double x0, double y0, double x1, double y1);
 
@@ -642,6 +650,7 @@ private:
   ~TextPage();
   
   void clear();
+  void writeStreamWord(TextWord *word);
   void assignColumns(TextLineFrag *frags, int nFrags, GBool rot);
   int dumpFragment(Unicode *text, int len, UnicodeMap *uMap, GooString *s);
 
@@ -671,6 +680,11 @@ private:
 				//   rawOrder is set)
   TextWord *rawLastWord;	// last word on rawWords list
 
+  TextOutputFunc wordStreamFunc; // see setWordStream()
+  void *wordStream;
+  int wordStreamPage;
+  UnicodeMap *wordStreamMap;	// UTF-8
+
   GooList *fonts;			// all font info objects used on this
 				//   page [TextFontInfo]
 
@@ -862,6 +876,12 @@ public:
   // Turn extra processing for HTML conversion on or off.
   void enableHTMLExtras(GBool doHTMLA) { doHTML = doHTMLA; }
 
+  // Write the words of each page as they are drawn, with their page
+  // number and bounding box, instead of the page text (see
+  // TextPage::setWordStream).  There is no layout analysis, and the
+  // memory used does not grow with the page.
+  void setWordStream(GBool wordStreamA) { wordStream = wordStreamA; }
+
 private:
 
   TextOutputFunc outputFunc;	// output function
@@ -876,6 +896,7 @@ private:
 				//   width
   GBool rawOrder;		// keep text in content stream order
   GBool doHTML;			// extra processing for HTML conversion
+  GBool wordStream;		// write the words as they are drawn
   GBool ok;			// set up ok?
 
   ActualText *actualText;
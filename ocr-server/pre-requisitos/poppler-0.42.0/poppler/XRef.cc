@@ -70,6 +70,9 @@
 #define permHighResPrint  (1<<11) // bit 12
 #define defPermFlags 0xfffc
 
+// Default number of parsed object streams kept by the XRef
+#define defObjStrCacheSize 64
+
 #if MULTITHREADED
 #  define xrefLocker()   MutexLocker locker(&mutex)
 #  define xrefCondLocker(X)  MutexLocker locker(&mutex, (X))
@@ -122,6 +125,11 @@ class ObjectStreamKey : public PopplerCacheKey
       return objStrNum == k->objStrNum;
     }
 
+    unsigned int hash() const
+    {
+      return (unsigned int)objStrNum;
+    }
+
     const int objStrNum;
 };
 
@@ -288,7 +296,7 @@ void XRef::init() {
   size = 0;
   streamEnds = NULL;
   streamEndsLen = 0;
-  objStrs = new PopplerCache(5);
+  objStrs = new PopplerCache(defObjStrCacheSize);
   mainXRefEntriesOffset = 0;
   xRefStream = gFalse;
   scannedSpecialFlags = gFalse;
@@ -1136,29 +1144,90 @@ Object *XRef::fetch(int num, int gen, Object *obj, int recursion) {
   XRefEntry *e;
   Parser *parser;
   Object obj1, obj2, obj3;
+  Goffset offset;
+  GBool decrypt;
 
-  xrefLocker();
-  // check for bogus ref - this can happen in corrupted PDF files
-  if (num < 0 || num >= size) {
-    goto err;
-  }
+  {
+    // Entries are looked up and object streams are cached under the lock,
+    // but uncompressed objects are parsed after it has been released (see
+    // below), so threads sharing the XRef don't wait for each other's
+    // parsing.
+    xrefLocker();
+    // check for bogus ref - this can happen in corrupted PDF files
+    if (num < 0 || num >= size) {
+      goto err;
+    }
 
-  e = getEntry(num);
-  if(!e->obj.isNull ()) { //check for updated object
-    obj = e->obj.copy(obj);
-    return obj;
-  }
+    e = getEntry(num);
+    if(!e->obj.isNull ()) { //check for updated object
+      obj = e->obj.copy(obj);
+      return obj;
+    }
 
-  switch (e->type) {
+    switch (e->type) {
+
+    case xrefEntryUncompressed:
+      if (e->gen != gen) {
+	goto err;
+      }
+      // the entry may move once the lock is released, keep what we need
+      offset = e->offset;
+      decrypt = encrypted && !e->getFlag(XRefEntry::Unencrypted);
+      break;
 
-  case xrefEntryUncompressed:
-    if (e->gen != gen) {
+    case xrefEntryCompressed:
+    {
+#if 0 // Adobe apparently ignores the generation number on compressed objects
+      if (gen != 0) {
+	goto err;
+      }
+#endif
+      if (e->offset >= (Guint)size ||
+	  entries[e->offset].type != xrefEntryUncompressed) {
+	error(errSyntaxError, -1, "Invalid object stream");
+	goto err;
+      }
+
+      ObjectStream *objStr = NULL;
+      ObjectStreamKey key(e->offset);
+      PopplerCacheItem *item = objStrs->lookup(key);
+      if (item) {
+	ObjectStreamItem *it = static_cast<ObjectStreamItem *>(item);
+	objStr = it->objStream;
+      }
+
+      if (!objStr) {
+	objStr = new ObjectStream(this, e->offset, recursion + 1);
+	if (!objStr->isOk()) {
+	  delete objStr;
+	  objStr = NULL;
+	  goto err;
+	} else {
+	  // XRef could be reconstructed in constructor of ObjectStream:
+	  e = getEntry(num);
+	  ObjectStreamKey *newkey = new ObjectStreamKey(e->offset);
+	  ObjectStreamItem *newitem = new ObjectStreamItem(objStr);
+	  objStrs->put(newkey, newitem);
+	}
+      }
+      objStr->getObject(e->gen, num, obj);
+      return obj;
+    }
+
+    default:
       goto err;
     }
+  }
+
+  {
+    // Each object is parsed from its own substream, and file streams read
+    // with pread, so this is safe without the lock. Other base streams may
+    // keep a shared read position, so they still parse under it.
+    xrefCondLocker(str->getKind() != strFile);
     obj1.initNull();
     parser = new Parser(this,
 	       new Lexer(this,
-		 str->makeSubStream(start + e->offset, gFalse, 0, &obj1)),
+		 str->makeSubStream(start + offset, gFalse, 0, &obj1)),
 	       gTrue);
     parser->getObj(&obj1, recursion);
     parser->getObj(&obj2, recursion);
@@ -1186,7 +1255,7 @@ Object *XRef::fetch(int num, int gen, Object *obj, int recursion) {
 	    obj2.free();
 	    obj3.free();
 	    delete parser;
-	    break;
+	    return obj;
 	  }
 	}
       }
@@ -1196,60 +1265,17 @@ Object *XRef::fetch(int num, int gen, Object *obj, int recursion) {
       delete parser;
       goto err;
     }
-    parser->getObj(obj, gFalse, (encrypted && !e->getFlag(XRefEntry::Unencrypted)) ? fileKey : NULL,
+    parser->getObj(obj, gFalse, decrypt ? fileKey : NULL,
 		   encAlgorithm, keyLength, num, gen, recursion);
     obj1.free();
     obj2.free();
     obj3.free();
     delete parser;
-    break;
-
-  case xrefEntryCompressed:
-  {
-#if 0 // Adobe apparently ignores the generation number on compressed objects
-    if (gen != 0) {
-      goto err;
-    }
-#endif
-    if (e->offset >= (Guint)size ||
-	entries[e->offset].type != xrefEntryUncompressed) {
-      error(errSyntaxError, -1, "Invalid object stream");
-      goto err;
-    }
-
-    ObjectStream *objStr = NULL;
-    ObjectStreamKey key(e->offset);
-    PopplerCacheItem *item = objStrs->lookup(key);
-    if (item) {
-      ObjectStreamItem *it = static_cast<ObjectStreamItem *>(item);
-      objStr = it->objStream;
-    }
-
-    if (!objStr) {
-      objStr = new ObjectStream(this, e->offset, recursion + 1);
-      if (!objStr->isOk()) {
-	delete objStr;
-	objStr = NULL;
-	goto err;
-      } else {
-	// XRef could be reconstructed in constructor of ObjectStream:
-	e = getEntry(num);
-	ObjectStreamKey *newkey = new ObjectStreamKey(e->offset);
-	ObjectStreamItem *newitem = new ObjectStreamItem(objStr);
-	objStrs->put(newkey, newitem);
-      }
-    }
-    objStr->getObject(e->gen, num, obj);
-  }
-  break;
-
-  default:
-    goto err;
+    return obj;
   }
-  
-  return obj;
 
  err:
+  xrefLocker();
   if (!xRefStream && !xrefReconstructed) {
     rootNum = -1;
     constructXRef(&xrefReconstructed);
@@ -1270,6 +1296,17 @@ void XRef::unlock() {
 #endif
 }
 
+void XRef::setObjStrCacheSize(int n) {
+  xrefLocker();
+  objStrs->setSize(n);
+}
+
+void XRef::getObjStrCacheStats(int *hits, int *misses) {
+  xrefLocker();
+  *hits = objStrs->hits();
+  *misses = objStrs->misses();
+}
+
 Object *XRef::getDocInfo(Object *obj) {
   return trailerDict.dictLookup("Info", obj);
 }
@@ -1282,6 +1319,7 @@ Object *XRef::getDocInfoNF(Object *obj) {
 GBool XRef::getStreamEnd(Goffset streamStart, Goffset *streamEnd) {
   int a, b, m;
 
+  xrefLocker();
   if (streamEndsLen == 0 ||
       streamStart > streamEnds[streamEndsLen - 1]) {
     return gFalse;
@@ -1304,6 +1342,7 @@ GBool XRef::getStreamEnd(Goffset streamStart, Goffset *streamEnd) {
 
 int XRef::getNumEntry(Goffset offset)
 {
+  xrefLocker();
   if (size > 0)
   {
     int res = 0;
@@ -1487,7 +1526,8 @@ void XRef::XRefStreamWriter::startSection(int first, int count) {
 void XRef::XRefStreamWriter::writeEntry(Goffset offset, int gen, XRefEntryType type) {
   const int entryTotalSize = 1 + offsetSize + 2; /* type + offset + gen */
   char data[16];
-  data[0] = (type==xrefEntryFree) ? 0 : 1;
+  // compressed entries hold the object stream number and the index in it
+  data[0] = (type==xrefEntryFree) ? 0 : (type==xrefEntryCompressed) ? 2 : 1;
   for (int i = offsetSize; i > 0; i--) {
     data[i] = offset & 0xff;
     offset >>= 8;
@@ -1509,19 +1549,19 @@ void XRef::XRefPreScanWriter::writeEntry(Goffset offset, int gen, XRefEntryType
     hasOffsetsBeyond4GB = gTrue;
 }
 
-void XRef::writeStreamToBuffer(GooString *stmBuf, Dict *xrefDict, XRef *xref) {
+void XRef::writeStreamToBuffer(GooString *stmBuf, Dict *xrefDict, XRef *xref, GBool writeAllEntries) {
   Object index;
   index.initArray(xref);
   stmBuf->clear();
 
   // First pass: determine whether all offsets fit in 4 bytes or not
   XRefPreScanWriter prescan;
-  writeXRef(&prescan, gFalse);
+  writeXRef(&prescan, writeAllEntries);
   const int offsetSize = prescan.hasOffsetsBeyond4GB ? sizeof(Goffset) : 4;
 
   // Second pass: actually write the xref stream
   XRefStreamWriter writer(&index, stmBuf, offsetSize);
-  writeXRef(&writer, gFalse);
+  writeXRef(&writer, writeAllEntries);
 
   Object obj1, obj2;
   xrefDict->set("Type", obj1.initName("XRef"));
@@ -171,6 +171,12 @@ public:
   // decryption is enabled, and therefore the Unencrypted flag is ignored.
   void scanSpecialFlags();
 
+  // Set the number of parsed object streams kept in memory.
+  void setObjStrCacheSize(int n);
+  // Get the number of object stream lookups that did / did not find the
+  // stream already parsed.
+  void getObjStrCacheStats(int *hits, int *misses);
+
   // Direct access.
   XRefEntry *getEntry(int i, GBool complainIfMissing = gTrue);
   Object *getTrailerDict() { return &trailerDict; }
@@ -184,7 +190,7 @@ public:
   // Output XRef table to stream
   void writeTableToFile(OutStream* outStr, GBool writeAllEntries);
   // Output XRef stream contents to GooString and fill trailerDict fields accordingly
-  void writeStreamToBuffer(GooString *stmBuf, Dict *xrefDict, XRef *xref);
+  void writeStreamToBuffer(GooString *stmBuf, Dict *xrefDict, XRef *xref, GBool writeAllEntries = gFalse);
 
   // to be thread safe during write where changes are not allowed
   void lock();
@@ -73,6 +73,24 @@ static inline Guchar clip255(int x) {
   return x < 0 ? 0 : x > 255 ? 255 : x;
 }
 
+// Composite a source pixel with alpha aSrc and gray value cSrc over a
+// Mono8 destination pixel which has its own alpha (the pipeRunAAMono8
+// case, shared with the loops that bypass the pipe).
+static inline void blendAAMono8(Guchar *destColor, Guchar *destAlpha,
+				Guchar aSrc, Guchar cSrc,
+				Guchar *grayTransfer) {
+  Guchar aResult;
+
+  aResult = aSrc + *destAlpha - div255(aSrc * *destAlpha);
+  if (aResult == 0) {
+    *destColor = 0;
+  } else {
+    *destColor = grayTransfer[(Guchar)(((aResult - aSrc) * *destColor +
+					aSrc * cSrc) / aResult)];
+  }
+  *destAlpha = aResult;
+}
+
 template<typename T>
 inline void Guswap( T&a, T&b ) { T tmp = a; a=b; b=tmp; }
 
@@ -1035,32 +1053,14 @@ void Splash::pipeRunAAMono1(SplashPipe *pipe) {
 // !pipe->nonIsolatedGroup &&
 // bitmap->mode == splashModeMono8 && pipe->destAlphaPtr
 void Splash::pipeRunAAMono8(SplashPipe *pipe) {
-  Guchar aSrc, aDest, alpha2, aResult;
-  SplashColor cDest;
-  Guchar cResult0;
-
-  //----- read destination pixel
-  cDest[0] = *pipe->destColorPtr;
-  aDest = *pipe->destAlphaPtr;
+  Guchar aSrc;
 
   //----- source alpha
   aSrc = div255(pipe->aInput * pipe->shape);
 
-  //----- result alpha and non-isolated group element correction
-  aResult = aSrc + aDest - div255(aSrc * aDest);
-  alpha2 = aResult;
-
-  //----- result color
-  if (alpha2 == 0) {
-    cResult0 = 0;
-  } else {
-    cResult0 = state->grayTransfer[(Guchar)(((alpha2 - aSrc) * cDest[0] +
-					     aSrc * pipe->cSrc[0]) / alpha2)];
-  }
-
-  //----- write destination pixel
-  *pipe->destColorPtr++ = cResult0;
-  *pipe->destAlphaPtr++ = aResult;
+  //----- result alpha and color, write destination pixel
+  blendAAMono8(pipe->destColorPtr++, pipe->destAlphaPtr++,
+	       aSrc, pipe->cSrc[0], state->grayTransfer);
 
   ++pipe->x;
 }
@@ -1479,14 +1479,68 @@ inline void Splash::drawAAPixel(SplashPipe *pipe, int x, int y) {
   }
 }
 
+// Set (or clear) the next n pixels of a Mono1 pipe, a byte at a time
+// where possible.
+void Splash::fillMono1Span(SplashPipe *pipe, int n, GBool set) {
+  SplashColorPtr p;
+  int mask, nBytes;
+
+  p = pipe->destColorPtr;
+  mask = pipe->destColorMask;
+  pipe->x += n;
+  while (n > 0 && mask != 0x80) {
+    if (set) {
+      *p |= mask;
+    } else {
+      *p &= ~mask;
+    }
+    --n;
+    if (!(mask >>= 1)) {
+      mask = 0x80;
+      ++p;
+    }
+  }
+  nBytes = n >> 3;
+  memset(p, set ? 0xff : 0x00, nBytes);
+  p += nBytes;
+  n &= 7;
+  while (n > 0) {
+    if (set) {
+      *p |= mask;
+    } else {
+      *p &= ~mask;
+    }
+    --n;
+    mask >>= 1;
+  }
+  pipe->destColorPtr = p;
+  pipe->destColorMask = mask;
+}
+
 inline void Splash::drawSpan(SplashPipe *pipe, int x0, int x1, int y,
 			     GBool noClip) {
-  int x;
+  Guchar cResult0;
+  int x, n;
 
   if (noClip) {
     pipeSetXY(pipe, x0, y);
-    for (x = x0; x <= x1; ++x) {
-      (this->*pipe->run)(pipe);
+    n = x1 - x0 + 1;
+    if (n > 0 && pipe->run == &Splash::pipeRunSimpleMono8) {
+      // opaque solid fill of a gray bitmap
+      memset(pipe->destColorPtr, state->grayTransfer[pipe->cSrc[0]], n);
+      memset(pipe->destAlphaPtr, 255, n);
+      pipe->destColorPtr += n;
+      pipe->destAlphaPtr += n;
+      pipe->x += n;
+    } else if (n > 0 && pipe->run == &Splash::pipeRunSimpleMono1 &&
+	       state->screen->isStatic(cResult0 =
+				       state->grayTransfer[pipe->cSrc[0]])) {
+      // solid black or white: the screen gives the same bit everywhere
+      fillMono1Span(pipe, n, state->screen->test(x0, y, cResult0));
+    } else {
+      for (x = x0; x <= x1; ++x) {
+	(this->*pipe->run)(pipe);
+      }
     }
     updateModX(x0);
     updateModX(x1);
@@ -1521,7 +1575,13 @@ inline void Splash::drawAALine(SplashPipe *pipe, int x0, int x1, int y, GBool ad
   SplashColorPtr p;
   int xx, yy, t;
 #endif
-  int x;
+  Guchar shapes[splashAASize * splashAASize + 1];
+  Guchar aSrcs[splashAASize * splashAASize + 1];
+  SplashColorPtr destColorPtr;
+  Guchar *destAlphaPtr;
+  Guchar cSrc0;
+  GBool aaMono8;
+  int x, xMin, xMax;
 
 #if splashAASize == 4
   p0 = aaBuf->getDataPtr() + (x0 >> 1);
@@ -1530,6 +1590,24 @@ inline void Splash::drawAALine(SplashPipe *pipe, int x0, int x1, int y, GBool ad
   p3 = p2 + aaBuf->getRowSize();
 #endif
   pipeSetXY(pipe, x0, y);
+
+  // Gray page rendering goes through pipeRunAAMono8 for nearly every
+  // anti-aliased fill: the source color and alpha are constant along the
+  // line, so the source alpha for each coverage value is computed once
+  // and the pixels are composited here instead of one call per pixel.
+  aaMono8 = pipe->run == &Splash::pipeRunAAMono8;
+  destColorPtr = pipe->destColorPtr;
+  destAlphaPtr = pipe->destAlphaPtr;
+  cSrc0 = pipe->cSrc[0];
+  xMin = x1 + 1;
+  xMax = x0 - 1;
+  if (aaMono8) {
+    for (t = 0; t <= splashAASize * splashAASize; ++t) {
+      shapes[t] = (adjustLine) ? div255((int) lineOpacity * (double)aaGamma[t]) : (double)aaGamma[t];
+      aSrcs[t] = div255(pipe->aInput * shapes[t]);
+    }
+  }
+
   for (x = x0; x <= x1; ++x) {
 
     // compute the shape value
@@ -1553,7 +1631,19 @@ inline void Splash::drawAALine(SplashPipe *pipe, int x0, int x1, int y, GBool ad
     }
 #endif
 
-    if (t != 0) {
+    if (aaMono8) {
+      if (t != 0) {
+	blendAAMono8(destColorPtr, destAlphaPtr, aSrcs[t], cSrc0,
+		     state->grayTransfer);
+	if (x < xMin) {
+	  xMin = x;
+	}
+	xMax = x;
+	pipe->shape = shapes[t];
+      }
+      ++destColorPtr;
+      ++destAlphaPtr;
+    } else if (t != 0) {
       pipe->shape = (adjustLine) ? div255((int) lineOpacity * (double)aaGamma[t]) : (double)aaGamma[t];
       (this->*pipe->run)(pipe);
       updateModX(x);
@@ -1562,6 +1652,17 @@ inline void Splash::drawAALine(SplashPipe *pipe, int x0, int x1, int y, GBool ad
       pipeIncX(pipe);
     }
   }
+
+  if (aaMono8) {
+    pipe->x = x;
+    pipe->destColorPtr = destColorPtr;
+    pipe->destAlphaPtr = destAlphaPtr;
+    if (xMin <= xMax) {
+      updateModX(xMin);
+      updateModX(xMax);
+      updateModY(y);
+    }
+  }
 }
 
 //------------------------------------------------------------------------
@@ -2819,15 +2920,36 @@ void Splash::fillGlyph2(int x0, int y0, SplashGlyphBitmap *glyph, GBool noClip)
                state->fillPattern, NULL, (Guchar)splashRound(state->fillAlpha * 255), gTrue, gFalse);
       for (yy = 0, y1 = yStart; yy < yyLimit; ++yy, ++y1) {
         pipeSetXY(&pipe, xStart, y1);
-        for (xx = 0, x1 = xStart; xx < xxLimit; ++xx, ++x1) {
-          alpha = p[xx];
-          if (alpha != 0) {
-            pipe.shape = alpha;
-            (this->*pipe.run)(&pipe);
-            updateModX(x1);
-            updateModY(y1);
-          } else {
-            pipeIncX(&pipe);
+        if (pipe.run == &Splash::pipeRunAAMono8) {
+          // anti-aliased text on a gray page, composited without the pipe
+          xx1 = -1;
+          for (xx = 0; xx < xxLimit; ++xx) {
+            alpha = p[xx];
+            if (alpha != 0) {
+              blendAAMono8(pipe.destColorPtr + xx, pipe.destAlphaPtr + xx,
+                           div255(pipe.aInput * alpha), pipe.cSrc[0],
+                           state->grayTransfer);
+              if (xx1 < 0) {
+                updateModX(xStart + xx);
+                updateModY(y1);
+              }
+              xx1 = xx;
+            }
+          }
+          if (xx1 >= 0) {
+            updateModX(xStart + xx1);
+          }
+        } else {
+          for (xx = 0, x1 = xStart; xx < xxLimit; ++xx, ++x1) {
+            alpha = p[xx];
+            if (alpha != 0) {
+              pipe.shape = alpha;
+              (this->*pipe.run)(&pipe);
+              updateModX(x1);
+              updateModY(y1);
+            } else {
+              pipeIncX(&pipe);
+            }
           }
         }
         p += glyph->w;
@@ -4235,19 +4357,27 @@ void Splash::scaleImageYdXd(SplashImageSource src, void *srcData,
       yStep = yp;
     }
 
-    // read rows from image
-    memset(pixBuf, 0, srcWidth * nComps * sizeof(int));
-    if (srcAlpha) {
-      memset(alphaPixBuf, 0, srcWidth * sizeof(int));
-    }
+    // read rows from image (the first one initializes the sums)
     for (i = 0; i < yStep; ++i) {
       (*src)(srcData, lineBuf, alphaLineBuf);
-      for (j = 0; j < srcWidth * nComps; ++j) {
-	pixBuf[j] += lineBuf[j];
+      if (i == 0) {
+	for (j = 0; j < srcWidth * nComps; ++j) {
+	  pixBuf[j] = lineBuf[j];
+	}
+      } else {
+	for (j = 0; j < srcWidth * nComps; ++j) {
+	  pixBuf[j] += lineBuf[j];
+	}
       }
       if (srcAlpha) {
-	for (j = 0; j < srcWidth; ++j) {
-	  alphaPixBuf[j] += alphaLineBuf[j];
+	if (i == 0) {
+	  for (j = 0; j < srcWidth; ++j) {
+	    alphaPixBuf[j] = alphaLineBuf[j];
+	  }
+	} else {
+	  for (j = 0; j < srcWidth; ++j) {
+	    alphaPixBuf[j] += alphaLineBuf[j];
+	  }
 	}
       }
     }
@@ -4257,6 +4387,28 @@ void Splash::scaleImageYdXd(SplashImageSource src, void *srcData,
     d0 = (1 << 23) / (yStep * xp);
     d1 = (1 << 23) / (yStep * (xp + 1));
 
+    // gray images (scanned pages) without alpha: a plain box filter
+    // over the row sums, with no per-pixel mode dispatch
+    if (srcMode == splashModeMono8 && !srcAlpha) {
+      xx = 0;
+      for (x = 0; x < scaledWidth; ++x) {
+	if ((xt += xq) >= scaledWidth) {
+	  xt -= scaledWidth;
+	  xStep = xp + 1;
+	  d = d1;
+	} else {
+	  xStep = xp;
+	  d = d0;
+	}
+	pix0 = 0;
+	for (i = 0; i < xStep; ++i) {
+	  pix0 += pixBuf[xx++];
+	}
+	*destPtr++ = (Guchar)((pix0 * d) >> 23);
+      }
+      continue;
+    }
+
     xx = xxa = 0;
     for (x = 0; x < scaledWidth; ++x) {
 
@@ -4779,6 +4931,26 @@ void Splash::scaleImageYuXu(SplashImageSource src, void *srcData,
     // init x scale Bresenham
     xt = 0;
 
+    // gray images without alpha: expand the row once, then replicate it
+    if (srcMode == splashModeMono8 && !srcAlpha) {
+      xx = 0;
+      for (x = 0; x < srcWidth; ++x) {
+	if ((xt += xq) >= srcWidth) {
+	  xt -= srcWidth;
+	  xStep = xp + 1;
+	} else {
+	  xStep = xp;
+	}
+	memset(destPtr0 + xx, lineBuf[x], xStep);
+	xx += xStep;
+      }
+      for (i = 1; i < yStep; ++i) {
+	memcpy(destPtr0 + i * scaledWidth, destPtr0, scaledWidth);
+      }
+      destPtr0 += yStep * scaledWidth;
+      continue;
+    }
+
     xx = 0;
     for (x = 0; x < srcWidth; ++x) {
 
@@ -5075,6 +5247,7 @@ void Splash::blitImage(SplashBitmap *src, GBool srcAlpha, int xDest, int yDest,
   SplashPipe pipe;
   SplashColor pixel;
   Guchar *ap;
+  SplashColorPtr sp;
   int w, h, x0, y0, x1, y1, x, y;
 
   // split the image into clipped and unclipped regions
@@ -5125,6 +5298,18 @@ void Splash::blitImage(SplashBitmap *src, GBool srcAlpha, int xDest, int yDest,
 	  (this->*pipe.run)(&pipe);
 	}
       }
+    } else if (pipe.run == &Splash::pipeRunSimpleMono8 &&
+	       src->getMode() == splashModeMono8) {
+      // opaque gray image on a gray page: copy whole rows through the
+      // transfer function
+      for (y = y0; y < y1; ++y) {
+	pipeSetXY(&pipe, xDest + x0, yDest + y);
+	sp = src->getDataPtr() + y * src->getRowSize() + x0;
+	for (x = 0; x < x1 - x0; ++x) {
+	  pipe.destColorPtr[x] = state->grayTransfer[sp[x]];
+	}
+	memset(pipe.destAlphaPtr, 255, x1 - x0);
+      }
     } else {
       for (y = y0; y < y1; ++y) {
 	pipeSetXY(&pipe, xDest + x0, yDest + y);
@@ -5330,7 +5515,7 @@ void Splash::compositeBackground(SplashColorPtr color) {
   Guchar color3;
   Guchar colorsp[SPOT_NCOMPS+4], cp;
 #endif
-  int x, y, mask;
+  int x, x0, y, mask;
 
   if (unlikely(bitmap->alpha == NULL)) {
     error(errInternal, -1, "bitmap->alpha is NULL in Splash::compositeBackground");
@@ -5362,15 +5547,28 @@ void Splash::compositeBackground(SplashColorPtr color) {
     }
     break;
   case splashModeMono8:
+    // most of a rendered page is either untouched paper (alpha = 0) or
+    // opaque marks (alpha = 255), which need no blending at all
     color0 = color[0];
     for (y = 0; y < bitmap->height; ++y) {
       p = &bitmap->data[y * bitmap->rowSize];
       q = &bitmap->alpha[y * bitmap->width];
-      for (x = 0; x < bitmap->width; ++x) {
-	alpha = *q++;
-	alpha1 = 255 - alpha;
-	p[0] = div255(alpha1 * color0 + alpha * p[0]);
-	++p;
+      x = 0;
+      while (x < bitmap->width) {
+	alpha = q[x];
+	if (alpha == 0) {
+	  x0 = x;
+	  do {
+	    ++x;
+	  } while (x < bitmap->width && q[x] == 0);
+	  memset(p + x0, color0, x - x0);
+	} else {
+	  if (alpha != 255) {
+	    alpha1 = 255 - alpha;
+	    p[x] = div255(alpha1 * color0 + alpha * p[x]);
+	  }
+	  ++x;
+	}
       }
     }
     break;
@@ -83,19 +83,14 @@ void SplashFont::initCache() {
   }
 
   // set up the glyph pixmap cache
-  cacheAssoc = 8;
-  if (glyphSize <= 64) {
-    cacheSets = 32;
-  } else if (glyphSize <= 128) {
-    cacheSets = 16;
-  } else if (glyphSize <= 256) {
-    cacheSets = 8;
-  } else if (glyphSize <= 512) {
-    cacheSets = 4;
-  } else if (glyphSize <= 1024) {
-    cacheSets = 2;
-  } else {
-    cacheSets = 1;
+  // -- as many sets as fit in splashFontGlyphCacheBytes (the cache index
+  // is the char code masked with cacheSets - 1, so it must be a power of
+  // 2)
+  cacheAssoc = splashFontGlyphCacheAssoc;
+  cacheSets = 1;
+  while (cacheSets < splashFontGlyphCacheMaxSets && glyphSize > 0 &&
+	 glyphSize <= splashFontGlyphCacheBytes / (2 * cacheSets * cacheAssoc)) {
+    cacheSets *= 2;
   }
   cache = (Guchar *)gmallocn_checkoverflow(cacheSets* cacheAssoc, glyphSize);
   if (cache != NULL) {
@@ -43,6 +43,13 @@ class SplashPath;
 #define splashFontFractionMul \
                        ((SplashCoord)1 / (SplashCoord)splashFontFraction)
 
+// Glyph bitmap cache of each font: associativity, maximum number of sets
+// and size budget.  With 128 sets a font keeps the bitmaps of up to 1024
+// glyphs (each char code at each fractional position is one glyph).
+#define splashFontGlyphCacheAssoc    8
+#define splashFontGlyphCacheMaxSets  128
+#define splashFontGlyphCacheBytes    (128 * 1024)
+
 //------------------------------------------------------------------------
 // SplashFont
 //------------------------------------------------------------------------
@@ -43,7 +43,7 @@ class SplashFontSrc;
 
 //------------------------------------------------------------------------
 
-#define splashFontCacheSize 16
+#define splashFontCacheSize 32
 
 //------------------------------------------------------------------------
 // SplashFontEngine
@@ -0,0 +1,128 @@
+//========================================================================
+//
+// pdf-decode-jbig2.cc
+//
+// Decodes every JBIG2 image of a PDF file a number of times and reports
+// the decoding speed, without rendering anything.  Meant for scanned
+// documents which were compressed with JBIG2 generic and text regions.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <stdio.h>
+#include <sys/time.h>
+#include "GlobalParams.h"
+#include "Object.h"
+#include "PDFDoc.h"
+#include "Stream.h"
+#include "XRef.h"
+#include "goo/GooString.h"
+#include "utils/parseargs.h"
+
+static int numberOfLoops = 10;
+static GBool printHelp = gFalse;
+
+static const ArgDesc argDesc[] = {
+  {"-loops",  argInt,      &numberOfLoops,   0,
+   "number of times each image is decoded (default 10)"},
+  {"-h",      argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"-help",   argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"--help",  argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"-?",      argFlag,     &printHelp,       0,
+   "print usage information"},
+  {NULL}
+};
+
+static double getTime() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Decodes the stream once and returns the number of bytes it produced.
+static long decodeStream(Stream *str) {
+  Guchar buf[4096];
+  long total = 0;
+  int n;
+
+  str->reset();
+  while ((n = str->doGetChars(sizeof(buf), buf)) > 0) {
+    total += n;
+  }
+  str->close();
+  return total;
+}
+
+int main(int argc, char *argv[])
+{
+  GBool ok = parseArgs(argDesc, &argc, argv);
+  if (!ok || argc != 2 || printHelp || numberOfLoops < 1) {
+    printUsage(argv[0], "PDF-FILE", argDesc);
+    return printHelp ? 0 : 1;
+  }
+
+  globalParams = new GlobalParams();
+  globalParams->setErrQuiet(gTrue);
+  PDFDoc *doc = new PDFDoc(new GooString(argv[1]));
+  if (!doc->isOk()) {
+    fprintf(stderr, "Error loading document\n");
+    delete doc;
+    delete globalParams;
+    return 1;
+  }
+
+  XRef *xref = doc->getXRef();
+  int numImages = 0;
+  long totalBytes = 0;
+  double totalTime = 0;
+  for (int num = 0; num < xref->getNumObjects(); ++num) {
+    XRefEntry *e = xref->getEntry(num, gFalse);
+    if (e->type == xrefEntryFree) {
+      continue;
+    }
+    Object obj;
+    xref->fetch(num, e->type == xrefEntryCompressed ? 0 : e->gen, &obj);
+    if (!obj.isStream() || obj.getStream()->getKind() != strJBIG2) {
+      obj.free();
+      continue;
+    }
+
+    Object width, height;
+    Dict *dict = obj.streamGetDict();
+    dict->lookup("Width", &width);
+    dict->lookup("Height", &height);
+
+    long bytes = 0;
+    double start = getTime();
+    for (int loop = 0; loop < numberOfLoops; ++loop) {
+      bytes = decodeStream(obj.getStream());
+    }
+    double elapsed = getTime() - start;
+
+    printf("object %6d  %5dx%-5d  %.4fs per decode  %7.1f Mpixel/s\n",
+           num, width.isInt() ? width.getInt() : 0,
+           height.isInt() ? height.getInt() : 0, elapsed / numberOfLoops,
+           elapsed > 0 ? bytes * 8.0 * numberOfLoops / elapsed / 1e6 : 0.0);
+    ++numImages;
+    totalBytes += bytes * numberOfLoops;
+    totalTime += elapsed;
+    width.free();
+    height.free();
+    obj.free();
+  }
+
+  if (numImages == 0) {
+    printf("no JBIG2 images\n");
+  } else {
+    printf("%d images, %.3fs, %.1f Mpixel/s\n", numImages, totalTime,
+           totalTime > 0 ? totalBytes * 8.0 / totalTime / 1e6 : 0.0);
+  }
+
+  delete doc;
+  delete globalParams;
+  return 0;
+}
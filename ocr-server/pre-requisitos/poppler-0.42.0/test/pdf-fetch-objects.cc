@@ -0,0 +1,132 @@
+//========================================================================
+//
+// pdf-fetch-objects.cc
+//
+// Fetches every object of a PDF file, first in object number order and
+// then in a scattered order, and reports the time taken and how well the
+// XRef's object stream cache did. Meant for files with many objects in
+// object streams, such as the output of scanners.  With -mmap the file is
+// read through a memory mapping instead of a FileStream.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <stdio.h>
+#include <sys/time.h>
+#include "GlobalParams.h"
+#include "Object.h"
+#include "PDFDoc.h"
+#include "PDFDocFactory.h"
+#include "XRef.h"
+#include "goo/GooString.h"
+#include "utils/parseargs.h"
+
+static int cacheSize = 0;
+static int numberOfLoops = 10;
+static GBool mapFile = gFalse;
+static GBool printHelp = gFalse;
+
+static const ArgDesc argDesc[] = {
+  {"-cache",  argInt,      &cacheSize,       0,
+   "number of object streams kept parsed (default: XRef's own)"},
+  {"-loops",  argInt,      &numberOfLoops,   0,
+   "number of passes over the objects (default 10)"},
+  {"-mmap",   argFlag,     &mapFile,         0,
+   "read the file through a memory mapping"},
+  {"-h",      argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"-help",   argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"--help",  argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"-?",      argFlag,     &printHelp,       0,
+   "print usage information"},
+  {NULL}
+};
+
+static double getTime() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Fetches every object once, visiting them with the given stride (which
+// is coprime with the number of objects, so all of them are visited).
+static int fetchObjects(XRef *xref, int stride) {
+  int numObjects = xref->getNumObjects();
+  int fetched = 0;
+  Object obj;
+
+  for (int i = 0, num = 0; i < numObjects; ++i, num = (num + stride) % numObjects) {
+    XRefEntry *e = xref->getEntry(num, gFalse);
+    if (e->type == xrefEntryFree) {
+      continue;
+    }
+    xref->fetch(num, e->type == xrefEntryCompressed ? 0 : e->gen, &obj);
+    obj.free();
+    ++fetched;
+  }
+  return fetched;
+}
+
+static int gcd(int a, int b) {
+  while (b) {
+    int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+static void runPass(XRef *xref, const char *name, int stride) {
+  int hits0, misses0, hits1, misses1;
+
+  xref->getObjStrCacheStats(&hits0, &misses0);
+  double start = getTime();
+  int fetched = 0;
+  for (int loop = 0; loop < numberOfLoops; ++loop) {
+    fetched += fetchObjects(xref, stride);
+  }
+  double elapsed = getTime() - start;
+  xref->getObjStrCacheStats(&hits1, &misses1);
+
+  printf("%-10s %8d objects in %.3fs, object stream cache %d hits %d misses\n",
+         name, fetched, elapsed, hits1 - hits0, misses1 - misses0);
+}
+
+int main(int argc, char *argv[])
+{
+  GBool ok = parseArgs(argDesc, &argc, argv);
+  if (!ok || argc != 2 || printHelp) {
+    printUsage(argv[0], "PDF-FILE", argDesc);
+    return printHelp ? 0 : 1;
+  }
+
+  globalParams = new GlobalParams();
+  globalParams->setErrQuiet(gTrue);
+  PDFDoc *doc = PDFDocFactory(NULL, mapFile).createPDFDoc(GooString(argv[1]));
+  if (!doc->isOk()) {
+    fprintf(stderr, "Error loading document\n");
+    delete doc;
+    delete globalParams;
+    return 1;
+  }
+
+  XRef *xref = doc->getXRef();
+  if (cacheSize > 0) {
+    xref->setObjStrCacheSize(cacheSize);
+  }
+
+  int numObjects = xref->getNumObjects();
+  int stride = numObjects / 3 + 1;
+  while (numObjects > 1 && gcd(stride, numObjects) != 1) {
+    ++stride;
+  }
+  runPass(xref, "in order", 1);
+  runPass(xref, "scattered", stride);
+
+  delete doc;
+  delete globalParams;
+  return 0;
+}
@@ -21,6 +21,7 @@ static GBool compareObjects(Object *objA, Object *objB);
 static char ownerPassword[33] = "\001";
 static char userPassword[33] = "\001";
 static GBool forceIncremental = gFalse;
+static GBool forceCompact = gFalse;
 static GBool checkOutput = gFalse;
 static GBool printHelp = gFalse;
 
@@ -31,6 +32,8 @@ static const ArgDesc argDesc[] = {
    "user password (for encrypted files)"},
   {"-i",      argFlag,     &forceIncremental,0,
    "incremental update mode"},
+  {"-compact",argFlag,     &forceCompact,    0,
+   "rewrite with object streams and a cross-reference stream"},
   {"-check",  argFlag,     &checkOutput,     0,
    "verify the generated document"},
   {"-h",      argFlag,     &printHelp,       0,
@@ -83,8 +86,9 @@ int main (int argc, char *argv[])
     goto done;
   }
 
-  // save it back (in rewrite or incremental update mode)
-  if (doc->saveAs(outputName, forceIncremental ? writeForceIncremental : writeForceRewrite) != 0) {
+  // save it back (in rewrite, compact rewrite or incremental update mode)
+  if (doc->saveAs(outputName, forceIncremental ? writeForceIncremental :
+                              forceCompact ? writeForceCompact : writeForceRewrite) != 0) {
     fprintf(stderr, "Error saving document\n");
     res = 1;
     goto done;
@@ -285,6 +289,12 @@ static GBool compareDocuments(PDFDoc *origDoc, PDFDoc *newDoc)
       fprintf(stderr, "XRef table: Unexpected number of entries (%d+1 != %d)\n", origNumObjects, newNumObjects);
       result = gFalse;
     }
+  } else if (forceCompact) {
+    // In compact mode, the new object streams and XRef stream are appended
+    if (origNumObjects > newNumObjects) {
+      fprintf(stderr, "XRef table: Missing entries (%d > %d)\n", origNumObjects, newNumObjects);
+      result = gFalse;
+    }
   } else {
     // In all other cases the number of entries must be the same
     if (origNumObjects != newNumObjects) {
@@ -333,6 +343,19 @@ static GBool compareDocuments(PDFDoc *origDoc, PDFDoc *newDoc)
       result = gFalse;
     }
 
+    // In compact mode, the original object streams and XRef streams are
+    // dropped
+    if (forceCompact && origType != xrefEntryFree && newType == xrefEntryFree) {
+      Object origObj;
+      origXRef->fetch(i, origGenNum, &origObj);
+      GBool dropped = origObj.isStream() && (origObj.streamGetDict()->is("ObjStm") ||
+                                             origObj.streamGetDict()->is("XRef"));
+      origObj.free();
+      if (dropped) {
+        continue;
+      }
+    }
+
     // Check that either both are free or both are in use
     if ((origType == xrefEntryFree) != (newType == xrefEntryFree)) {
       const char *origStatus = (origType == xrefEntryFree) ? "free" : "in use";
@@ -0,0 +1,145 @@
+//========================================================================
+//
+// pdf-parse-content.cc
+//
+// Parses the content streams of the pages of a PDF file a number of
+// times and reports the parsing speed.  By default the content is only
+// tokenized, as Gfx reads it; with -gfx the operators are also executed,
+// with an output device which draws nothing.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <stdio.h>
+#include <sys/time.h>
+#include "GlobalParams.h"
+#include "Object.h"
+#include "OutputDev.h"
+#include "Page.h"
+#include "PDFDoc.h"
+#include "Parser.h"
+#include "goo/GooString.h"
+#include "utils/parseargs.h"
+
+static int firstPage = 1;
+static int lastPage = 0;
+static int numberOfLoops = 10;
+static GBool runGfx = gFalse;
+static GBool printHelp = gFalse;
+
+static const ArgDesc argDesc[] = {
+  {"-f",      argInt,      &firstPage,       0,
+   "first page to parse"},
+  {"-l",      argInt,      &lastPage,        0,
+   "last page to parse"},
+  {"-loops",  argInt,      &numberOfLoops,   0,
+   "number of times each page is parsed (default 10)"},
+  {"-gfx",    argFlag,     &runGfx,          0,
+   "execute the operators, without drawing anything"},
+  {"-h",      argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"-help",   argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"--help",  argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"-?",      argFlag,     &printHelp,       0,
+   "print usage information"},
+  {NULL}
+};
+
+// An output device which draws nothing: the time is spent in Gfx.
+class NullOutputDev: public OutputDev {
+public:
+  virtual GBool upsideDown() { return gTrue; }
+  virtual GBool useDrawChar() { return gFalse; }
+  virtual GBool interpretType3Chars() { return gFalse; }
+};
+
+static double getTime() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Tokenizes the content of the page and returns the number of objects
+// (operands and operators) it has.
+static long parseContent(XRef *xref, Page *page, long *numOps) {
+  Object contents, obj;
+  long numObjects = 0;
+
+  page->getContents(&contents);
+  if (!contents.isStream() && !contents.isArray()) {
+    contents.free();
+    return 0;
+  }
+  Parser *parser = new Parser(xref, new Lexer(xref, &contents), gFalse);
+  for (parser->getObj(&obj); !obj.isEOF(); parser->getObj(&obj)) {
+    if (obj.isCmd()) {
+      ++*numOps;
+    }
+    ++numObjects;
+    obj.free();
+  }
+  delete parser;
+  contents.free();
+  return numObjects;
+}
+
+int main(int argc, char *argv[])
+{
+  GBool ok = parseArgs(argDesc, &argc, argv);
+  if (!ok || argc != 2 || printHelp || numberOfLoops < 1) {
+    printUsage(argv[0], "PDF-FILE", argDesc);
+    return printHelp ? 0 : 1;
+  }
+
+  globalParams = new GlobalParams();
+  globalParams->setErrQuiet(gTrue);
+  PDFDoc *doc = new PDFDoc(new GooString(argv[1]));
+  if (!doc->isOk()) {
+    fprintf(stderr, "Error loading document\n");
+    delete doc;
+    delete globalParams;
+    return 1;
+  }
+
+  if (firstPage < 1) {
+    firstPage = 1;
+  }
+  if (lastPage < 1 || lastPage > doc->getNumPages()) {
+    lastPage = doc->getNumPages();
+  }
+
+  NullOutputDev *out = new NullOutputDev();
+  long numObjects = 0, numOps = 0;
+  double start = getTime();
+  for (int loop = 0; loop < numberOfLoops; ++loop) {
+    for (int pg = firstPage; pg <= lastPage; ++pg) {
+      if (runGfx) {
+        doc->displayPage(out, pg, 72, 72, 0, gFalse, gFalse, gFalse);
+      } else {
+        Page *page = doc->getPage(pg);
+        if (page) {
+          numObjects += parseContent(doc->getXRef(), page, &numOps);
+        }
+      }
+    }
+  }
+  double elapsed = getTime() - start;
+
+  int numPages = lastPage - firstPage + 1;
+  if (runGfx) {
+    printf("%d pages, %.3fs, %.2f ms per page\n", numPages, elapsed,
+           numPages > 0 ? elapsed * 1000 / numPages / numberOfLoops : 0.0);
+  } else {
+    printf("%d pages, %ld objects, %ld operators, %.3fs, %.1f Mobjects/s\n",
+           numPages, numObjects / numberOfLoops, numOps / numberOfLoops,
+           elapsed, elapsed > 0 ? numObjects / elapsed / 1e6 : 0.0);
+  }
+
+  delete out;
+  delete doc;
+  delete globalParams;
+  return 0;
+}
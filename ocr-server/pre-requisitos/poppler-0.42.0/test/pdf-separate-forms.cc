@@ -0,0 +1,201 @@
+//========================================================================
+//
+// pdf-separate-forms.cc
+//
+// Checks that pdfseparate writes a correct file for each page of a
+// document with an interactive form: a two page file with text field A
+// on page 1 and field B on page 2 is split, and each output must open
+// without errors and have exactly the field of its page in its
+// /AcroForm /Fields array.  With thread support the split is also run
+// with -j 2.  The pages are also saved in-process, twice each from one
+// PDFDoc, which must still have both fields afterwards.
+//
+// Usage: pdf-separate-forms [PDFSEPARATE-BINARY]
+// (the binary can also be given in the PDFSEPARATE environment variable)
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GlobalParams.h"
+#include "Error.h"
+#include "ErrorCodes.h"
+#include "Object.h"
+#include "PDFDoc.h"
+#include "goo/GooString.h"
+
+static const char *srcFileName = "pdf-separate-forms.pdf";
+static const char *destPattern = "pdf-separate-forms-%d.pdf";
+
+static int numErrors = 0;
+
+static void countError(void *data, ErrorCategory category, Goffset pos,
+                       char *msg) {
+  fprintf(stderr, "  error: %s\n", msg);
+  ++numErrors;
+}
+
+// Writes the two page form document, with a correct xref table.
+static bool writeFormFile(const char *fileName) {
+  static const char *objs[] = {
+    "<< /Type /Catalog /Pages 2 0 R /AcroForm << /Fields [5 0 R 6 0 R] >> >>",
+    "<< /Type /Pages /Kids [3 0 R 4 0 R] /Count 2 >>",
+    "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 200 200] /Annots [5 0 R] >>",
+    "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 200 200] /Annots [6 0 R] >>",
+    "<< /Type /Annot /Subtype /Widget /FT /Tx /T (A) /V (a)"
+    " /Rect [10 10 100 30] /P 3 0 R >>",
+    "<< /Type /Annot /Subtype /Widget /FT /Tx /T (B) /V (b)"
+    " /Rect [10 10 100 30] /P 4 0 R >>"
+  };
+  const int numObjs = sizeof(objs) / sizeof(objs[0]);
+  long offsets[numObjs];
+
+  FILE *f = fopen(fileName, "wb");
+  if (!f) {
+    return false;
+  }
+  fprintf(f, "%%PDF-1.4\n");
+  for (int i = 0; i < numObjs; ++i) {
+    offsets[i] = ftell(f);
+    fprintf(f, "%d 0 obj\n%s\nendobj\n", i + 1, objs[i]);
+  }
+  long xrefOffset = ftell(f);
+  fprintf(f, "xref\n0 %d\n0000000000 65535 f \n", numObjs + 1);
+  for (int i = 0; i < numObjs; ++i) {
+    fprintf(f, "%010ld 00000 n \n", offsets[i]);
+  }
+  fprintf(f, "trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%ld\n%%%%EOF\n",
+          numObjs + 1, xrefOffset);
+  return fclose(f) == 0;
+}
+
+// Checks the output for <pageNo>: it must have one field, named <name>.
+static bool checkPage(int pageNo, const char *name) {
+  char fileName[256];
+  Object acroForm, fields, field, obj;
+  bool ok = false;
+
+  snprintf(fileName, sizeof(fileName), destPattern, pageNo);
+  numErrors = 0;
+  PDFDoc *doc = new PDFDoc(new GooString(fileName));
+  if (!doc->isOk() || doc->getNumPages() != 1) {
+    fprintf(stderr, "%s: can't be opened or doesn't have one page\n", fileName);
+    delete doc;
+    return false;
+  }
+  doc->getXRef()->getCatalog(&obj);
+  if (obj.isDict()) {
+    obj.dictLookup("AcroForm", &acroForm);
+  }
+  obj.free();
+  if (acroForm.isDict() && acroForm.dictLookup("Fields", &fields)->isArray()) {
+    ok = fields.arrayGetLength() == 1;
+    for (int i = 0; i < fields.arrayGetLength(); ++i) {
+      if (!fields.arrayGet(i, &field)->isDict() ||
+          !field.dictLookup("T", &obj)->isString() ||
+          obj.getString()->cmp(name)) {
+        ok = false;
+      }
+      obj.free();
+      field.free();
+    }
+  }
+  fields.free();
+  acroForm.free();
+  if (!ok) {
+    fprintf(stderr, "%s: /Fields should be the single field %s\n",
+            fileName, name);
+  }
+  if (numErrors > 0) {
+    fprintf(stderr, "%s: %d errors\n", fileName, numErrors);
+    ok = false;
+  }
+  delete doc;
+  return ok;
+}
+
+static bool checkPages() {
+  bool ok = checkPage(1, "A");
+  return checkPage(2, "B") && ok;
+}
+
+static void removePages() {
+  remove("pdf-separate-forms-1.pdf");
+  remove("pdf-separate-forms-2.pdf");
+}
+
+// Saves every page twice from the same document with savePageAs.
+static bool saveSeparately() {
+  char fileName[256];
+  Object catObj, acroForm, fields;
+  bool ok = true;
+
+  removePages();
+  PDFDoc *doc = new PDFDoc(new GooString(srcFileName));
+  for (int i = 0; i < 4 && doc->isOk(); ++i) {
+    int pageNo = 2 - i % 2;
+    snprintf(fileName, sizeof(fileName), destPattern, pageNo);
+    GooString *name = new GooString(fileName);
+    ok = doc->savePageAs(name, pageNo) == errNone && ok;
+    delete name;
+  }
+  if (doc->isOk()) {
+    doc->getXRef()->getCatalog(&catObj);
+    catObj.dictLookup("AcroForm", &acroForm);
+    if (!acroForm.isDict() || !acroForm.dictLookup("Fields", &fields)->isArray() ||
+        fields.arrayGetLength() != 2) {
+      fprintf(stderr, "%s: savePageAs changed /AcroForm /Fields\n", srcFileName);
+      ok = false;
+    }
+    fields.free();
+    acroForm.free();
+    catObj.free();
+  }
+  ok = doc->isOk() && ok;
+  delete doc;
+  ok = checkPages() && ok;
+  printf("savePageAs: %s\n", ok ? "ok" : "FAILED");
+  return ok;
+}
+
+static bool runSeparate(const char *binary, const char *options) {
+  char cmd[1024];
+
+  removePages();
+  snprintf(cmd, sizeof(cmd), "\"%s\" %s %s %s", binary, options,
+           srcFileName, destPattern);
+  if (system(cmd) != 0) {
+    fprintf(stderr, "failed: %s\n", cmd);
+    return false;
+  }
+  bool ok = checkPages();
+  printf("%s: %s\n", cmd, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *binary = argc > 1 ? argv[1] : getenv("PDFSEPARATE");
+  if (!binary) {
+    binary = "pdfseparate";
+  }
+
+  globalParams = new GlobalParams();
+  setErrorCallback(&countError, NULL);
+  bool ok = writeFormFile(srcFileName);
+  if (!ok) {
+    fprintf(stderr, "can't write %s\n", srcFileName);
+  } else {
+    ok = saveSeparately();
+    ok = runSeparate(binary, "") && ok;
+#ifdef HAVE_PTHREAD
+    ok = runSeparate(binary, "-j 2") && ok;
+#endif
+  }
+  delete globalParams;
+  return ok ? 0 : 1;
+}
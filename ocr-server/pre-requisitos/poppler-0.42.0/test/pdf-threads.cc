@@ -0,0 +1,132 @@
+//========================================================================
+//
+// pdf-threads.cc
+//
+// Renders every page of a single PDFDoc from several threads at once and
+// reports the wall time, to measure contention on the locks shared by
+// the document (XRef, Catalog, Page, GlobalParams).
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include "config.h"
+#include <poppler-config.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include "GlobalParams.h"
+#include "PDFDoc.h"
+#include "SplashOutputDev.h"
+#include "goo/GooString.h"
+#include "utils/parseargs.h"
+
+static int numberOfThreads = 16;
+static int numberOfLoops = 1;
+static double resolution = 36.0;
+static GBool printHelp = gFalse;
+
+static const ArgDesc argDesc[] = {
+  {"-j",      argInt,      &numberOfThreads, 0,
+   "number of threads rendering the document (default 16)"},
+  {"-loops",  argInt,      &numberOfLoops,   0,
+   "number of times each thread renders its pages (default 1)"},
+  {"-r",      argFP,       &resolution,      0,
+   "resolution, in DPI (default 36)"},
+  {"-h",      argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"-help",   argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"--help",  argFlag,     &printHelp,       0,
+   "print usage information"},
+  {"-?",      argFlag,     &printHelp,       0,
+   "print usage information"},
+  {NULL}
+};
+
+struct RenderJob {
+  PDFDoc *doc;
+  int firstPage;   // this thread renders firstPage, firstPage + step, ...
+  int step;
+  int pagesRendered;
+};
+
+static double getTime() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void *renderPages(void *arg) {
+  RenderJob *job = (RenderJob *)arg;
+  SplashColor paperColor;
+  paperColor[0] = paperColor[1] = paperColor[2] = 255;
+  SplashOutputDev *splashOut = new SplashOutputDev(splashModeRGB8, 4, gFalse,
+                                                   paperColor);
+  splashOut->startDoc(job->doc);
+
+  job->pagesRendered = 0;
+  for (int loop = 0; loop < numberOfLoops; ++loop) {
+    for (int pg = job->firstPage; pg <= job->doc->getNumPages();
+         pg += job->step) {
+      job->doc->displayPage(splashOut, pg, resolution, resolution, 0,
+                            gTrue, gFalse, gFalse);
+      ++job->pagesRendered;
+    }
+  }
+  delete splashOut;
+  return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+  GBool ok = parseArgs(argDesc, &argc, argv);
+  if (!ok || argc != 2 || printHelp || numberOfThreads < 1) {
+    printUsage(argv[0], "PDF-FILE", argDesc);
+    return printHelp ? 0 : 1;
+  }
+
+  globalParams = new GlobalParams();
+  globalParams->setErrQuiet(gTrue);
+  PDFDoc *doc = new PDFDoc(new GooString(argv[1]));
+  if (!doc->isOk()) {
+    fprintf(stderr, "Error loading document\n");
+    delete doc;
+    delete globalParams;
+    return 1;
+  }
+
+  RenderJob *jobs = new RenderJob[numberOfThreads];
+  pthread_t *threads = new pthread_t[numberOfThreads];
+  bool *started = new bool[numberOfThreads];
+  double start = getTime();
+  for (int i = 0; i < numberOfThreads; ++i) {
+    jobs[i].doc = doc;
+    jobs[i].firstPage = i % doc->getNumPages() + 1;
+    jobs[i].step = numberOfThreads;
+    started[i] = pthread_create(&threads[i], NULL, renderPages, &jobs[i]) == 0;
+    if (!started[i]) {
+      // no thread for this job: render its pages here
+      fprintf(stderr, "Can't start thread %d, rendering its pages serially\n", i);
+      renderPages(&jobs[i]);
+    }
+  }
+  int pagesRendered = 0;
+  for (int i = 0; i < numberOfThreads; ++i) {
+    if (started[i])
+      pthread_join(threads[i], NULL);
+    pagesRendered += jobs[i].pagesRendered;
+  }
+  double elapsed = getTime() - start;
+
+  printf("%d threads rendered %d pages in %.3fs (%.1f pages/s)\n",
+         numberOfThreads, pagesRendered, elapsed,
+         elapsed > 0 ? pagesRendered / elapsed : 0.0);
+
+  delete[] started;
+  delete[] threads;
+  delete[] jobs;
+  delete doc;
+  delete globalParams;
+  return 0;
+}
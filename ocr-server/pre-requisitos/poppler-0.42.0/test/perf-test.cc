@@ -126,6 +126,7 @@ static StrList *gArgsListRoot = NULL;
 #define LOAD_ONLY_ARG       "-loadonly"
 #define PAGE_ARG            "-page"
 #define TEXT_ARG            "-text"
+#define SHARE_OUTPUT_ARG    "-shareoutput"
 
 /* Should we record timings? True if -timings command-line argument was given. */
 static bool gfTimings = false;
@@ -176,6 +177,12 @@ static int  gPageNo = PAGE_NO_NOT_GIVEN;
    profiling load time */
 static bool gfLoadOnly = false;
 
+/* If true, all files are rendered with the same output device, as a
+   long-running renderer would do, so that fonts and glyphs are shared
+   between them. Controlled by -shareoutput command-line argument */
+static bool gfShareOutput = false;
+static SplashOutputDev *gSharedOutputDev = NULL;
+
 #define PDF_FILE_DPI 72
 
 #define MAX_FILENAME_SIZE 1024
@@ -410,7 +417,8 @@ PdfEnginePoppler::PdfEnginePoppler() :
 PdfEnginePoppler::~PdfEnginePoppler()
 {
     free(_fileName);
-    delete _outputDev;
+    if (_outputDev != gSharedOutputDev)
+        delete _outputDev;
     delete _pdfDoc;
 }
 
@@ -432,7 +440,13 @@ bool PdfEnginePoppler::load(const char *fileName)
 SplashOutputDev * PdfEnginePoppler::outputDevice() {
     if (!_outputDev) {
         GBool bitmapTopDown = gTrue;
-        _outputDev = new SplashOutputDev(gSplashColorMode, 4, gFalse, gBgColor, bitmapTopDown);
+        if (gfShareOutput && gSharedOutputDev) {
+            _outputDev = gSharedOutputDev;
+        } else {
+            _outputDev = new SplashOutputDev(gSplashColorMode, 4, gFalse, gBgColor, bitmapTopDown);
+            if (gfShareOutput)
+                gSharedOutputDev = _outputDev;
+        }
         if (_outputDev)
             _outputDev->startDoc(_pdfDoc);
     }
@@ -814,7 +828,7 @@ void LogInfo(const char *fmt, ...)
 
 static void PrintUsageAndExit(int argc, char **argv)
 {
-    printf("Usage: pdftest [-preview|-slowpreview] [-loadonly] [-timings] [-text] [-resolution NxM] [-recursive] [-page N] [-out out.txt] pdf-files-to-process\n");
+    printf("Usage: pdftest [-preview|-slowpreview] [-loadonly] [-timings] [-text] [-shareoutput] [-resolution NxM] [-recursive] [-page N] [-out out.txt] pdf-files-to-process\n");
     for (int i=0; i < argc; i++) {
         printf("i=%d, '%s'\n", i, argv[i]);
     }
@@ -1065,6 +1079,8 @@ static void ParseCommandLine(int argc, char **argv)
                 gfSlowPreview = true;
             } else if (str_ieq(arg, LOAD_ONLY_ARG)) {
                 gfLoadOnly = true;
+            } else if (str_ieq(arg, SHARE_OUTPUT_ARG)) {
+                gfShareOutput = true;
             } else if (str_ieq(arg, PAGE_ARG)) {
                 /* expect an integer after that */
                 ++i;
@@ -1273,6 +1289,7 @@ int main(int argc, char **argv)
         fclose(outFile);
     PreviewBitmapDestroy();
     StrList_Destroy(&gArgsListRoot);
+    delete gSharedOutputDev;
     delete globalParams;
     free(gOutFileName);
     return 0;
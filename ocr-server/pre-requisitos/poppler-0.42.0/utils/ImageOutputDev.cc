@@ -422,8 +422,10 @@ void ImageOutputDev::writeImageFile(ImgWriter *writer, ImageFormat format, const
 
     case imgMonochrome:
       int size = (width + 7)/8;
+      // the rows are already packed 1 bpp, so read them whole
+      int n = str->doGetChars(size, row);
       for (int x = 0; x < size; x++)
-        row[x] = str->getChar() ^ invert_bits;
+        row[x] = (x < n ? row[x] : 0xff) ^ invert_bits;
       writer->writeRow(&row);
       break;
     }
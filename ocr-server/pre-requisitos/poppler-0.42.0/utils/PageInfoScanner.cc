@@ -0,0 +1,618 @@
+//========================================================================
+//
+// PageInfoScanner.cc
+//
+// This file is licensed under the GPLv2 or later
+//
+// To see a description of the changes please see the Changelog file that
+// came with your tarball or type make ChangeLog if you are building from git
+//
+//========================================================================
+
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "goo/gmem.h"
+#include "goo/GooList.h"
+#include "goo/GooString.h"
+#include "Error.h"
+#include "Object.h"
+#include "Dict.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Page.h"
+#include "PDFDoc.h"
+#include "FontInfo.h"
+#include "PageInfoScanner.h"
+
+// max nesting of form XObjects
+#define maxFormDepth 20
+
+// max depth of the q/Q stack within one content stream
+#define maxSaveDepth 64
+
+// Look up <key> in an image dictionary, falling back to the abbreviated
+// key used by inline images.
+static Object *lookupImageKey(Dict *dict, const char *key, const char *abbrev,
+			      Object *obj) {
+  dict->lookup(key, obj);
+  if (obj->isNull() && abbrev) {
+    obj->free();
+    dict->lookup(abbrev, obj);
+  }
+  return obj;
+}
+
+// Append a number the way pdfimages -list prints resolutions.
+static void appendPPI(GooString *s, double ppi) {
+  char buf[32];
+
+  if (!isfinite(ppi)) {
+    s->append("null");
+    return;
+  }
+  snprintf(buf, sizeof(buf), ppi < 1.0 ? "%.3f" : "%.0f", ppi);
+  s->append(buf);
+}
+
+static void appendBox(GooString *s, const char *key, PDFRectangle *box) {
+  char buf[128];
+
+  snprintf(buf, sizeof(buf), "\"%s\":[%g,%g,%g,%g]",
+	   key, box->x1, box->y1, box->x2, box->y2);
+  s->append(buf);
+}
+
+// Name and number of components of the color space <cs>, in the terms
+// of pdfimages -list.
+static const char *colorSpaceName(Object *cs, Dict *resDict, int *comps,
+				  int depth) {
+  Object obj1, obj2;
+  const char *name;
+
+  *comps = 1;
+  if (cs->isName()) {
+    if (cs->isName("DeviceGray") || cs->isName("G") || cs->isName("CalGray")) {
+      return "gray";
+    } else if (cs->isName("DeviceRGB") || cs->isName("RGB") ||
+	       cs->isName("CalRGB")) {
+      *comps = 3;
+      return "rgb";
+    } else if (cs->isName("DeviceCMYK") || cs->isName("CMYK")) {
+      *comps = 4;
+      return "cmyk";
+    } else if (cs->isName("Indexed") || cs->isName("I")) {
+      return "index";
+    } else if (resDict && depth < 2) {
+      // a named color space from the resources
+      name = "-";
+      if (resDict->lookup("ColorSpace", &obj1)->isDict()) {
+	if (!obj1.dictLookup(cs->getName(), &obj2)->isNull()) {
+	  name = colorSpaceName(&obj2, NULL, comps, depth + 1);
+	}
+	obj2.free();
+      }
+      obj1.free();
+      return name;
+    }
+    return "-";
+  }
+  if (!cs->isArray() || cs->arrayGetLength() < 1) {
+    return "-";
+  }
+
+  name = "-";
+  cs->arrayGet(0, &obj1);
+  if (obj1.isName("CalGray") || obj1.isName("DeviceGray") || obj1.isName("G")) {
+    name = "gray";
+  } else if (obj1.isName("CalRGB") || obj1.isName("DeviceRGB") ||
+	     obj1.isName("RGB")) {
+    *comps = 3;
+    name = "rgb";
+  } else if (obj1.isName("DeviceCMYK") || obj1.isName("CMYK")) {
+    *comps = 4;
+    name = "cmyk";
+  } else if (obj1.isName("Lab")) {
+    *comps = 3;
+    name = "lab";
+  } else if (obj1.isName("ICCBased")) {
+    name = "icc";
+    if (cs->arrayGetLength() > 1 && cs->arrayGet(1, &obj2)->isStream()) {
+      Object n;
+      if (obj2.streamGetDict()->lookup("N", &n)->isInt()) {
+	*comps = n.getInt();
+      }
+      n.free();
+    }
+    if (cs->arrayGetLength() > 1) {
+      obj2.free();
+    }
+  } else if (obj1.isName("Indexed") || obj1.isName("I")) {
+    name = "index";
+  } else if (obj1.isName("Separation")) {
+    name = "sep";
+  } else if (obj1.isName("DeviceN")) {
+    name = "devn";
+    if (cs->arrayGetLength() > 1 && cs->arrayGet(1, &obj2)->isArray()) {
+      *comps = obj2.arrayGetLength();
+    }
+    if (cs->arrayGetLength() > 1) {
+      obj2.free();
+    }
+  }
+  obj1.free();
+  return name;
+}
+
+// The encoding pdfimages -list reports: the outermost filter.
+static const char *encodingName(Dict *dict) {
+  Object filter, obj1;
+  const char *enc;
+
+  lookupImageKey(dict, "Filter", "F", &filter);
+  if (filter.isArray() && filter.arrayGetLength() > 0) {
+    filter.arrayGet(filter.arrayGetLength() - 1, &obj1);
+  } else {
+    filter.copy(&obj1);
+  }
+  if (obj1.isName("CCITTFaxDecode") || obj1.isName("CCF")) {
+    enc = "ccitt";
+  } else if (obj1.isName("DCTDecode") || obj1.isName("DCT")) {
+    enc = "jpeg";
+  } else if (obj1.isName("JPXDecode")) {
+    enc = "jpx";
+  } else if (obj1.isName("JBIG2Decode")) {
+    enc = "jbig2";
+  } else {
+    enc = "image";
+  }
+  obj1.free();
+  filter.free();
+  return enc;
+}
+
+//------------------------------------------------------------------------
+// PageInfo
+//------------------------------------------------------------------------
+
+PageInfo::PageInfo() {
+  fields = new GooString();
+  images = new GooList();
+}
+
+PageInfo::~PageInfo() {
+  delete fields;
+  deleteGooList(images, GooString);
+}
+
+int PageInfo::getNumImages() {
+  return images->getLength();
+}
+
+GooString *PageInfo::toJSON(int firstImgNum) {
+  GooString *s;
+  int i;
+
+  s = new GooString("{");
+  s->append(fields);
+  s->append(",\"images\":[");
+  for (i = 0; i < images->getLength(); ++i) {
+    s->appendf("{0:s}{{\"num\":{1:d},", i > 0 ? "," : "", firstImgNum + i);
+    s->append((GooString *)images->get(i));
+    s->append("}");
+  }
+  s->append("]}");
+  return s;
+}
+
+//------------------------------------------------------------------------
+// PageInfoScanner
+//------------------------------------------------------------------------
+
+PageInfoScanner::PageInfoScanner(PDFDoc *docA) {
+  doc = docA;
+  xref = doc->getXRef();
+  textScanner = new PageTextScanner(doc);
+  images = NULL;
+}
+
+PageInfoScanner::~PageInfoScanner() {
+  delete textScanner;
+}
+
+PageInfo *PageInfoScanner::scanPage(int pg) {
+  PageInfo *info;
+  GooString *s;
+  Page *page;
+  Dict *resDict;
+  Object contents, annots;
+  double ctm[6];
+  GBool fonts, text;
+  int rotate;
+
+  info = new PageInfo();
+  s = info->fields;
+  if (pg < 1 || pg > doc->getNumPages() || !(page = doc->getPage(pg))) {
+    s->appendf("\"page\":{0:d},\"error\":\"cannot read page\"", pg);
+    return info;
+  }
+
+  // the linear part of the 72 dpi device matrix Gfx uses for this page,
+  // so that resolutions match pdfimages -list on rotated pages
+  rotate = page->getRotate();
+  ctm[0] = ctm[1] = ctm[2] = ctm[3] = ctm[4] = ctm[5] = 0;
+  if (rotate == 90) {
+    ctm[1] = 1;
+    ctm[2] = 1;
+  } else if (rotate == 180) {
+    ctm[0] = -1;
+    ctm[3] = 1;
+  } else if (rotate == 270) {
+    ctm[1] = -1;
+    ctm[2] = -1;
+  } else {
+    ctm[0] = 1;
+    ctm[3] = -1;
+  }
+
+  images = info->images;
+  resDict = page->getResourceDict();
+  page->getContents(&contents);
+  scanContent(&contents, resDict, ctm, 0);
+  contents.free();
+
+  fonts = textScanner->pageHasFonts(pg);
+  text = fonts && textScanner->pageHasText(pg);
+
+  s->appendf("\"page\":{0:d},", pg);
+  appendBox(s, "mediabox", page->getMediaBox());
+  s->append(",");
+  appendBox(s, "cropbox", page->getCropBox());
+  s->appendf(",\"rotate\":{0:d}", rotate);
+  s->appendf(",\"fonts\":{0:s},\"text\":{1:s}",
+	     fonts ? "true" : "false", text ? "true" : "false");
+  page->getAnnots(&annots);
+  s->appendf(",\"signatures\":{0:d}", countSignatures(&annots));
+  annots.free();
+  images = NULL;
+  return info;
+}
+
+// Track q/Q/cm and list the images drawn by Do and inline images.
+void PageInfoScanner::scanContent(Object *content, Dict *resDict,
+				  double *ctm0, int depth) {
+  Parser *parser;
+  Object obj, last;
+  double stack[maxSaveDepth][6];
+  double ctm[6], m[6], nums[6];
+  const char *cmd;
+  int nNums, sp, i;
+
+  if (depth > maxFormDepth) {
+    return;
+  }
+  if (content->isArray()) {
+    for (i = 0; i < content->arrayGetLength(); ++i) {
+      content->arrayGet(i, &obj);
+      if (!obj.isStream()) {
+	error(errSyntaxError, -1, "Weird page contents");
+	obj.free();
+	return;
+      }
+      obj.free();
+    }
+  } else if (!content->isStream()) {
+    return;
+  }
+
+  memcpy(ctm, ctm0, sizeof(ctm));
+  sp = 0;
+  nNums = 0;
+  last.initNull();
+  parser = new Parser(xref, new Lexer(xref, content), gFalse);
+  parser->getObj(&obj);
+  while (!obj.isEOF()) {
+    if (obj.isCmd()) {
+      cmd = obj.getCmd();
+      if (!strcmp(cmd, "q")) {
+	if (sp < maxSaveDepth) {
+	  memcpy(stack[sp], ctm, sizeof(ctm));
+	}
+	++sp;
+      } else if (!strcmp(cmd, "Q")) {
+	if (sp > 0) {
+	  --sp;
+	  if (sp < maxSaveDepth) {
+	    memcpy(ctm, stack[sp], sizeof(ctm));
+	  }
+	}
+      } else if (!strcmp(cmd, "cm")) {
+	if (nNums == 6) {
+	  memcpy(m, ctm, sizeof(m));
+	  ctm[0] = nums[0] * m[0] + nums[1] * m[2];
+	  ctm[1] = nums[0] * m[1] + nums[1] * m[3];
+	  ctm[2] = nums[2] * m[0] + nums[3] * m[2];
+	  ctm[3] = nums[2] * m[1] + nums[3] * m[3];
+	  ctm[4] = nums[4] * m[0] + nums[5] * m[2] + m[4];
+	  ctm[5] = nums[4] * m[1] + nums[5] * m[3] + m[5];
+	}
+      } else if (!strcmp(cmd, "Do")) {
+	if (last.isName() && resDict) {
+	  scanXObject(resDict, last.getName(), ctm, depth);
+	}
+      } else if (!strcmp(cmd, "BI")) {
+	scanInlineImage(parser, resDict, ctm);
+      }
+      nNums = 0;
+      obj.free();
+      last.free();
+      last.initNull();
+    } else {
+      if (obj.isNum()) {
+	if (nNums == 6) {
+	  memmove(nums, nums + 1, 5 * sizeof(double));
+	  --nNums;
+	}
+	nums[nNums++] = obj.getNum();
+      }
+      last.free();
+      last = obj;
+    }
+    parser->getObj(&obj);
+  }
+  obj.free();
+  last.free();
+  delete parser;
+}
+
+void PageInfoScanner::scanXObject(Dict *resDict, const char *name,
+				  double *ctm, int depth) {
+  Object xObjDict, ref, xObj, subtype, obj1, obj2;
+  Dict *dict;
+  Ref r;
+  double formCtm[6], m[6];
+  int i;
+
+  if (!resDict->lookup("XObject", &xObjDict)->isDict()) {
+    xObjDict.free();
+    return;
+  }
+  xObjDict.dictLookupNF(name, &ref);
+  ref.fetch(xref, &xObj);
+  if (!xObj.isStream()) {
+    xObj.free();
+    ref.free();
+    xObjDict.free();
+    return;
+  }
+  dict = xObj.streamGetDict();
+  dict->lookup("Subtype", &subtype);
+
+  if (subtype.isName("Image")) {
+    if (ref.isRef()) {
+      r = ref.getRef();
+    } else {
+      r.num = -1;
+      r.gen = 0;
+    }
+    addImage(dict, &r, resDict, ctm, gFalse, NULL);
+
+    // the masks are drawn (and listed) with the same matrix
+    if (dict->lookupNF("SMask", &obj1)->isRef() &&
+	obj1.fetch(xref, &obj2)->isStream()) {
+      r = obj1.getRef();
+      addImage(obj2.streamGetDict(), &r, resDict, ctm, gFalse, "smask");
+    }
+    if (obj1.isRef()) {
+      obj2.free();
+    }
+    obj1.free();
+    if (dict->lookupNF("Mask", &obj1)->isRef() &&
+	obj1.fetch(xref, &obj2)->isStream()) {
+      r = obj1.getRef();
+      addImage(obj2.streamGetDict(), &r, resDict, ctm, gFalse, "mask");
+    }
+    if (obj1.isRef()) {
+      obj2.free();
+    }
+    obj1.free();
+
+  } else if (subtype.isName("Form")) {
+    // form matrix, then the form's own resources (or the caller's)
+    memcpy(formCtm, ctm, sizeof(formCtm));
+    if (dict->lookup("Matrix", &obj1)->isArray() &&
+	obj1.arrayGetLength() == 6) {
+      for (i = 0; i < 6; ++i) {
+	m[i] = obj1.arrayGet(i, &obj2)->isNum() ? obj2.getNum() : 0;
+	obj2.free();
+      }
+      formCtm[0] = m[0] * ctm[0] + m[1] * ctm[2];
+      formCtm[1] = m[0] * ctm[1] + m[1] * ctm[3];
+      formCtm[2] = m[2] * ctm[0] + m[3] * ctm[2];
+      formCtm[3] = m[2] * ctm[1] + m[3] * ctm[3];
+      formCtm[4] = m[4] * ctm[0] + m[5] * ctm[2] + ctm[4];
+      formCtm[5] = m[4] * ctm[1] + m[5] * ctm[3] + ctm[5];
+    }
+    obj1.free();
+    dict->lookup("Resources", &obj1);
+    scanContent(&xObj, obj1.isDict() ? obj1.getDict() : resDict,
+		formCtm, depth + 1);
+    obj1.free();
+  }
+
+  subtype.free();
+  xObj.free();
+  ref.free();
+  xObjDict.free();
+}
+
+// Read an inline image dictionary (as Gfx::buildImageStream does), list
+// it, and skip its data up to EI without decoding it.
+void PageInfoScanner::scanInlineImage(Parser *parser, Dict *resDict,
+				      double *ctm) {
+  Object dict, obj;
+  Stream *str;
+  char *key;
+  int c0, c1, c2, c3;
+
+  dict.initDict(xref);
+  parser->getObj(&obj);
+  while (!obj.isCmd("ID") && !obj.isEOF()) {
+    if (!obj.isName()) {
+      obj.free();
+    } else {
+      key = copyString(obj.getName());
+      obj.free();
+      parser->getObj(&obj);
+      if (obj.isEOF() || obj.isError()) {
+	gfree(key);
+	break;
+      }
+      dict.dictAdd(key, &obj);
+    }
+    parser->getObj(&obj);
+  }
+  if (!obj.isCmd("ID") || !(str = parser->getStream())) {
+    obj.free();
+    dict.free();
+    return;
+  }
+  obj.free();
+
+  addImage(dict.getDict(), NULL, resDict, ctm, gTrue, NULL);
+  dict.free();
+
+  // EI must be a token of its own: image data may contain those bytes
+  c0 = ' ';
+  c1 = str->getChar();
+  c2 = str->getChar();
+  c3 = str->getChar();
+  while (c3 != EOF && !(Lexer::isSpace(c0) && c1 == 'E' && c2 == 'I' &&
+			Lexer::isSpace(c3))) {
+    c0 = c1;
+    c1 = c2;
+    c2 = c3;
+    c3 = str->getChar();
+  }
+}
+
+// Append one image to the JSON array.  <type> is NULL for an image
+// drawn directly (image or stencil), or "smask" / "mask".
+void PageInfoScanner::addImage(Dict *dict, Ref *ref, Dict *resDict,
+			       double *ctm, GBool inlineImg,
+			       const char *type) {
+  GooString *s;
+  Object obj1;
+  const char *colorspace;
+  int width, height, comps, bpc;
+  GBool interpolate, stencil;
+  double width2, height2;
+
+  lookupImageKey(dict, "Width", "W", &obj1);
+  width = obj1.isInt() ? obj1.getInt() : 0;
+  obj1.free();
+  lookupImageKey(dict, "Height", "H", &obj1);
+  height = obj1.isInt() ? obj1.getInt() : 0;
+  obj1.free();
+  lookupImageKey(dict, "ImageMask", "IM", &obj1);
+  stencil = obj1.isBool() && obj1.getBool();
+  obj1.free();
+  lookupImageKey(dict, "Interpolate", "I", &obj1);
+  interpolate = obj1.isBool() && obj1.getBool();
+  obj1.free();
+
+  // masks and stencils are one component, one bit
+  colorspace = "-";
+  comps = 1;
+  bpc = 1;
+  if (!stencil && (!type || !strcmp(type, "smask"))) {
+    lookupImageKey(dict, "ColorSpace", "CS", &obj1);
+    if (!obj1.isNull()) {
+      colorspace = colorSpaceName(&obj1, resDict, &comps, 0);
+    } else if (type) {
+      colorspace = "gray";
+    }
+    obj1.free();
+    lookupImageKey(dict, "BitsPerComponent", "BPC", &obj1);
+    bpc = obj1.isInt() ? obj1.getInt() : 0;
+    obj1.free();
+  }
+  if (!type) {
+    type = stencil ? "stencil" : "image";
+  }
+
+  s = new GooString();
+  s->appendf("\"type\":\"{0:s}\",\"width\":{1:d},\"height\":{2:d}",
+	     type, width, height);
+  s->appendf(",\"color\":\"{0:s}\",\"comp\":{1:d},\"bpc\":{2:d}",
+	     colorspace, comps, bpc);
+  s->appendf(",\"enc\":\"{0:s}\",\"interp\":{1:s}",
+	     encodingName(dict), interpolate ? "true" : "false");
+  if (inlineImg || !ref || ref->num < 0) {
+    s->append(",\"object\":null");
+  } else {
+    s->appendf(",\"object\":{0:d},\"gen\":{1:d}", ref->num, ref->gen);
+  }
+
+  // same as ImageOutputDev::listImage
+  width2 = ctm[0] + ctm[2];
+  height2 = ctm[1] + ctm[3];
+  s->append(",\"x-ppi\":");
+  appendPPI(s, fabs(width * 72.0 / width2) + 0.5);
+  s->append(",\"y-ppi\":");
+  appendPPI(s, fabs(height * 72.0 / height2) + 0.5);
+
+  s->append(",\"size\":");
+  if (!inlineImg && dict->lookup("Length", &obj1)->isInt()) {
+    s->appendf("{0:d}", obj1.getInt());
+  } else {
+    s->append("null");
+  }
+  if (!inlineImg) {
+    obj1.free();
+  }
+  images->append(s);
+}
+
+// Count the signature fields on the page which hold a signature.
+int PageInfoScanner::countSignatures(Object *annots) {
+  Object annot, field, parent, obj1;
+  int i, n, depth;
+
+  n = 0;
+  if (!annots->isArray()) {
+    return n;
+  }
+  for (i = 0; i < annots->arrayGetLength(); ++i) {
+    if (annots->arrayGet(i, &annot)->isDict() &&
+	annot.dictLookup("Subtype", &obj1)->isName("Widget")) {
+      // FT and V may be inherited from the parent fields
+      annot.copy(&field);
+      for (depth = 0; depth < 16 && field.isDict(); ++depth) {
+	Object ft;
+	if (field.dictLookup("FT", &ft)->isName()) {
+	  if (ft.isName("Sig")) {
+	    Object v;
+	    if (field.dictLookup("V", &v)->isDict()) {
+	      ++n;
+	    }
+	    v.free();
+	  }
+	  ft.free();
+	  break;
+	}
+	ft.free();
+	field.dictLookup("Parent", &parent);
+	field.free();
+	field = parent;
+      }
+      field.free();
+    }
+    if (annot.isDict()) {
+      obj1.free();
+    }
+    annot.free();
+  }
+  return n;
+}
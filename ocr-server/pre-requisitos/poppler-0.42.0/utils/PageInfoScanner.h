@@ -0,0 +1,92 @@
+//========================================================================
+//
+// PageInfoScanner.h
+//
+// This file is licensed under the GPLv2 or later
+//
+// To see a description of the changes please see the Changelog file that
+// came with your tarball or type make ChangeLog if you are building from git
+//
+//========================================================================
+
+#ifndef PAGE_INFO_SCANNER_H
+#define PAGE_INFO_SCANNER_H
+
+#include "Object.h"
+#include "goo/gtypes.h"
+
+class GooList;
+class GooString;
+class Parser;
+class PDFDoc;
+class PageTextScanner;
+
+//------------------------------------------------------------------------
+// PageInfo
+//------------------------------------------------------------------------
+
+class PageInfo {
+public:
+
+  // Destructor.
+  ~PageInfo();
+
+  int getNumImages();
+
+  // Return the JSON line (without the trailing newline), numbering the
+  // images from <firstImgNum> on, as pdfimages numbers them across the
+  // document.  The caller owns the string.
+  GooString *toJSON(int firstImgNum);
+
+private:
+
+  PageInfo();
+
+  GooString *fields;		// page fields, without the braces
+  GooList *images;		// image fields (GooString), without "num"
+
+  friend class PageInfoScanner;
+};
+
+//------------------------------------------------------------------------
+// PageInfoScanner
+//
+// Describes a page for a line of JSON (see PageInfo): its geometry,
+// whether it has fonts and text, its signed signature fields, and the
+// images it draws with the same fields as "pdfimages -list".  Image information comes
+// from the image dictionaries and inline image headers only: no image
+// data is decoded, and the content streams are only tokenized to follow
+// the current transformation matrix (for the resolution) and the form
+// XObjects.
+//
+// Each thread needs its own PageInfoScanner; they can share the PDFDoc.
+//------------------------------------------------------------------------
+
+class PageInfoScanner {
+public:
+
+  // Constructor.
+  PageInfoScanner(PDFDoc *docA);
+
+  // Destructor.
+  ~PageInfoScanner();
+
+  // Describe page <pg> (1-based).  The caller owns the PageInfo.
+  PageInfo *scanPage(int pg);
+
+private:
+
+  void scanContent(Object *content, Dict *resDict, double *ctm, int depth);
+  void scanXObject(Dict *resDict, const char *name, double *ctm, int depth);
+  void scanInlineImage(Parser *parser, Dict *resDict, double *ctm);
+  void addImage(Dict *dict, Ref *ref, Dict *resDict, double *ctm,
+		GBool inlineImg, const char *type);
+  int countSignatures(Object *annots);
+
+  PDFDoc *doc;
+  XRef *xref;
+  PageTextScanner *textScanner;
+  GooList *images;		// images of the page being scanned
+};
+
+#endif
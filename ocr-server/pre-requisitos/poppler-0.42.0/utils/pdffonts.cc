@@ -58,8 +58,11 @@ static const char *fontTypeNames[] = {
 static int firstPage = 1;
 static int lastPage = 0;
 static GBool showSubst = gFalse;
+static GBool showText = gFalse;
 static char ownerPassword[33] = "\001";
 static char userPassword[33] = "\001";
+static GBool mapFile = gFalse;
+static GBool noAnnots = gFalse;
 static GBool printVersion = gFalse;
 static GBool printHelp = gFalse;
 
@@ -70,10 +73,16 @@ static const ArgDesc argDesc[] = {
    "last page to examine"},
   {"-subst",      argFlag,     &showSubst,  0,
    "show font substitutions"},
+  {"-text",   argFlag,     &showText,   0,
+   "only print whether each page shows any text"},
   {"-opw",    argString,   ownerPassword,  sizeof(ownerPassword),
    "owner password (for encrypted files)"},
   {"-upw",    argString,   userPassword,   sizeof(userPassword),
    "user password (for encrypted files)"},
+  {"-mmap",   argFlag,     &mapFile,       0,
+   "read the PDF file through a memory mapping"},
+  {"-noannots", argFlag,     &noAnnots,      0,
+   "don't process annotations"},
   {"-v",      argFlag,     &printVersion,  0,
    "print copyright and version info"},
   {"-h",      argFlag,     &printHelp,     0,
@@ -130,7 +139,7 @@ int main(int argc, char *argv[]) {
       fileName = new GooString("fd://0");
   }
 
-  doc = PDFDocFactory().createPDFDoc(*fileName, ownerPW, userPW);
+  doc = PDFDocFactory(NULL, mapFile).createPDFDoc(*fileName, ownerPW, userPW);
   delete fileName;
 
   if (userPW) {
@@ -143,6 +152,7 @@ int main(int argc, char *argv[]) {
     exitCode = 1;
     goto err1;
   }
+  doc->setProcessAnnotations(!noAnnots);
 
   // get page range
   if (firstPage < 1) {
@@ -158,6 +168,16 @@ int main(int argc, char *argv[]) {
     goto err1;
   }
 
+  // check for text, without loading the fonts
+  if (showText) {
+    PageTextScanner scanner(doc);
+    for (int pg = firstPage; pg <= lastPage; ++pg) {
+      printf("%d %s\n", pg, scanner.pageHasText(pg) ? "yes" : "no");
+    }
+    exitCode = 0;
+    goto err1;
+  }
+
   // get the fonts
   {
     FontInfoScanner scanner(doc, firstPage - 1);
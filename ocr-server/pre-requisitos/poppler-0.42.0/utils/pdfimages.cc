@@ -32,8 +32,13 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <string.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#include <unistd.h>
+#endif
 #include "parseargs.h"
 #include "goo/GooString.h"
+#include "goo/GooMutex.h"
 #include "goo/gmem.h"
 #include "GlobalParams.h"
 #include "Object.h"
@@ -46,11 +51,14 @@
 #include "PDFDoc.h"
 #include "PDFDocFactory.h"
 #include "ImageOutputDev.h"
+#include "PageInfoScanner.h"
 #include "Error.h"
 
 static int firstPage = 1;
 static int lastPage = 0;
 static GBool listImages = gFalse;
+static GBool listJSON = gFalse;
+static int numThreads = 0;
 static GBool enablePNG = gFalse;
 static GBool enableTiff = gFalse;
 static GBool dumpJPEG = gFalse;
@@ -61,10 +69,94 @@ static GBool allFormats = gFalse;
 static GBool pageNames = gFalse;
 static char ownerPassword[33] = "\001";
 static char userPassword[33] = "\001";
+static GBool mapFile = gFalse;
+static GBool noAnnots = gFalse;
 static GBool quiet = gFalse;
 static GBool printVersion = gFalse;
 static GBool printHelp = gFalse;
 
+// Pages are handed out to the -json worker threads one at a time.
+struct PageInfoJob {
+  PDFDoc *doc;
+  PageInfo **pages;		// one for each page of the range
+  int nextPage;
+  GooMutex mutex;
+};
+
+static void *scanPageInfo(void *arg) {
+  PageInfoJob *job = (PageInfoJob *)arg;
+  PageInfoScanner scanner(job->doc);
+  int pg;
+
+  while (1) {
+    gLockMutex(&job->mutex);
+    pg = job->nextPage++;
+    gUnlockMutex(&job->mutex);
+    if (pg > lastPage) {
+      break;
+    }
+    job->pages[pg - firstPage] = scanner.scanPage(pg);
+  }
+  return NULL;
+}
+
+static void printPageInfo(PDFDoc *doc) {
+  PageInfoJob job;
+  GooString *line;
+  int nPages, imgNum, i;
+
+  nPages = lastPage - firstPage + 1;
+  job.doc = doc;
+  job.pages = (PageInfo **)gmallocn(nPages, sizeof(PageInfo *));
+  job.nextPage = firstPage;
+  gInitMutex(&job.mutex);
+
+#ifdef HAVE_PTHREAD
+  int nThreads = numThreads;
+  if (nThreads < 1) {
+    nThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (nThreads > nPages) {
+    nThreads = nPages;
+  }
+  if (nThreads > 1) {
+    pthread_t *threads = (pthread_t *)gmallocn(nThreads, sizeof(pthread_t));
+    int nStarted = 0;
+    while (nStarted < nThreads &&
+	   pthread_create(&threads[nStarted], NULL, scanPageInfo, &job) == 0) {
+      ++nStarted;
+    }
+    if (nStarted < nThreads) {
+      // the pages are handed out one at a time, so the ones the missing
+      // threads would have scanned are scanned here (all of them if no
+      // thread could be started)
+      scanPageInfo(&job);
+    }
+    for (i = 0; i < nStarted; ++i) {
+      pthread_join(threads[i], NULL);
+    }
+    gfree(threads);
+  } else {
+    scanPageInfo(&job);
+  }
+#else
+  scanPageInfo(&job);
+#endif
+  gDestroyMutex(&job.mutex);
+
+  printf("{\"pages\":%d,\"encrypted\":%s}\n", doc->getNumPages(),
+         doc->isEncrypted() ? "true" : "false");
+  imgNum = 0;
+  for (i = 0; i < nPages; ++i) {
+    line = job.pages[i]->toJSON(imgNum);
+    printf("%s\n", line->getCString());
+    imgNum += job.pages[i]->getNumImages();
+    delete line;
+    delete job.pages[i];
+  }
+  gfree(job.pages);
+}
+
 static const ArgDesc argDesc[] = {
   {"-f",      argInt,      &firstPage,     0,
    "first page to convert"},
@@ -90,10 +182,18 @@ static const ArgDesc argDesc[] = {
    "equivalent to -png -tiff -j -jp2 -jbig2 -ccitt"},
   {"-list",   argFlag,     &listImages,      0,
    "print list of images instead of saving"},
+  {"-json",   argFlag,     &listJSON,        0,
+   "print pages and images as JSON lines, without decoding images"},
+  {"-threads", argInt,     &numThreads,      0,
+   "number of threads used by -json (default: number of CPUs)"},
   {"-opw",    argString,   ownerPassword,  sizeof(ownerPassword),
    "owner password (for encrypted files)"},
   {"-upw",    argString,   userPassword,   sizeof(userPassword),
    "user password (for encrypted files)"},
+  {"-mmap",   argFlag,     &mapFile,       0,
+   "read the PDF file through a memory mapping"},
+  {"-noannots", argFlag,     &noAnnots,      0,
+   "don't process annotations"},
   {"-p",      argFlag,     &pageNames,     0,
    "include page numbers in output file names"},
   {"-q",      argFlag,     &quiet,         0,
@@ -124,6 +224,9 @@ int main(int argc, char *argv[]) {
 
   // parse args
   ok = parseArgs(argDesc, &argc, argv);
+  if (listJSON) {
+    listImages = gTrue;
+  }
   if (!ok || (listImages && argc != 2) || (!listImages && argc != 3) || printVersion || printHelp) {
     fprintf(stderr, "pdfimages version %s\n", PACKAGE_VERSION);
     fprintf(stderr, "%s\n", popplerCopyright);
@@ -161,7 +264,7 @@ int main(int argc, char *argv[]) {
       fileName = new GooString("fd://0");
   }
 
-  doc = PDFDocFactory().createPDFDoc(*fileName, ownerPW, userPW);
+  doc = PDFDocFactory(NULL, mapFile).createPDFDoc(*fileName, ownerPW, userPW);
   delete fileName;
 
   if (userPW) {
@@ -174,6 +277,7 @@ int main(int argc, char *argv[]) {
     exitCode = 1;
     goto err1;
   }
+  doc->setProcessAnnotations(!noAnnots);
 
   // check for copy permission
 #ifdef ENFORCE_PERMISSIONS
@@ -196,6 +300,12 @@ int main(int argc, char *argv[]) {
     goto err1;
   }
 
+  if (listJSON) {
+    printPageInfo(doc);
+    exitCode = 0;
+    goto err1;
+  }
+
   // write image files
   imgOut = new ImageOutputDev(imgRoot, pageNames, listImages);
   if (imgOut->isOk()) {
@@ -24,8 +24,16 @@
 #include "GlobalParams.h"
 #include <ctype.h>
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 static int firstPage = 0;
 static int lastPage = 0;
+#ifdef HAVE_PTHREAD
+static int numberOfJobs = 1;
+#endif
+static GBool compact = gFalse;
 static GBool printVersion = gFalse;
 static GBool printHelp = gFalse;
 
@@ -34,6 +42,12 @@ static const ArgDesc argDesc[] = {
    "first page to extract"},
   {"-l", argInt, &lastPage, 0,
    "last page to extract"},
+  {"-compact", argFlag, &compact, 0,
+   "write object streams and a cross-reference stream (PDF 1.5)"},
+#ifdef HAVE_PTHREAD
+  {"-j", argInt, &numberOfJobs, 0,
+   "number of jobs to run concurrently"},
+#endif
   {"-v", argFlag, &printVersion, 0,
    "print copyright and version info"},
   {"-h", argFlag, &printHelp, 0,
@@ -47,8 +61,43 @@ static const ArgDesc argDesc[] = {
   {NULL}
 };
 
-bool extractPages (const char *srcFileName, const char *destFileName) {
+// Saves each page of the given range of doc to a file named by the
+// destFileName pattern.
+static bool extractPageRange(PDFDoc *doc, const char *destFileName,
+                             int first, int last) {
   char pathName[4096];
+  for (int pageNo = first; pageNo <= last; pageNo++) {
+    snprintf (pathName, sizeof (pathName) - 1, destFileName, pageNo);
+    GooString *gpageName = new GooString (pathName);
+    int errCode = doc->savePageAs(gpageName, pageNo,
+                                  compact ? writeForceCompact : writeStandard);
+    delete gpageName;
+    if (errCode != errNone)
+      return false;
+  }
+  return true;
+}
+
+#ifdef HAVE_PTHREAD
+
+struct PageRangeJob {
+  PDFDoc *doc;
+  const char *destFileName;
+  int firstPage;
+  int lastPage;
+  bool ok;
+};
+
+static void *extractPageRangeJob(void *arg) {
+  PageRangeJob *job = (PageRangeJob *)arg;
+  job->ok = extractPageRange(job->doc, job->destFileName,
+                             job->firstPage, job->lastPage);
+  return NULL;
+}
+
+#endif // HAVE_PTHREAD
+
+bool extractPages (const char *srcFileName, const char *destFileName) {
   GooString *gfileName = new GooString (srcFileName);
   PDFDoc *doc = new PDFDoc (gfileName, NULL, NULL, NULL);
 
@@ -121,22 +170,46 @@ bool extractPages (const char *srcFileName, const char *destFileName) {
   }
   free(auxDestFileName);
   
-  for (int pageNo = firstPage; pageNo <= lastPage; pageNo++) {
-    snprintf (pathName, sizeof (pathName) - 1, destFileName, pageNo);
-    GooString *gpageName = new GooString (pathName);
-    PDFDoc *pagedoc = new PDFDoc (new GooString (srcFileName), NULL, NULL, NULL);
-    int errCode = pagedoc->savePageAs(gpageName, pageNo);
-    if ( errCode != errNone) {
-      delete gpageName;
-      delete doc;
-      delete pagedoc;
-      return false;
+#ifdef HAVE_PTHREAD
+  int numPages = lastPage - firstPage + 1;
+  if (numberOfJobs > numPages)
+    numberOfJobs = numPages;
+  if (numberOfJobs > 1) {
+    // Each job extracts a contiguous part of the range; savePageAs
+    // doesn't change the document, so they all save from doc.
+    PageRangeJob *jobs = new PageRangeJob[numberOfJobs];
+    pthread_t *threads = new pthread_t[numberOfJobs];
+    bool *started = new bool[numberOfJobs];
+    bool ok = true;
+    for (int i = 0; i < numberOfJobs; i++) {
+      jobs[i].doc = doc;
+      jobs[i].destFileName = destFileName;
+      jobs[i].firstPage = firstPage + numPages * i / numberOfJobs;
+      jobs[i].lastPage = firstPage + numPages * (i + 1) / numberOfJobs - 1;
+      jobs[i].ok = false;
+      started[i] = pthread_create(&threads[i], NULL, extractPageRangeJob,
+                                  &jobs[i]) == 0;
+      if (!started[i]) {
+        // no thread for this part: extract it here
+        extractPageRangeJob(&jobs[i]);
+      }
     }
-    delete pagedoc;
-    delete gpageName;
+    for (int i = 0; i < numberOfJobs; i++) {
+      if (started[i])
+        pthread_join(threads[i], NULL);
+      ok = ok && jobs[i].ok;
+    }
+    delete[] started;
+    delete[] threads;
+    delete[] jobs;
+    delete doc;
+    return ok;
   }
+#endif
+
+  bool ok = extractPageRange(doc, destFileName, firstPage, lastPage);
   delete doc;
-  return true;
+  return ok;
 }
 
 int
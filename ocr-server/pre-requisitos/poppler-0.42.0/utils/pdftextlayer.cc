@@ -0,0 +1,493 @@
+//========================================================================
+//
+// pdftextlayer.cc
+//
+// Adds the pages of a text-only PDF (such as the "textonly_pdf" output
+// of an OCR engine) on top of the pages of a PDF file, as an incremental
+// update: the original bytes are copied unchanged and only the new
+// objects and the modified page dictionaries are appended, so existing
+// signatures stay valid.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include "config.h"
+#include <poppler-config.h>
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include "parseargs.h"
+#include "goo/gmem.h"
+#include "goo/GooString.h"
+#include "Object.h"
+#include "Array.h"
+#include "Dict.h"
+#include "Stream.h"
+#include "XRef.h"
+#include "Catalog.h"
+#include "Page.h"
+#include "PDFDoc.h"
+#include "Error.h"
+#include "ErrorCodes.h"
+#include "GlobalParams.h"
+
+static int firstPage = 1;
+static int lastPage = 0;
+static GBool printVersion = gFalse;
+static GBool printHelp = gFalse;
+
+static const ArgDesc argDesc[] = {
+  {"-f", argInt, &firstPage, 0,
+   "first page to add text to"},
+  {"-l", argInt, &lastPage, 0,
+   "last page to add text to"},
+  {"-v", argFlag, &printVersion, 0,
+   "print copyright and version info"},
+  {"-h", argFlag, &printHelp, 0,
+   "print usage information"},
+  {"-help", argFlag, &printHelp, 0,
+   "print usage information"},
+  {"--help", argFlag, &printHelp, 0,
+   "print usage information"},
+  {"-?", argFlag, &printHelp, 0,
+   "print usage information"},
+  {NULL}
+};
+
+//------------------------------------------------------------------------
+// ObjectCopier
+//
+// Copies objects of one document into the XRef of another one as new
+// indirect objects.  Each source object is copied once, so resources
+// shared by the text-only pages (their font) are shared in the output
+// too.  Streams are copied with their filters, without decoding them.
+//------------------------------------------------------------------------
+
+class ObjectCopier {
+public:
+
+  ObjectCopier(XRef *srcXRefA, XRef *dstXRefA)
+    { srcXRef = srcXRefA; dstXRef = dstXRefA; }
+
+  // Copy <src>, which has not been fetched, into <dst>.
+  Object *copy(Object *src, Object *dst);
+
+  // Copy the entries of <src> into a new dictionary.
+  Object *copyDict(Dict *src, Object *dst);
+
+  // Copy the stream, keeping its encoded data.
+  Object *copyStream(Stream *str, Object *dst);
+
+private:
+
+  Object *copyRef(Ref ref, Object *dst);
+
+  XRef *srcXRef;
+  XRef *dstXRef;
+  std::map<int, Ref> refMap;	// source object number -> new ref
+};
+
+Object *ObjectCopier::copy(Object *src, Object *dst) {
+  Object obj;
+
+  switch (src->getType()) {
+  case objRef:
+    return copyRef(src->getRef(), dst);
+  case objDict:
+    return copyDict(src->getDict(), dst);
+  case objArray:
+    dst->initArray(dstXRef);
+    for (int i = 0; i < src->arrayGetLength(); ++i) {
+      Object elem;
+      src->arrayGetNF(i, &elem);
+      dst->arrayAdd(copy(&elem, &obj));
+      elem.free();
+    }
+    return dst;
+  case objStream:
+    return copyStream(src->getStream(), dst);
+  case objString:
+    return dst->initString(src->getString()->copy());
+  case objName:
+    return dst->initName(src->getName());
+  default:
+    return src->copy(dst);
+  }
+}
+
+Object *ObjectCopier::copyDict(Dict *src, Object *dst) {
+  Object val, obj;
+
+  dst->initDict(dstXRef);
+  for (int i = 0; i < src->getLength(); ++i) {
+    src->getValNF(i, &val);
+    dst->dictAdd(copyString(src->getKey(i)), copy(&val, &obj));
+    val.free();
+  }
+  return dst;
+}
+
+Object *ObjectCopier::copyStream(Stream *str, Object *dst) {
+  Object dict, obj;
+  GooString buf;
+  char block[4096];
+  int n;
+
+  // read the data as it is stored in the file (the base stream of a
+  // stream object is limited to its Length)
+  BaseStream *baseStr = str->getBaseStream();
+  baseStr->reset();
+  while ((n = baseStr->doGetChars(sizeof(block), (Guchar *)block)) > 0) {
+    buf.append(block, n);
+  }
+  baseStr->close();
+
+  Dict *srcDict = str->getDict();
+  dict.initDict(dstXRef);
+  for (int i = 0; i < srcDict->getLength(); ++i) {
+    if (strcmp(srcDict->getKey(i), "Length") != 0) {
+      Object val;
+      srcDict->getValNF(i, &val);
+      dict.dictAdd(copyString(srcDict->getKey(i)), copy(&val, &obj));
+      val.free();
+    }
+  }
+  dict.dictSet("Length", obj.initInt(buf.getLength()));
+
+  // the MemStream owns the data and the dictionary; the filters on top
+  // of it make PDFDoc::writeObject copy the data as it is
+  char *data = (char *)gmalloc(buf.getLength() > 0 ? buf.getLength() : 1);
+  memcpy(data, buf.getCString(), buf.getLength());
+  MemStream *memStr = new MemStream(data, 0, buf.getLength(), &dict);
+  memStr->setNeedFree(gTrue);
+  return dst->initStream(memStr->addFilters(&dict));
+}
+
+Object *ObjectCopier::copyRef(Ref ref, Object *dst) {
+  std::map<int, Ref>::iterator it = refMap.find(ref.num);
+  if (it != refMap.end()) {
+    return dst->initRef(it->second.num, it->second.gen);
+  }
+
+  // reserve the new object first, for the references back to it
+  Object obj, copied;
+  Ref newRef = dstXRef->addIndirectObject(obj.initNull());
+  refMap[ref.num] = newRef;
+  srcXRef->fetch(ref.num, ref.gen, &obj);
+  dstXRef->setModifiedObject(copy(&obj, &copied), newRef);
+  copied.free();
+  obj.free();
+  return dst->initRef(newRef.num, newRef.gen);
+}
+
+//------------------------------------------------------------------------
+
+// Make a stream object of unencoded content.
+static Object *makeContentStream(XRef *xref, GooString *content, Object *dst) {
+  Object dict, obj;
+
+  dict.initDict(xref);
+  dict.dictSet("Length", obj.initInt(content->getLength()));
+  char *data = (char *)gmalloc(content->getLength() > 0 ? content->getLength() : 1);
+  memcpy(data, content->getCString(), content->getLength());
+  MemStream *memStr = new MemStream(data, 0, content->getLength(), &dict);
+  memStr->setNeedFree(gTrue);
+  return dst->initStream(memStr);
+}
+
+// Return an array of the numbers.
+static Object *makeNumArray(XRef *xref, double *nums, int n, Object *dst) {
+  Object obj;
+
+  dst->initArray(xref);
+  for (int i = 0; i < n; ++i) {
+    dst->arrayAdd(obj.initReal(nums[i]));
+  }
+  return dst;
+}
+
+// Compute the matrix that maps the default user space of the text page
+// onto the displayed (cropped and rotated) area of the page.
+static void computeTextMatrix(Page *page, Page *textPage, double *mat) {
+  PDFRectangle *crop = page->getCropBox();
+  PDFRectangle *box = textPage->getMediaBox();
+  int rotate = page->getRotate();
+  double w = crop->x2 - crop->x1;
+  double h = crop->y2 - crop->y1;
+  double a, b, c, d, e, f, sx, sy;
+
+  // displayed page -> page user space
+  switch (rotate) {
+  case 90:
+    a = 0;  b = 1;  c = -1; d = 0;  e = crop->x2; f = crop->y1;
+    break;
+  case 180:
+    a = -1; b = 0;  c = 0;  d = -1; e = crop->x2; f = crop->y2;
+    break;
+  case 270:
+    a = 0;  b = -1; c = 1;  d = 0;  e = crop->x1; f = crop->y2;
+    break;
+  default:
+    a = 1;  b = 0;  c = 0;  d = 1;  e = crop->x1; f = crop->y1;
+    break;
+  }
+  if (rotate == 90 || rotate == 270) {
+    sx = h / (box->x2 - box->x1);
+    sy = w / (box->y2 - box->y1);
+  } else {
+    sx = w / (box->x2 - box->x1);
+    sy = h / (box->y2 - box->y1);
+  }
+
+  // text page -> displayed page, then the above
+  mat[0] = a * sx;
+  mat[1] = b * sx;
+  mat[2] = c * sy;
+  mat[3] = d * sy;
+  mat[4] = -(a * sx * box->x1 + c * sy * box->y1) + e;
+  mat[5] = -(b * sx * box->x1 + d * sy * box->y1) + f;
+}
+
+// Turn the text page into a form XObject of the document.  Returns
+// gFalse if the text page has no content.
+static GBool makeTextForm(ObjectCopier *copier, XRef *xref, Page *page,
+			  Page *textPage, Object *form) {
+  Object contents, obj, obj2;
+  GooString buf;
+  double nums[6];
+
+  textPage->getContents(&contents);
+  if (contents.isStream()) {
+    copier->copyStream(contents.getStream(), form);
+  } else if (contents.isArray() && contents.arrayGetLength() > 0) {
+    // a form has a single stream: join the decoded streams
+    for (int i = 0; i < contents.arrayGetLength(); ++i) {
+      if (contents.arrayGet(i, &obj)->isStream()) {
+	char block[4096];
+	int n;
+	obj.streamReset();
+	while ((n = obj.getStream()->doGetChars(sizeof(block),
+						(Guchar *)block)) > 0) {
+	  buf.append(block, n);
+	}
+	obj.streamClose();
+	buf.append('\n');
+      }
+      obj.free();
+    }
+    makeContentStream(xref, &buf, form);
+  } else {
+    contents.free();
+    return gFalse;
+  }
+  contents.free();
+
+  Dict *dict = form->streamGetDict();
+  dict->set("Type", obj.initName("XObject"));
+  dict->set("Subtype", obj.initName("Form"));
+  PDFRectangle *box = textPage->getMediaBox();
+  nums[0] = box->x1;
+  nums[1] = box->y1;
+  nums[2] = box->x2;
+  nums[3] = box->y2;
+  dict->set("BBox", makeNumArray(xref, nums, 4, &obj));
+  computeTextMatrix(page, textPage, nums);
+  dict->set("Matrix", makeNumArray(xref, nums, 6, &obj));
+  if (textPage->getResourceDict()) {
+    dict->set("Resources",
+	      copier->copyDict(textPage->getResourceDict(), &obj));
+  }
+  return gTrue;
+}
+
+// Draw the text form on top of page <pg>: the page gets its own
+// Resources with the form added, and its content is wrapped as
+// [q, original content, Q + form].
+static GBool addTextLayer(PDFDoc *doc, int pg, PDFDoc *textDoc, int textPg,
+			  ObjectCopier *copier, Ref *saveRef) {
+  XRef *xref = doc->getXRef();
+  Page *page = doc->getPage(pg);
+  Page *textPage = textDoc->getPage(textPg);
+  Ref *pageRef = doc->getCatalog()->getPageRef(pg);
+  Object form, pageObj, resObj, xObjects, contents, obj, obj2;
+  GooString name, content;
+
+  if (!page || !textPage || !pageRef) {
+    error(errSyntaxError, -1, "Could not read page {0:d}", pg);
+    return gFalse;
+  }
+  if (!makeTextForm(copier, xref, page, textPage, &form)) {
+    return gTrue;
+  }
+  Ref formRef = xref->addIndirectObject(&form);
+  form.free();
+
+  xref->fetch(pageRef->num, pageRef->gen, &pageObj);
+  if (!pageObj.isDict()) {
+    error(errSyntaxError, -1, "Page {0:d} is not a dictionary", pg);
+    pageObj.free();
+    return gFalse;
+  }
+
+  // the effective (maybe inherited) resources, with a new XObject dict
+  resObj.initDict(xref);
+  xObjects.initDict(xref);
+  Dict *resDict = page->getResourceDict();
+  if (resDict) {
+    for (int i = 0; i < resDict->getLength(); ++i) {
+      if (strcmp(resDict->getKey(i), "XObject") != 0) {
+	resObj.dictAdd(copyString(resDict->getKey(i)),
+		       resDict->getValNF(i, &obj));
+      }
+    }
+    if (resDict->lookup("XObject", &obj)->isDict()) {
+      for (int i = 0; i < obj.dictGetLength(); ++i) {
+	xObjects.dictAdd(copyString(obj.dictGetKey(i)),
+			 obj.dictGetValNF(i, &obj2));
+      }
+    }
+    obj.free();
+  }
+  name.append("TextLayer");
+  for (int i = 1; !xObjects.dictLookupNF(name.getCString(), &obj)->isNull();
+       ++i) {
+    obj.free();
+    name.clear();
+    name.appendf("TextLayer{0:d}", i);
+  }
+  obj.free();
+  xObjects.dictSet(name.getCString(), obj.initRef(formRef.num, formRef.gen));
+  resObj.dictSet("XObject", &xObjects);
+  pageObj.dictSet("Resources", &resObj);
+
+  // q [original content] Q /TextLayer Do
+  if (saveRef->num < 0) {
+    GooString save("q\n");
+    *saveRef = xref->addIndirectObject(makeContentStream(xref, &save, &obj));
+    obj.free();
+  }
+  content.append("\nQ\n/");
+  content.append(&name);
+  content.append(" Do\n");
+  Ref restoreRef = xref->addIndirectObject(makeContentStream(xref, &content,
+							     &obj));
+  obj.free();
+
+  contents.initArray(xref);
+  contents.arrayAdd(obj.initRef(saveRef->num, saveRef->gen));
+  pageObj.dictLookupNF("Contents", &obj);
+  if (obj.isRef()) {
+    if (obj.fetch(xref, &obj2)->isArray()) {
+      obj.free();
+      obj = obj2;
+    } else {
+      obj2.free();
+    }
+  }
+  if (obj.isArray()) {
+    for (int i = 0; i < obj.arrayGetLength(); ++i) {
+      contents.arrayAdd(obj.arrayGetNF(i, &obj2));
+    }
+    obj.free();
+  } else if (obj.isRef()) {
+    contents.arrayAdd(&obj);
+  } else {
+    obj.free();
+  }
+  contents.arrayAdd(obj.initRef(restoreRef.num, restoreRef.gen));
+  pageObj.dictSet("Contents", &contents);
+
+  xref->setModifiedObject(&pageObj, *pageRef);
+  pageObj.free();
+  return gTrue;
+}
+
+int main(int argc, char *argv[]) {
+  PDFDoc *doc, *textDoc;
+  GooString *fileName, *textFileName, *outputName;
+  int exitCode;
+
+  exitCode = 99;
+  GBool ok = parseArgs(argDesc, &argc, argv);
+  if (!ok || argc != 4 || printVersion || printHelp) {
+    fprintf(stderr, "pdftextlayer version %s\n", PACKAGE_VERSION);
+    fprintf(stderr, "%s\n", popplerCopyright);
+    fprintf(stderr, "%s\n", xpdfCopyright);
+    if (!printVersion) {
+      printUsage("pdftextlayer", "<PDF-file> <text-PDF-file> <PDF-destfile>",
+		 argDesc);
+    }
+    if (printVersion || printHelp)
+      exitCode = 0;
+    return exitCode;
+  }
+  if (strcmp(argv[1], argv[3]) == 0 || strcmp(argv[2], argv[3]) == 0) {
+    error(errCommandLine, -1, "The output file must be a new file");
+    return 1;
+  }
+  globalParams = new GlobalParams();
+
+  fileName = new GooString(argv[1]);
+  textFileName = new GooString(argv[2]);
+  outputName = new GooString(argv[3]);
+  doc = new PDFDoc(fileName, NULL, NULL, NULL);
+  textDoc = new PDFDoc(textFileName, NULL, NULL, NULL);
+  if (!doc->isOk() || !textDoc->isOk()) {
+    exitCode = 1;
+    goto err;
+  }
+  if (doc->isEncrypted() || textDoc->isEncrypted()) {
+    error(errUnimplemented, -1, "Could not add text to encrypted files");
+    exitCode = 3;
+    goto err;
+  }
+
+  // text page n goes on top of page firstPage + n - 1
+  if (firstPage < 1)
+    firstPage = 1;
+  if (lastPage < 1 || lastPage > doc->getNumPages())
+    lastPage = doc->getNumPages();
+  if (lastPage - firstPage + 1 > textDoc->getNumPages())
+    lastPage = firstPage + textDoc->getNumPages() - 1;
+  if (lastPage < firstPage) {
+    error(errCommandLine, -1,
+	  "Wrong page range given: the first page ({0:d}) can not be after the last page ({1:d}).",
+	  firstPage, lastPage);
+    exitCode = 99;
+    goto err;
+  }
+  if (lastPage - firstPage + 1 != textDoc->getNumPages()) {
+    error(errCommandLine, -1,
+	  "The text file has {0:d} pages, only {1:d} of them are used",
+	  textDoc->getNumPages(), lastPage - firstPage + 1);
+  }
+
+  {
+    ObjectCopier copier(textDoc->getXRef(), doc->getXRef());
+    Ref saveRef;
+    saveRef.num = saveRef.gen = -1;
+    for (int pg = firstPage; pg <= lastPage; ++pg) {
+      if (!addTextLayer(doc, pg, textDoc, pg - firstPage + 1,
+			&copier, &saveRef)) {
+	exitCode = 3;
+	goto err;
+      }
+    }
+  }
+
+  if (doc->saveAs(outputName, writeForceIncremental) != errNone) {
+    exitCode = 2;
+    goto err;
+  }
+  exitCode = 0;
+
+ err:
+  delete textDoc;
+  delete doc;
+  delete outputName;
+  delete globalParams;
+  Object::memCheck(stderr);
+  gMemReport(stderr);
+  return exitCode;
+}
@@ -52,11 +52,11 @@
 #include "splash/Splash.h"
 #include "SplashOutputDev.h"
 
-// Uncomment to build pdftoppm with pthreads
-// You may also have to change the buildsystem to
-// link pdftoppm to pthread library
-// This is here for developer testing not user ready
-// #define UTILS_USE_PTHREADS 1
+// Pages can be rendered by several threads sharing the PDFDoc when the
+// library is built with its object locking enabled
+#if MULTITHREADED && defined(HAVE_PTHREAD)
+#define UTILS_USE_PTHREADS 1
+#endif
 
 #ifdef UTILS_USE_PTHREADS
 #include <errno.h>
@@ -95,8 +95,10 @@ static char antialiasStr[16] = "";
 static char vectorAntialiasStr[16] = "";
 static GBool fontAntialias = gTrue;
 static GBool vectorAntialias = gTrue;
+static GBool dctScale = gFalse;
 static char ownerPassword[33] = "";
 static char userPassword[33] = "";
+static GBool mapFile = gFalse;
 static char TiffCompressionStr[16] = "";
 static char thinLineModeStr[8] = "";
 static SplashThinLineMode thinLineMode = splashThinLineDefault;
@@ -177,6 +179,8 @@ static const ArgDesc argDesc[] = {
 #endif
   {"-thinlinemode", argString, thinLineModeStr, sizeof(thinLineModeStr),
    "set thin line mode: none, solid, shape. Default: none"},
+  {"-dctscale",   argFlag,        &dctScale,      0,
+   "decode JPEG images drawn at a reduced size at a lower resolution"},
   
   {"-aa",         argString,      antialiasStr,   sizeof(antialiasStr),
    "enable font anti-aliasing: yes, no"},
@@ -187,6 +191,8 @@ static const ArgDesc argDesc[] = {
    "owner password (for encrypted files)"},
   {"-upw",    argString,   userPassword,   sizeof(userPassword),
    "user password (for encrypted files)"},
+  {"-mmap",   argFlag,     &mapFile,       0,
+   "read the PDF file through a memory mapping"},
   
 #ifdef UTILS_USE_PTHREADS
   {"-j",      argInt,      &numberOfJobs,  0,
@@ -208,17 +214,36 @@ static const ArgDesc argDesc[] = {
   {NULL}
 };
 
+static SplashOutputDev *createSplashOutputDev(PDFDoc *doc,
+                                              SplashColor paperColor) {
+  SplashOutputDev *splashOut;
+
+  splashOut = new SplashOutputDev(mono ? splashModeMono1 :
+				    gray ? splashModeMono8 :
+#if SPLASH_CMYK
+				    (jpegcmyk || overprint) ? splashModeDeviceN8 :
+#endif
+				             splashModeRGB8, 4,
+				  gFalse, paperColor, gTrue, thinLineMode);
+  splashOut->setFontAntialias(fontAntialias);
+  splashOut->setVectorAntialias(vectorAntialias);
+  splashOut->setReduceImageResolution(dctScale);
+  splashOut->startDoc(doc);
+  return splashOut;
+}
+
 static void savePageSlice(PDFDoc *doc,
                    SplashOutputDev *splashOut, 
                    int pg, int x, int y, int w, int h, 
                    double pg_w, double pg_h, 
+                   double x_res, double y_res,
                    char *ppmFile) {
   if (w == 0) w = (int)ceil(pg_w);
   if (h == 0) h = (int)ceil(pg_h);
   w = (x+w > pg_w ? (int)ceil(pg_w-x) : w);
   h = (y+h > pg_h ? (int)ceil(pg_h-y) : h);
   doc->displayPageSlice(splashOut, 
-    pg, x_resolution, y_resolution, 
+    pg, x_res, y_res, 
     0,
     !useCropBox, gFalse, gFalse,
     x, y, w, h
@@ -228,13 +253,13 @@ static void savePageSlice(PDFDoc *doc,
   
   if (ppmFile != NULL) {
     if (png) {
-      bitmap->writeImgFile(splashFormatPng, ppmFile, x_resolution, y_resolution);
+      bitmap->writeImgFile(splashFormatPng, ppmFile, x_res, y_res);
     } else if (jpeg) {
-      bitmap->writeImgFile(splashFormatJpeg, ppmFile, x_resolution, y_resolution);
+      bitmap->writeImgFile(splashFormatJpeg, ppmFile, x_res, y_res);
     } else if (jpegcmyk) {
-      bitmap->writeImgFile(splashFormatJpegCMYK, ppmFile, x_resolution, y_resolution);
+      bitmap->writeImgFile(splashFormatJpegCMYK, ppmFile, x_res, y_res);
     } else if (tiff) {
-      bitmap->writeImgFile(splashFormatTiff, ppmFile, x_resolution, y_resolution, TiffCompressionStr);
+      bitmap->writeImgFile(splashFormatTiff, ppmFile, x_res, y_res, TiffCompressionStr);
     } else {
       bitmap->writePNMFile(ppmFile);
     }
@@ -244,11 +269,11 @@ static void savePageSlice(PDFDoc *doc,
 #endif
 
     if (png) {
-      bitmap->writeImgFile(splashFormatPng, stdout, x_resolution, y_resolution);
+      bitmap->writeImgFile(splashFormatPng, stdout, x_res, y_res);
     } else if (jpeg) {
-      bitmap->writeImgFile(splashFormatJpeg, stdout, x_resolution, y_resolution);
+      bitmap->writeImgFile(splashFormatJpeg, stdout, x_res, y_res);
     } else if (tiff) {
-      bitmap->writeImgFile(splashFormatTiff, stdout, x_resolution, y_resolution, TiffCompressionStr);
+      bitmap->writeImgFile(splashFormatTiff, stdout, x_res, y_res, TiffCompressionStr);
     } else {
       bitmap->writePNMFile(stdout);
     }
@@ -258,49 +283,51 @@ static void savePageSlice(PDFDoc *doc,
 #ifdef UTILS_USE_PTHREADS
 
 struct PageJob {
-  PDFDoc *doc;
   int pg;
   
   double pg_w, pg_h;
-  SplashColor* paperColor;
+  double x_res, y_res;
   
   char *ppmFile;
 };
 
-static std::deque<PageJob> pageJobQueue;
-static pthread_mutex_t pageJobMutex = PTHREAD_MUTEX_INITIALIZER;
+struct PageJobQueue {
+  PDFDoc *doc;
+  SplashColor *paperColor;
+  std::deque<PageJob> jobs;
+  pthread_mutex_t mutex;
+};
+
+// Each worker owns a SplashOutputDev (and so its font engine and caches)
+// for all of the pages it renders; only the PDFDoc is shared.
+static void *processPageJobs(void *arg) {
+  PageJobQueue *queue = (PageJobQueue *)arg;
+  SplashOutputDev *splashOut = createSplashOutputDev(queue->doc,
+                                                     *queue->paperColor);
 
-static void processPageJobs() {
   while(true) {
     // pop the next job or exit if queue is empty
-    pthread_mutex_lock(&pageJobMutex);
+    pthread_mutex_lock(&queue->mutex);
     
-    if(pageJobQueue.empty()) {
-      pthread_mutex_unlock(&pageJobMutex);
-      return;
+    if(queue->jobs.empty()) {
+      pthread_mutex_unlock(&queue->mutex);
+      break;
     }
     
-    PageJob pageJob = pageJobQueue.front();
-    pageJobQueue.pop_front();
-    
-    pthread_mutex_unlock(&pageJobMutex);
+    PageJob pageJob = queue->jobs.front();
+    queue->jobs.pop_front();
     
-    // process the job    
-    SplashOutputDev *splashOut = new SplashOutputDev(mono ? splashModeMono1 :
-                  gray ? splashModeMono8 :
-#if SPLASH_CMYK
-        			    (jpegcmyk || overprint) ? splashModeDeviceN8 :
-#endif
-		              splashModeRGB8, 4, gFalse, *pageJob.paperColor, gTrue, thinLineMode);
-    splashOut->setFontAntialias(fontAntialias);
-    splashOut->setVectorAntialias(vectorAntialias);
-    splashOut->startDoc(pageJob.doc);
+    pthread_mutex_unlock(&queue->mutex);
     
-    savePageSlice(pageJob.doc, splashOut, pageJob.pg, x, y, w, h, pageJob.pg_w, pageJob.pg_h, pageJob.ppmFile);
+    savePageSlice(queue->doc, splashOut, pageJob.pg, x, y, w, h,
+                  pageJob.pg_w, pageJob.pg_h, pageJob.x_res, pageJob.y_res,
+                  pageJob.ppmFile);
     
-    delete splashOut;
     delete[] pageJob.ppmFile;
   }
+
+  delete splashOut;
+  return NULL;
 }
 
 #endif // UTILS_USE_PTHREADS
@@ -324,9 +351,9 @@ int main(int argc, char *argv[]) {
   char *ppmFile;
   GooString *ownerPW, *userPW;
   SplashColor paperColor;
-#ifndef UTILS_USE_PTHREADS
   SplashOutputDev *splashOut;
-#else
+#ifdef UTILS_USE_PTHREADS
+  PageJobQueue pageJobQueue;
   pthread_t* jobs;
 #endif // UTILS_USE_PTHREADS
   GBool ok;
@@ -411,7 +438,7 @@ int main(int argc, char *argv[]) {
     delete fileName;
     fileName = new GooString("fd://0");
   }
-  doc = PDFDocFactory().createPDFDoc(*fileName, ownerPW, userPW);
+  doc = PDFDocFactory(NULL, mapFile).createPDFDoc(*fileName, ownerPW, userPW);
   delete fileName;
 
   if (userPW) {
@@ -462,23 +489,20 @@ int main(int argc, char *argv[]) {
     paperColor[2] = 255;
   }
   
-#ifndef UTILS_USE_PTHREADS
-
-  splashOut = new SplashOutputDev(mono ? splashModeMono1 :
-				    gray ? splashModeMono8 :
-#if SPLASH_CMYK
-				    (jpegcmyk || overprint) ? splashModeDeviceN8 :
-#endif
-				             splashModeRGB8, 4,
-				  gFalse, paperColor, gTrue, thinLineMode);
-
-
-
-  splashOut->setFontAntialias(fontAntialias);
-  splashOut->setVectorAntialias(vectorAntialias);
-  splashOut->startDoc(doc);
-  
+  splashOut = NULL;
+#ifdef UTILS_USE_PTHREADS
+  // pages written to stdout have to come out in order
+  if (ppmRoot == NULL || numberOfJobs < 1)
+    numberOfJobs = 1;
+  if (numberOfJobs > 1) {
+    pageJobQueue.doc = doc;
+    pageJobQueue.paperColor = &paperColor;
+    pthread_mutex_init(&pageJobQueue.mutex, NULL);
+  } else
 #endif // UTILS_USE_PTHREADS
+  {
+    splashOut = createSplashOutputDev(doc, paperColor);
+  }
   
   if (sz != 0) w = h = sz;
   pg_num_len = numberOfCharacters(doc->getNumPages());
@@ -527,52 +551,52 @@ int main(int argc, char *argv[]) {
     } else {
       ppmFile = NULL;
     }
-#ifndef UTILS_USE_PTHREADS
+#ifdef UTILS_USE_PTHREADS
+    if (numberOfJobs > 1) {
+      // queue job for worker threads
+      PageJob pageJob;
+      pageJob.pg = pg;
+      pageJob.pg_w = pg_w;
+      pageJob.pg_h = pg_h;
+      pageJob.x_res = x_resolution;
+      pageJob.y_res = y_resolution;
+      pageJob.ppmFile = ppmFile;
+      pageJobQueue.jobs.push_back(pageJob);
+      continue;
+    }
+#endif // UTILS_USE_PTHREADS
     // process job in main thread
-    savePageSlice(doc, splashOut, pg, x, y, w, h, pg_w, pg_h, ppmFile);
+    savePageSlice(doc, splashOut, pg, x, y, w, h, pg_w, pg_h,
+                  x_resolution, y_resolution, ppmFile);
     
     delete[] ppmFile;
-#else
-    
-    // queue job for worker threads
-    PageJob pageJob = {
-      .doc = doc,
-      .pg = pg,
-      
-      .pg_w = pg_w, .pg_h = pg_h,
-      
-      .paperColor = &paperColor,
-      
-      .ppmFile = ppmFile
-    };
-    
-    pageJobQueue.push_back(pageJob);
-    
-#endif // UTILS_USE_PTHREADS
   }
-#ifndef UTILS_USE_PTHREADS
   delete splashOut;
-#else
-  
-  // spawn worker threads and wait on them
-  jobs = (pthread_t*)malloc(numberOfJobs * sizeof(pthread_t));
+#ifdef UTILS_USE_PTHREADS
+  if (numberOfJobs > 1) {
+    if (numberOfJobs > (int)pageJobQueue.jobs.size())
+      numberOfJobs = pageJobQueue.jobs.size();
 
-  for(int i=0; i < numberOfJobs; ++i) {
-    if(pthread_create(&jobs[i], NULL, (void* (*)(void*))processPageJobs, NULL) != 0) {
-	    fprintf(stderr, "pthread_create() failed with errno: %d\n", errno);
-	    exit(EXIT_FAILURE);
+    // spawn worker threads and wait on them
+    jobs = (pthread_t*)malloc(numberOfJobs * sizeof(pthread_t));
+
+    for(int i=0; i < numberOfJobs; ++i) {
+      if(pthread_create(&jobs[i], NULL, processPageJobs, &pageJobQueue) != 0) {
+	fprintf(stderr, "pthread_create() failed with errno: %d\n", errno);
+	exit(EXIT_FAILURE);
+      }
     }
-  }
-  
-  for(int i=0; i < numberOfJobs; ++i) {
-    if(pthread_join(jobs[i], NULL) != 0) {
-      fprintf(stderr, "pthread_join() failed with errno: %d\n", errno);
-      exit(EXIT_FAILURE);
+
+    for(int i=0; i < numberOfJobs; ++i) {
+      if(pthread_join(jobs[i], NULL) != 0) {
+	fprintf(stderr, "pthread_join() failed with errno: %d\n", errno);
+	exit(EXIT_FAILURE);
+      }
     }
-  }
 
-  free(jobs);
-  
+    free(jobs);
+    pthread_mutex_destroy(&pageJobQueue.mutex);
+  }
 #endif // UTILS_USE_PTHREADS
 
   exitCode = 0;
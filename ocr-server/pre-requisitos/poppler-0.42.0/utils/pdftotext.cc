@@ -60,6 +60,17 @@
 #include <sstream>
 #include <iomanip>
 
+// Pages can be extracted by several threads sharing the PDFDoc when the
+// library is built with its object locking enabled
+#if MULTITHREADED && defined(HAVE_PTHREAD)
+#define UTILS_USE_PTHREADS 1
+#endif
+
+#ifdef UTILS_USE_PTHREADS
+#include <errno.h>
+#include <pthread.h>
+#endif // UTILS_USE_PTHREADS
+
 static void printInfoString(FILE *f, Dict *infoDict, const char *key,
 			    const char *text1, const char *text2, UnicodeMap *uMap);
 static void printInfoDate(FILE *f, Dict *infoDict, const char *key, const char *fmt);
@@ -78,16 +89,22 @@ static GBool bboxLayout = gFalse;
 static GBool physLayout = gFalse;
 static double fixedPitch = 0;
 static GBool rawOrder = gFalse;
+static GBool wordStream = gFalse;
 static GBool htmlMeta = gFalse;
 static char textEncName[128] = "";
 static char textEOL[16] = "";
 static GBool noPageBreaks = gFalse;
 static char ownerPassword[33] = "\001";
 static char userPassword[33] = "\001";
+static GBool mapFile = gFalse;
+static GBool noAnnots = gFalse;
 static GBool quiet = gFalse;
 static GBool printVersion = gFalse;
 static GBool printHelp = gFalse;
 static GBool printEnc = gFalse;
+#ifdef UTILS_USE_PTHREADS
+static int numberOfJobs = 1;
+#endif // UTILS_USE_PTHREADS
 
 static const ArgDesc argDesc[] = {
   {"-f",       argInt,      &firstPage,     0,
@@ -110,6 +127,8 @@ static const ArgDesc argDesc[] = {
    "assume fixed-pitch (or tabular) text"},
   {"-raw",     argFlag,     &rawOrder,      0,
    "keep strings in content stream order"},
+  {"-words",   argFlag,     &wordStream,    0,
+   "write each word with its page and bounding box, in content stream order"},
   {"-htmlmeta", argFlag,   &htmlMeta,       0,
    "generate a simple HTML file, including the meta information"},
   {"-enc",     argString,   textEncName,    sizeof(textEncName),
@@ -128,6 +147,14 @@ static const ArgDesc argDesc[] = {
    "owner password (for encrypted files)"},
   {"-upw",     argString,   userPassword,   sizeof(userPassword),
    "user password (for encrypted files)"},
+  {"-mmap",    argFlag,     &mapFile,       0,
+   "read the PDF file through a memory mapping"},
+  {"-noannots", argFlag,     &noAnnots,      0,
+   "don't process annotations"},
+#ifdef UTILS_USE_PTHREADS
+  {"-j",       argInt,      &numberOfJobs,  0,
+   "number of pages to extract concurrently"},
+#endif // UTILS_USE_PTHREADS
   {"-q",       argFlag,     &quiet,         0,
    "don't print any messages or errors"},
   {"-v",       argFlag,     &printVersion,  0,
@@ -157,6 +184,137 @@ static std::string myStringReplace(const std::string &inString, const std::strin
   return result;
 }
 
+static void extractPage(PDFDoc *doc, TextOutputDev *textOut, int page) {
+  if ((w==0) && (h==0) && (x==0) && (y==0)) {
+    doc->displayPage(textOut, page, resolution, resolution, 0,
+		     gTrue, gFalse, gFalse);
+  } else {
+    doc->displayPageSlice(textOut, page, resolution, resolution, 0,
+			  gTrue, gFalse, gFalse,
+			  x, y, w, h);
+  }
+}
+
+#ifdef UTILS_USE_PTHREADS
+
+// The text of each page is written once the pages before it are: the
+// workers stay at most <window> pages ahead of the writer, which bounds
+// the text kept in memory.
+struct PageTextQueue {
+  PDFDoc *doc;
+  int first, last;
+  int nextPage;			// next page to extract
+  int nextWrite;		// next page to write
+  int window;
+  GooString **texts;		// [page - first], NULL until extracted
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+};
+
+static void outputToPageText(void *stream, const char *text, int len) {
+  (*(GooString **)stream)->append(text, len);
+}
+
+static TextOutputDev *createTextOutputDev(TextOutputFunc func, void *stream) {
+  TextOutputDev *textOut = new TextOutputDev(func, stream, physLayout,
+					     fixedPitch, rawOrder);
+  textOut->setWordStream(wordStream);
+  return textOut;
+}
+
+// Each worker owns a TextOutputDev for all of the pages it extracts;
+// only the PDFDoc is shared.
+static void *processPageTexts(void *arg) {
+  PageTextQueue *queue = (PageTextQueue *)arg;
+  GooString *pageText = NULL;
+  TextOutputDev *textOut = createTextOutputDev(&outputToPageText, &pageText);
+  int page;
+
+  while (true) {
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->nextPage <= queue->last &&
+	   queue->nextPage - queue->nextWrite >= queue->window) {
+      pthread_cond_wait(&queue->cond, &queue->mutex);
+    }
+    if (queue->nextPage > queue->last) {
+      pthread_mutex_unlock(&queue->mutex);
+      break;
+    }
+    page = queue->nextPage++;
+    pthread_mutex_unlock(&queue->mutex);
+
+    pageText = new GooString();
+    extractPage(queue->doc, textOut, page);
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->texts[page - queue->first] = pageText;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+  }
+
+  delete textOut;
+  return NULL;
+}
+
+// Extract the pages with <numberOfJobs> threads and write their text, in
+// page order, to <f>.
+static void extractPagesConcurrently(PDFDoc *doc, FILE *f) {
+  PageTextQueue queue;
+  pthread_t *jobs;
+  GooString *pageText;
+  int page;
+
+  queue.doc = doc;
+  queue.first = firstPage;
+  queue.last = lastPage;
+  queue.nextPage = queue.nextWrite = firstPage;
+  queue.window = 2 * numberOfJobs;
+  queue.texts = (GooString **)gmallocn(lastPage - firstPage + 1,
+				       sizeof(GooString *));
+  for (page = firstPage; page <= lastPage; ++page) {
+    queue.texts[page - firstPage] = NULL;
+  }
+  pthread_mutex_init(&queue.mutex, NULL);
+  pthread_cond_init(&queue.cond, NULL);
+
+  jobs = (pthread_t *)gmallocn(numberOfJobs, sizeof(pthread_t));
+  for (int i = 0; i < numberOfJobs; ++i) {
+    if (pthread_create(&jobs[i], NULL, processPageTexts, &queue) != 0) {
+      fprintf(stderr, "pthread_create() failed with errno: %d\n", errno);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  for (page = firstPage; page <= lastPage; ++page) {
+    pthread_mutex_lock(&queue.mutex);
+    while (!queue.texts[page - firstPage]) {
+      pthread_cond_wait(&queue.cond, &queue.mutex);
+    }
+    pageText = queue.texts[page - firstPage];
+    queue.texts[page - firstPage] = NULL;
+    ++queue.nextWrite;
+    pthread_cond_broadcast(&queue.cond);
+    pthread_mutex_unlock(&queue.mutex);
+
+    fwrite(pageText->getCString(), 1, pageText->getLength(), f);
+    delete pageText;
+  }
+
+  for (int i = 0; i < numberOfJobs; ++i) {
+    if (pthread_join(jobs[i], NULL) != 0) {
+      fprintf(stderr, "pthread_join() failed with errno: %d\n", errno);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  gfree(jobs);
+  gfree(queue.texts);
+  pthread_cond_destroy(&queue.cond);
+  pthread_mutex_destroy(&queue.mutex);
+}
+
+#endif // UTILS_USE_PTHREADS
+
 static std::string myXmlTokenReplace(const char *inString){
   std::string myString(inString);
   myString = myStringReplace(myString, "&",  "&amp;" );
@@ -187,6 +345,12 @@ int main(int argc, char *argv[]) {
   if (bboxLayout) {
     bbox = gTrue;
   }
+  if (wordStream) {
+    // the words are written as they are found: no layout and no HTML
+    bbox = bboxLayout = htmlMeta = physLayout = gFalse;
+    fixedPitch = 0;
+    rawOrder = gTrue;
+  }
   if (bbox) {
     htmlMeta = gTrue;
   }
@@ -256,7 +420,7 @@ int main(int argc, char *argv[]) {
       fileName = new GooString("fd://0");
   }
 
-  doc = PDFDocFactory().createPDFDoc(*fileName, ownerPW, userPW);
+  doc = PDFDocFactory(NULL, mapFile).createPDFDoc(*fileName, ownerPW, userPW);
 
   if (userPW) {
     delete userPW;
@@ -268,6 +432,7 @@ int main(int argc, char *argv[]) {
     exitCode = 1;
     goto err2;
   }
+  doc->setProcessAnnotations(!noAnnots);
 
 #ifdef ENFORCE_PERMISSIONS
   // check for copy permission
@@ -373,19 +538,36 @@ int main(int argc, char *argv[]) {
     if (f != stdout) {
       fclose(f);
     }
+#ifdef UTILS_USE_PTHREADS
+  } else if (numberOfJobs > 1 && lastPage > firstPage) {
+    if (!textFileName->cmp("-")) {
+      f = stdout;
+    } else if (!(f = fopen(textFileName->getCString(), htmlMeta ? "ab" : "wb"))) {
+      error(errIO, -1, "Couldn't open text file '{0:t}'", textFileName);
+      exitCode = 2;
+      goto err3;
+    }
+    if (numberOfJobs > lastPage - firstPage + 1) {
+      numberOfJobs = lastPage - firstPage + 1;
+    }
+    extractPagesConcurrently(doc, f);
+    if (f != stdout) {
+      fclose(f);
+    }
+    textOut = NULL;
+#endif // UTILS_USE_PTHREADS
   } else {
     textOut = new TextOutputDev(textFileName->getCString(),
 				physLayout, fixedPitch, rawOrder, htmlMeta);
     if (textOut->isOk()) {
+      textOut->setWordStream(wordStream);
       if ((w==0) && (h==0) && (x==0) && (y==0)) {
 	doc->displayPages(textOut, firstPage, lastPage, resolution, resolution, 0,
 			  gTrue, gFalse, gFalse);
       } else {
 	
 	for (int page = firstPage; page <= lastPage; ++page) {
-	  doc->displayPageSlice(textOut, page, resolution, resolution, 0,
-			      gTrue, gFalse, gFalse, 
-			      x, y, w, h);
+	  extractPage(doc, textOut, page);
 	}
       }
 
@@ -15,16 +15,26 @@
 //========================================================================
 
 #include <PDFDoc.h>
+#include <ObjectStreamWriter.h>
 #include <GlobalParams.h>
+#include <Decrypt.h>
 #include "parseargs.h"
 #include "config.h"
 #include <poppler-config.h>
+#include <map>
+#include <string>
 #include <vector>
 
+static GBool compact = gFalse;
+static GBool lowMemory = gFalse;
 static GBool printVersion = gFalse;
 static GBool printHelp = gFalse;
 
 static const ArgDesc argDesc[] = {
+  {"-compact", argFlag, &compact, 0,
+   "write object streams and a cross-reference stream (PDF 1.5)"},
+  {"-lowmem", argFlag, &lowMemory, 0,
+   "open the files one at a time and write identical objects once"},
   {"-v", argFlag, &printVersion, 0,
    "print copyright and version info"},
   {"-h", argFlag, &printHelp, 0,
@@ -164,6 +174,622 @@ void doMergeNameDict(PDFDoc *doc, XRef *srcXRef, XRef *countRef, int oldRefNum,
   }
 }
 
+// Remove the output intents of <intents> which <doc> does not have.
+// Return gFalse if <doc> has no output intents at all.
+static GBool filterOutputIntents(Object *intents, PDFDoc *doc) {
+  Object pagecatObj, pageintents;
+  doc->getXRef()->getCatalog(&pagecatObj);
+  Dict *pagecatDict = pagecatObj.getDict();
+  pagecatDict->lookup("OutputIntents", &pageintents);
+  if (!pageintents.isArray() || pageintents.arrayGetLength() == 0) {
+    pagecatObj.free();
+    pageintents.free();
+    return gFalse;
+  }
+  for (int j = intents->arrayGetLength() - 1; j >= 0; j--) {
+    Object intent;
+    intents->arrayGet(j, &intent, 0);
+    if (intent.isDict()) {
+      Object idf;
+      intent.dictLookup("OutputConditionIdentifier", &idf);
+      if (idf.isString()) {
+        GooString *gidf = idf.getString();
+        GBool removeIntent = gTrue;
+        for (int k = 0; k < pageintents.arrayGetLength(); k++) {
+          Object pgintent;
+          pageintents.arrayGet(k, &pgintent, 0);
+          if (pgintent.isDict()) {
+            Object pgidf;
+            pgintent.dictLookup("OutputConditionIdentifier", &pgidf);
+            if (pgidf.isString()) {
+              GooString *gpgidf = pgidf.getString();
+              if (gpgidf->cmp(gidf) == 0) {
+                pgidf.free();
+                pgintent.free();
+                removeIntent = gFalse;
+                break;
+              }
+            }
+            pgidf.free();
+          }
+          pgintent.free();
+        }
+        if (removeIntent) {
+          intents->arrayRemove(j);
+          error(errSyntaxWarning, -1, "Output intent {0:s} missing in pdf {1:s}, removed",
+           gidf->getCString(), doc->getFileName()->getCString());
+        }
+      } else {
+        intents->arrayRemove(j);
+        error(errSyntaxWarning, -1, "Invalid output intent dict, missing required OutputConditionIdentifier");
+      }
+      idf.free();
+    } else {
+      intents->arrayRemove(j);
+    }
+    intent.free();
+  }
+  pagecatObj.free();
+  pageintents.free();
+  return gTrue;
+}
+
+//------------------------------------------------------------------------
+// MergeWriter
+//
+// Merges the documents one at a time (-lowmem): each page is written,
+// with the objects it uses, as soon as it is copied, and the document
+// can be closed before the next one is opened.  The objects are numbered
+// in the output as they are written.  A resource (an object reached
+// from a /Resources dictionary) which is written the same way as one
+// written before, such as the font an OCR engine embeds in each of its
+// files, is not written again; only a digest of each written resource is
+// kept to find them.  Other objects, and in particular annotations and
+// what they refer to, are always copied: a page can't share them.
+//------------------------------------------------------------------------
+
+class MergeWriter {
+public:
+
+  // Constructor.  <objStmsA> is NULL unless the objects are packed into
+  // object streams.
+  MergeWriter(OutStream *outStrA, XRef *yRefA, ObjectStreamWriter *objStmsA);
+
+  // Destructor.
+  ~MergeWriter();
+
+  // Write the pages of <doc>, and merge its name trees.  AcroForm,
+  // OCProperties and the output intents in <intents> are taken from the
+  // first document.
+  void addDoc(PDFDoc *doc, GBool first, Object *intents);
+
+  // Write the catalog, the page tree and the cross-reference.
+  void finish(const char *fileName);
+
+private:
+
+  int reserveNum();
+  Object *copy(Object *src, Object *dst, GBool shared);
+  int copyRef(Ref ref, GBool shared);
+  void copyStream(Stream *str, MemOutStream *data, GBool shared);
+  void copyPage(Page *page, Ref *pageRef);
+  void addNames(Dict *namesDict);
+  int writeShared(MemOutStream *data, GBool isStream);
+  void writeObject(int num, MemOutStream *data, GBool isStream);
+
+  OutStream *outStr;
+  XRef *yRef;
+  ObjectStreamWriter *objStms;
+  int catalogNum, pagesNum;
+  XRef *srcXRef;		// the document being copied
+  std::map<int, int> refMap;	// its object numbers -> output numbers
+				//   (0 while the object is copied)
+  std::map<std::string, int> digests; // MD5 and length of the written
+				//   resources -> output numbers
+  std::vector<int> pageNums;
+  Object acroForm, ocProperties, outputIntents;
+  std::map<std::string, std::map<std::string, int> > names;
+				// name tree -> key -> output number
+};
+
+MergeWriter::MergeWriter(OutStream *outStrA, XRef *yRefA,
+			 ObjectStreamWriter *objStmsA) {
+  outStr = outStrA;
+  yRef = yRefA;
+  objStms = objStmsA;
+  srcXRef = NULL;
+  catalogNum = reserveNum();
+  pagesNum = reserveNum();
+  acroForm.initNull();
+  ocProperties.initNull();
+  outputIntents.initNull();
+}
+
+MergeWriter::~MergeWriter() {
+  acroForm.free();
+  ocProperties.free();
+  outputIntents.free();
+}
+
+int MergeWriter::reserveNum() {
+  int num = yRef->getNumObjects();
+  yRef->add(num, 0, 0, gTrue);
+  return num;
+}
+
+// The objects <src> refers to are written with copyRef; <shared> is set
+// below a /Resources key, and cleared below an /Annots key or an
+// annotation.
+Object *MergeWriter::copy(Object *src, Object *dst, GBool shared) {
+  Object val, obj;
+
+  switch (src->getType()) {
+  case objRef:
+    return dst->initRef(copyRef(src->getRef(), shared), 0);
+  case objDict: {
+    GBool annot = src->isDict("Annot");
+    dst->initDict(yRef);
+    for (int i = 0; i < src->dictGetLength(); ++i) {
+      const char *key = src->dictGetKey(i);
+      GBool sharedVal = shared && !annot;
+      if (strcmp(key, "Resources") == 0) {
+        sharedVal = gTrue;
+      } else if (strcmp(key, "Annots") == 0) {
+        sharedVal = gFalse;
+      }
+      src->dictGetValNF(i, &val);
+      dst->dictAdd(copyString(key), copy(&val, &obj, sharedVal));
+      val.free();
+    }
+    return dst;
+  }
+  case objArray:
+    dst->initArray(yRef);
+    for (int i = 0; i < src->arrayGetLength(); ++i) {
+      src->arrayGetNF(i, &val);
+      dst->arrayAdd(copy(&val, &obj, shared));
+      val.free();
+    }
+    return dst;
+  case objString:
+    return dst->initString(src->getString()->copy());
+  case objName:
+    return dst->initName(src->getName());
+  default:
+    // streams are always indirect
+    return src->copy(dst);
+  }
+}
+
+int MergeWriter::copyRef(Ref ref, GBool shared) {
+  std::map<int, int>::iterator it = refMap.find(ref.num);
+  if (it != refMap.end()) {
+    if (it->second == 0) {
+      // a reference back to an object being copied: it gets its number
+      // now, and is not shared
+      it->second = reserveNum();
+    }
+    return it->second;
+  }
+
+  refMap[ref.num] = 0;
+  Object obj, copied;
+  MemOutStream data;
+  srcXRef->fetch(ref.num, ref.gen, &obj);
+  if (obj.isDict("Annot")) {
+    shared = gFalse;
+  }
+  GBool isStream = obj.isStream();
+  if (isStream) {
+    copyStream(obj.getStream(), &data, shared);
+  } else {
+    PDFDoc::writeObject(copy(&obj, &copied, shared), &data, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+    copied.free();
+  }
+  obj.free();
+
+  int num = refMap[ref.num];
+  if (num == 0 && shared) {
+    num = writeShared(&data, isStream);
+  } else {
+    if (num == 0) {
+      num = reserveNum();
+    }
+    writeObject(num, &data, isStream);
+  }
+  refMap[ref.num] = num;
+  return num;
+}
+
+// Write the stream with its data as it is stored in the file.
+void MergeWriter::copyStream(Stream *str, MemOutStream *data, GBool shared) {
+  Object dict, val, obj;
+  Guchar block[4096];
+  int n;
+
+  Dict *srcDict = str->getDict();
+  dict.initDict(yRef);
+  for (int i = 0; i < srcDict->getLength(); ++i) {
+    const char *key = srcDict->getKey(i);
+    if (strcmp(key, "Length") != 0) {
+      srcDict->getValNF(i, &val);
+      dict.dictAdd(copyString(key),
+                   copy(&val, &obj, shared || strcmp(key, "Resources") == 0));
+      val.free();
+    }
+  }
+
+  // the base stream of a stream object is limited to its Length
+  MemOutStream raw;
+  BaseStream *baseStr = str->getBaseStream();
+  baseStr->reset();
+  while ((n = baseStr->doGetChars(sizeof(block), block)) > 0) {
+    raw.write((char *)block, n);
+  }
+  baseStr->close();
+  dict.dictAdd(copyString("Length"), obj.initInt(raw.getLength()));
+
+  PDFDoc::writeObject(&dict, data, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+  dict.free();
+  data->printf("stream\r\n");
+  data->write(raw.getData(), raw.getLength());
+  data->printf("\r\nendstream");
+}
+
+static Object *makeBox(XRef *xref, PDFRectangle *box, Object *dst) {
+  Object obj;
+  dst->initArray(xref);
+  dst->arrayAdd(obj.initReal(box->x1));
+  dst->arrayAdd(obj.initReal(box->y1));
+  dst->arrayAdd(obj.initReal(box->x2));
+  dst->arrayAdd(obj.initReal(box->y2));
+  return dst;
+}
+
+void MergeWriter::copyPage(Page *page, Ref *pageRef) {
+  Object pageObj, dict, val, obj;
+
+  srcXRef->fetch(pageRef->num, pageRef->gen, &pageObj);
+  if (!pageObj.isDict()) {
+    pageObj.free();
+    return;
+  }
+  Dict *pageDict = pageObj.getDict();
+  dict.initDict(yRef);
+  for (int i = 0; i < pageDict->getLength(); ++i) {
+    const char *key = pageDict->getKey(i);
+    if (strcmp(key, "Parent") == 0) {
+      dict.dictAdd(copyString(key), obj.initRef(pagesNum, 0));
+    } else {
+      pageDict->getValNF(i, &val);
+      dict.dictAdd(copyString(key),
+                   copy(&val, &obj, strcmp(key, "Resources") == 0));
+      val.free();
+    }
+  }
+
+  // the attributes the page inherits from the page tree
+  if (!pageDict->hasKey("Resources") && page->getResourceDict()) {
+    val.initDict(page->getResourceDict());
+    dict.dictAdd(copyString("Resources"), copy(&val, &obj, gTrue));
+    val.free();
+  }
+  if (!pageDict->hasKey("MediaBox")) {
+    dict.dictAdd(copyString("MediaBox"), makeBox(yRef, page->getMediaBox(), &obj));
+  }
+  if (!pageDict->hasKey("CropBox") && page->isCropped()) {
+    dict.dictAdd(copyString("CropBox"), makeBox(yRef, page->getCropBox(), &obj));
+  }
+  if (!pageDict->hasKey("Rotate") && page->getRotate() != 0) {
+    dict.dictAdd(copyString("Rotate"), obj.initInt(page->getRotate()));
+  }
+  pageObj.free();
+
+  MemOutStream data;
+  PDFDoc::writeObject(&dict, &data, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+  dict.free();
+  writeObject(refMap[pageRef->num], &data, gFalse);
+}
+
+void MergeWriter::addDoc(PDFDoc *doc, GBool first, Object *intents) {
+  Catalog *catalog = doc->getCatalog();
+  srcXRef = doc->getXRef();
+
+  // number the pages first, for the references between them
+  // (annotations, destinations)
+  int firstPage = pageNums.size();
+  for (int pg = 1; pg <= doc->getNumPages(); ++pg) {
+    Ref *pageRef = catalog->getPageRef(pg);
+    if (catalog->getPage(pg) && pageRef) {
+      refMap[pageRef->num] = reserveNum();
+      pageNums.push_back(refMap[pageRef->num]);
+    }
+  }
+  for (int pg = 1; pg <= doc->getNumPages(); ++pg) {
+    Ref *pageRef = catalog->getPageRef(pg);
+    if (catalog->getPage(pg) && pageRef) {
+      copyPage(catalog->getPage(pg), pageRef);
+    }
+  }
+  if ((int)pageNums.size() == firstPage) {
+    error(errSyntaxWarning, -1, "No pages in pdf {0:t}", doc->getFileName());
+  }
+
+  Object catObj, obj;
+  srcXRef->getCatalog(&catObj);
+  if (catObj.isDict()) {
+    if (first) {
+      catObj.dictLookupNF("AcroForm", &obj);
+      if (!obj.isNull()) {
+        copy(&obj, &acroForm, gFalse);
+      }
+      obj.free();
+      catObj.dictLookupNF("OCProperties", &obj);
+      if (!obj.isNull()) {
+        copy(&obj, &ocProperties, gFalse);
+      }
+      obj.free();
+      if (intents->isArray() && intents->arrayGetLength() > 0) {
+        outputIntents.initArray(yRef);
+        for (int j = 0; j < intents->arrayGetLength(); ++j) {
+          Object intent, copied;
+          intents->arrayGetNF(j, &intent);
+          outputIntents.arrayAdd(copy(&intent, &copied, gFalse));
+          intent.free();
+        }
+      }
+    }
+    catObj.dictLookup("Names", &obj);
+    if (obj.isDict()) {
+      addNames(obj.getDict());
+    }
+    obj.free();
+  }
+  catObj.free();
+
+  refMap.clear();
+  srcXRef = NULL;
+}
+
+// Merge the entries of the top level Names arrays of the name trees, as
+// the documents are merged without -lowmem.  The first entry of a key is
+// kept.
+void MergeWriter::addNames(Dict *namesDict) {
+  for (int i = 0; i < namesDict->getLength(); ++i) {
+    Object tree, array;
+    std::map<std::string, int> &entries = names[namesDict->getKey(i)];
+    namesDict->getVal(i, &tree);
+    if (tree.isDict() && tree.dictLookup("Names", &array)->isArray()) {
+      for (int j = 0; j + 1 < array.arrayGetLength(); j += 2) {
+        Object key, value;
+        if (array.arrayGet(j, &key)->isString()) {
+          std::string k(key.getString()->getCString(), key.getString()->getLength());
+          if (entries.find(k) == entries.end()) {
+            array.arrayGetNF(j + 1, &value);
+            if (value.isRef()) {
+              entries[k] = copyRef(value.getRef(), gFalse);
+            } else {
+              Object copied;
+              MemOutStream data;
+              PDFDoc::writeObject(copy(&value, &copied, gFalse), &data, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+              copied.free();
+              entries[k] = reserveNum();
+              writeObject(entries[k], &data, gFalse);
+            }
+            value.free();
+          }
+        }
+        key.free();
+      }
+    }
+    array.free();
+    tree.free();
+  }
+}
+
+// Write the resource unless the same one was written before; return its
+// number.
+int MergeWriter::writeShared(MemOutStream *data, GBool isStream) {
+  Guchar digest[16];
+  char length[16];
+  md5((Guchar *)data->getData(), data->getLength(), digest);
+  std::string key((char *)digest, sizeof(digest));
+  key.append(length, sprintf(length, ":%d", data->getLength()));
+
+  std::map<std::string, int>::iterator it = digests.find(key);
+  if (it != digests.end()) {
+    return it->second;
+  }
+  int num = reserveNum();
+  writeObject(num, data, isStream);
+  digests[key] = num;
+  return num;
+}
+
+void MergeWriter::writeObject(int num, MemOutStream *data, GBool isStream) {
+  char *p = data->getData();
+  int n = data->getLength();
+  if (objStms && !isStream) {
+    OutStream *objStr = objStms->beginObject(num);
+    for (int i = 0; i < n; ++i) {
+      objStr->put(p[i]);
+    }
+    objStms->endObject();
+  } else {
+    Goffset offset = outStr->getPos();
+    outStr->printf("%i 0 obj\r\n", num);
+    for (int i = 0; i < n; ++i) {
+      outStr->put(p[i]);
+    }
+    outStr->printf("\r\nendobj\r\n");
+    yRef->add(num, 0, offset, gTrue);
+  }
+}
+
+void MergeWriter::finish(const char *fileName) {
+  MemOutStream data;
+  Object obj;
+
+  data.printf("<< /Type /Catalog /Pages %d 0 R", pagesNum);
+  if (outputIntents.isArray()) {
+    data.printf(" /OutputIntents ");
+    PDFDoc::writeObject(&outputIntents, &data, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+  }
+  if (!acroForm.isNull()) {
+    data.printf(" /AcroForm ");
+    PDFDoc::writeObject(&acroForm, &data, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+  }
+  if (!ocProperties.isNull()) {
+    data.printf(" /OCProperties ");
+    PDFDoc::writeObject(&ocProperties, &data, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+  }
+  if (!names.empty()) {
+    data.printf(" /Names <<");
+    std::map<std::string, std::map<std::string, int> >::iterator tree;
+    for (tree = names.begin(); tree != names.end(); ++tree) {
+      GooString treeName(tree->first.c_str());
+      GooString *nameToPrint = treeName.sanitizedName(gFalse);
+      data.printf(" /%s << /Names [", nameToPrint->getCString());
+      delete nameToPrint;
+      // std::map keeps the keys in byte order, as name trees do
+      std::map<std::string, int>::iterator entry;
+      for (entry = tree->second.begin(); entry != tree->second.end(); ++entry) {
+        obj.initString(new GooString(entry->first.data(), entry->first.size()));
+        PDFDoc::writeObject(&obj, &data, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+        obj.free();
+        data.printf("%d 0 R ", entry->second);
+      }
+      data.printf("] >>");
+    }
+    data.printf(" >>");
+  }
+  data.printf(" >>");
+  writeObject(catalogNum, &data, gFalse);
+
+  data.clear();
+  data.printf("<< /Type /Pages /Kids [");
+  for (size_t i = 0; i < pageNums.size(); ++i) {
+    data.printf(" %d 0 R", pageNums[i]);
+  }
+  data.printf(" ] /Count %d >>", (int)pageNums.size());
+  writeObject(pagesNum, &data, gFalse);
+
+  Ref ref;
+  ref.num = catalogNum;
+  ref.gen = 0;
+  Goffset uxrefOffset = outStr->getPos();
+  Dict *trailerDict = PDFDoc::createTrailerDict(yRef->getNumObjects(), gFalse, 0, &ref, yRef,
+                                                fileName, uxrefOffset);
+  if (objStms) {
+    objStms->writeXRefStreamTrailer(trailerDict, yRef);
+  } else {
+    PDFDoc::writeXRefTableTrailer(trailerDict, yRef, gTrue, uxrefOffset, outStr, yRef);
+  }
+  delete trailerDict;
+}
+
+// Merge with a MergeWriter.  The files are opened twice, one at a time:
+// first to check them, and find their PDF version and the output intents
+// they all have, then to copy them.
+static int uniteLowMemory(int nFiles, char **files, char *fileName) {
+  PDFDoc *firstDoc = NULL;
+  Object intents;
+  int majorVersion = 0;
+  int minorVersion = 0;
+
+  intents.initNull();
+  for (int i = 0; i < nFiles; i++) {
+    PDFDoc *doc = new PDFDoc(new GooString(files[i]), NULL, NULL, NULL);
+    if (!doc->isOk() || doc->isEncrypted()) {
+      if (doc->isOk()) {
+        error(errUnimplemented, -1, "Could not merge encrypted files ('{0:s}')", files[i]);
+      } else {
+        error(errSyntaxError, -1, "Could not merge damaged documents ('{0:s}')", files[i]);
+      }
+      delete doc;
+      intents.free();
+      delete firstDoc;
+      return -1;
+    }
+    if (doc->getPDFMajorVersion() > majorVersion) {
+      majorVersion = doc->getPDFMajorVersion();
+      minorVersion = doc->getPDFMinorVersion();
+    } else if (doc->getPDFMajorVersion() == majorVersion &&
+               doc->getPDFMinorVersion() > minorVersion) {
+      minorVersion = doc->getPDFMinorVersion();
+    }
+    if (i == 0) {
+      Object catObj;
+      doc->getXRef()->getCatalog(&catObj);
+      if (catObj.isDict()) {
+        catObj.dictLookup("OutputIntents", &intents);
+      }
+      catObj.free();
+      firstDoc = doc;
+    } else {
+      if (intents.isArray() && intents.arrayGetLength() > 0 &&
+          !filterOutputIntents(&intents, doc)) {
+        error(errSyntaxWarning, -1, "Output intents differs, remove them all");
+        intents.free();
+        intents.initNull();
+      }
+      delete doc;
+    }
+  }
+
+  FILE *f;
+  if (!(f = fopen(fileName, "wb"))) {
+    error(errIO, -1, "Could not open file '{0:s}'", fileName);
+    intents.free();
+    delete firstDoc;
+    return -1;
+  }
+  OutStream *outStr = new FileOutStream(f, 0);
+  XRef *yRef = new XRef();
+  yRef->add(0, 65535, 0, gFalse);
+  ObjectStreamWriter *objStms = NULL;
+  if (compact) {
+    objStms = new ObjectStreamWriter(outStr, yRef);
+    if (majorVersion == 1 && minorVersion < 5) {
+      minorVersion = 5;
+    }
+  }
+  PDFDoc::writeHeader(outStr, majorVersion, minorVersion);
+
+  int exitCode = 0;
+  MergeWriter *writer = new MergeWriter(outStr, yRef, objStms);
+  for (int i = 0; i < nFiles; i++) {
+    PDFDoc *doc = firstDoc;
+    if (i > 0) {
+      doc = new PDFDoc(new GooString(files[i]), NULL, NULL, NULL);
+      if (!doc->isOk()) {
+        error(errSyntaxError, -1, "Could not merge damaged documents ('{0:s}')", files[i]);
+        delete doc;
+        exitCode = -1;
+        break;
+      }
+    }
+    writer->addDoc(doc, i == 0, &intents);
+    if (i == 0) {
+      // the output intents belong to the first document
+      intents.free();
+      intents.initNull();
+    }
+    delete doc;
+  }
+  if (exitCode == 0) {
+    writer->finish(fileName);
+  }
+  delete writer;
+
+  outStr->close();
+  delete objStms;
+  delete outStr;
+  fclose(f);
+  delete yRef;
+  return exitCode;
+}
+
 ///////////////////////////////////////////////////////////////////////////
 int main (int argc, char *argv[])
 ///////////////////////////////////////////////////////////////////////////
@@ -177,7 +803,8 @@ int main (int argc, char *argv[])
   std::vector<Guint> offsets;
   XRef *yRef, *countRef;
   FILE *f;
-  OutStream *outStr;
+  OutStream *outStr, *objStr;
+  ObjectStreamWriter *objStms;
   int i;
   int j, rootNum;
   std::vector<PDFDoc *>docs;
@@ -203,6 +830,12 @@ int main (int argc, char *argv[])
   exitCode = 0;
   globalParams = new GlobalParams();
 
+  if (lowMemory) {
+    exitCode = uniteLowMemory(argc - 2, argv + 1, fileName);
+    delete globalParams;
+    return exitCode;
+  }
+
   for (i = 1; i < argc - 1; i++) {
     GooString *gfileName = new GooString(argv[i]);
     PDFDoc *doc = new PDFDoc(gfileName, NULL, NULL, NULL);
@@ -234,6 +867,13 @@ int main (int argc, char *argv[])
   yRef = new XRef();
   countRef = new XRef();
   yRef->add(0, 65535, 0, gFalse);
+  objStms = NULL;
+  if (compact) {
+    objStms = new ObjectStreamWriter(outStr, yRef);
+    if (majorVersion == 1 && minorVersion < 5) {
+      minorVersion = 5;
+    }
+  }
   PDFDoc::writeHeader(outStr, majorVersion, minorVersion);
 
   // handle OutputIntents, AcroForm, OCProperties & Names
@@ -261,59 +901,11 @@ int main (int argc, char *argv[])
     }
     if (intents.isArray() && intents.arrayGetLength() > 0) {
       for (i = 1; i < (int) docs.size(); i++) {
-        Object pagecatObj, pageintents;
-        docs[i]->getXRef()->getCatalog(&pagecatObj);
-        Dict *pagecatDict = pagecatObj.getDict();
-        pagecatDict->lookup("OutputIntents", &pageintents);
-        if (pageintents.isArray() && pageintents.arrayGetLength() > 0) {
-          for (j = intents.arrayGetLength() - 1; j >= 0; j--) {
-            Object intent;
-            intents.arrayGet(j, &intent, 0);
-            if (intent.isDict()) {
-              Object idf;
-              intent.dictLookup("OutputConditionIdentifier", &idf);
-              if (idf.isString()) {
-                GooString *gidf = idf.getString();
-                GBool removeIntent = gTrue;
-                for (int k = 0; k < pageintents.arrayGetLength(); k++) {
-                  Object pgintent;
-                  pageintents.arrayGet(k, &pgintent, 0);
-                  if (pgintent.isDict()) {
-                    Object pgidf;
-                    pgintent.dictLookup("OutputConditionIdentifier", &pgidf);
-                    if (pgidf.isString()) {
-                      GooString *gpgidf = pgidf.getString();
-                      if (gpgidf->cmp(gidf) == 0) {
-                        pgidf.free();
-                        removeIntent = gFalse;
-                        break;
-                      }
-                    }
-                    pgidf.free();
-                  }
-                }
-                if (removeIntent) {
-                  intents.arrayRemove(j);
-                  error(errSyntaxWarning, -1, "Output intent {0:s} missing in pdf {1:s}, removed",
-                   gidf->getCString(), docs[i]->getFileName()->getCString());
-                }
-              } else {
-                intents.arrayRemove(j);
-                error(errSyntaxWarning, -1, "Invalid output intent dict, missing required OutputConditionIdentifier");
-              }
-              idf.free();
-            } else {
-              intents.arrayRemove(j);
-            }
-            intent.free();
-          }
-        } else {
+        if (!filterOutputIntents(&intents, docs[i])) {
           error(errSyntaxWarning, -1, "Output intents differs, remove them all");
           intents.free();
           break;
         }
-        pagecatObj.free();
-        pageintents.free();
       }
     }
     if (intents.isArray() && intents.arrayGetLength() > 0) {
@@ -357,7 +949,11 @@ int main (int argc, char *argv[])
       pageDict->lookupNF("Annots", &annotsObj);
       if (!annotsObj.isNull()) {
         docs[i]->markAnnotations(&annotsObj, yRef, countRef, numOffset, refPage->num, refPage->num);
-        annotsObj.free();
+        if (annotsObj.isRef()) {
+          annotsObj.free();
+        } else {
+          pageDict->set("Annots", &annotsObj);
+        }
       }
     }
     Object pageCatObj, pageNames;
@@ -373,77 +969,104 @@ int main (int argc, char *argv[])
     }
     pageNames.free();
     pageCatObj.free();
-    objectsCount += docs[i]->writePageObjects(outStr, yRef, numOffset, gTrue);
+    objectsCount += docs[i]->writePageObjects(outStr, yRef, numOffset, gTrue, objStms);
     numOffset = yRef->getNumObjects() + 1;
   }
 
   rootNum = yRef->getNumObjects() + 1;
-  yRef->add(rootNum, 0, outStr->getPos(), gTrue);
-  outStr->printf("%d 0 obj\n", rootNum);
-  outStr->printf("<< /Type /Catalog /Pages %d 0 R", rootNum + 1);
+  if (objStms) {
+    // the catalog and the pages go before the object streams
+    objStms->setFirstFreeNum(rootNum + pages.size() + 2);
+    objStr = objStms->beginObject(rootNum);
+  } else {
+    yRef->add(rootNum, 0, outStr->getPos(), gTrue);
+    outStr->printf("%d 0 obj\n", rootNum);
+    objStr = outStr;
+  }
+  objStr->printf("<< /Type /Catalog /Pages %d 0 R", rootNum + 1);
   // insert OutputIntents
   if (intents.isArray() && intents.arrayGetLength() > 0) {
-    outStr->printf(" /OutputIntents [");
+    objStr->printf(" /OutputIntents [");
     for (j = 0; j < intents.arrayGetLength(); j++) {
       Object intent;
       intents.arrayGet(j, &intent, 0);
       if (intent.isDict()) {
-        PDFDoc::writeObject(&intent, outStr, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+        PDFDoc::writeObject(&intent, objStr, yRef, 0, NULL, cryptRC4, 0, 0, 0);
       }
       intent.free();
     }
-    outStr->printf("]");
+    objStr->printf("]");
   }
   intents.free();
   // insert AcroForm
   if (!afObj.isNull()) {
-    outStr->printf(" /AcroForm ");
-    PDFDoc::writeObject(&afObj, outStr, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+    objStr->printf(" /AcroForm ");
+    PDFDoc::writeObject(&afObj, objStr, yRef, 0, NULL, cryptRC4, 0, 0, 0);
     afObj.free();
   }
   // insert OCProperties
   if (!ocObj.isNull() && ocObj.isDict()) {
-    outStr->printf(" /OCProperties ");
-    PDFDoc::writeObject(&ocObj, outStr, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+    objStr->printf(" /OCProperties ");
+    PDFDoc::writeObject(&ocObj, objStr, yRef, 0, NULL, cryptRC4, 0, 0, 0);
     ocObj.free();
   }
   // insert Names
   if (!names.isNull() && names.isDict()) {
-    outStr->printf(" /Names ");
-    PDFDoc::writeObject(&names, outStr, yRef, 0, NULL, cryptRC4, 0, 0, 0);
+    objStr->printf(" /Names ");
+    PDFDoc::writeObject(&names, objStr, yRef, 0, NULL, cryptRC4, 0, 0, 0);
     names.free();
   }
-  outStr->printf(">>\nendobj\n");
+  objStr->printf(">>\n");
+  if (objStms) {
+    objStms->endObject();
+    objStr = objStms->beginObject(rootNum + 1);
+  } else {
+    outStr->printf("endobj\n");
+    yRef->add(rootNum + 1, 0, outStr->getPos(), gTrue);
+    outStr->printf("%d 0 obj\n", rootNum + 1);
+  }
   objectsCount++;
 
-  yRef->add(rootNum + 1, 0, outStr->getPos(), gTrue);
-  outStr->printf("%d 0 obj\n", rootNum + 1);
-  outStr->printf("<< /Type /Pages /Kids [");
+  objStr->printf("<< /Type /Pages /Kids [");
   for (j = 0; j < (int) pages.size(); j++)
-    outStr->printf(" %d 0 R", rootNum + j + 2);
-  outStr->printf(" ] /Count %zd >>\nendobj\n", pages.size());
+    objStr->printf(" %d 0 R", rootNum + j + 2);
+  objStr->printf(" ] /Count %zd >>\n", pages.size());
+  if (objStms) {
+    objStms->endObject();
+  } else {
+    outStr->printf("endobj\n");
+  }
   objectsCount++;
 
   for (i = 0; i < (int) pages.size(); i++) {
-    yRef->add(rootNum + i + 2, 0, outStr->getPos(), gTrue);
-    outStr->printf("%d 0 obj\n", rootNum + i + 2);
-    outStr->printf("<< ");
+    if (objStms) {
+      objStr = objStms->beginObject(rootNum + i + 2);
+    } else {
+      yRef->add(rootNum + i + 2, 0, outStr->getPos(), gTrue);
+      outStr->printf("%d 0 obj\n", rootNum + i + 2);
+    }
+    objStr->printf("<< ");
     Dict *pageDict = pages[i].getDict();
     for (j = 0; j < pageDict->getLength(); j++) {
       if (j > 0)
-	outStr->printf(" ");
+	objStr->printf(" ");
       const char *key = pageDict->getKey(j);
       Object value;
       pageDict->getValNF(j, &value);
       if (strcmp(key, "Parent") == 0) {
-        outStr->printf("/Parent %d 0 R", rootNum + 1);
+        objStr->printf("/Parent %d 0 R", rootNum + 1);
       } else {
-        outStr->printf("/%s ", key);
-        PDFDoc::writeObject(&value, outStr, yRef, offsets[i], NULL, cryptRC4, 0, 0, 0);
+        objStr->printf("/%s ", key);
+        PDFDoc::writeObject(&value, objStr, yRef, offsets[i], NULL, cryptRC4, 0, 0, 0);
       }
       value.free();
     }
-    outStr->printf(" >>\nendobj\n");
+    objStr->printf(" >>\n");
+    if (objStms) {
+      objStms->endObject();
+    } else {
+      outStr->printf("endobj\n");
+    }
     objectsCount++;
   }
   Goffset uxrefOffset = outStr->getPos();
@@ -452,8 +1075,13 @@ int main (int argc, char *argv[])
   ref.gen = 0;
   Dict *trailerDict = PDFDoc::createTrailerDict(objectsCount, gFalse, 0, &ref, yRef,
                                                 fileName, outStr->getPos());
-  PDFDoc::writeXRefTableTrailer(trailerDict, yRef, gTrue, // write all entries according to ISO 32000-1, 7.5.4 Cross-Reference Table: "For a file that has never been incrementally updated, the cross-reference section shall contain only one subsection, whose object numbering begins at 0."
-                                uxrefOffset, outStr, yRef);
+  if (objStms) {
+    objStms->writeXRefStreamTrailer(trailerDict, yRef);
+    delete objStms;
+  } else {
+    PDFDoc::writeXRefTableTrailer(trailerDict, yRef, gTrue, // write all entries according to ISO 32000-1, 7.5.4 Cross-Reference Table: "For a file that has never been incrementally updated, the cross-reference section shall contain only one subsection, whose object numbering begins at 0."
+                                  uxrefOffset, outStr, yRef);
+  }
   delete trailerDict;
 
   outStr->close();
@@ -161,9 +161,30 @@ ImageData* Tesseract::GetLineData(const TBOX& line_box,
 // is also returned to enable calculation of output bounding boxes.
 ImageData* Tesseract::GetRectImage(const TBOX& box, const BLOCK& block,
                                    int padding, TBOX* revised_box) const {
+  bool vertical_text = false;
+  Pix* box_pix = GetRectPix(BestPix(), box, block, padding, revised_box,
+                            &vertical_text);
+  if (box_pix == NULL) return NULL;
+  // Convert sub-8-bit images to 8 bit.
+  int depth = pixGetDepth(box_pix);
+  if (depth < 8) {
+    Pix* grey;
+    grey = pixConvertTo8(box_pix, false);
+    pixDestroy(&box_pix);
+    box_pix = grey;
+  }
+  return new ImageData(vertical_text, box_pix);
+}
+
+// As GetRectImage, but cuts the image from the given page_pix, and returns it
+// as a Pix without any change of depth or encoding.
+Pix* Tesseract::GetRectPix(Pix* page_pix, const TBOX& box, const BLOCK& block,
+                           int padding, TBOX* revised_box,
+                           bool* vertical_text) const {
   TBOX wbox = box;
   wbox.pad(padding, padding);
   *revised_box = wbox;
+  *vertical_text = false;
   // Number of clockwise 90 degree rotations needed to get back to tesseract
   // coords from the clipped image.
   int num_rotations = 0;
@@ -178,41 +199,28 @@ ImageData* Tesseract::GetRectImage(const TBOX& box, const BLOCK& block,
   if (block.bounding_box().major_overlap(*revised_box))
     revised_box->rotate(block.re_rotation());
   // Now revised_box always refers to the image.
-  // BestPix is never colormapped, but may be of any depth.
-  Pix* pix = BestPix();
-  int width = pixGetWidth(pix);
-  int height = pixGetHeight(pix);
+  int width = pixGetWidth(page_pix);
+  int height = pixGetHeight(page_pix);
   TBOX image_box(0, 0, width, height);
   // Clip to image bounds;
   *revised_box &= image_box;
   if (revised_box->null_box()) return NULL;
   Box* clip_box = boxCreate(revised_box->left(), height - revised_box->top(),
                             revised_box->width(), revised_box->height());
-  Pix* box_pix = pixClipRectangle(pix, clip_box, NULL);
-  if (box_pix == NULL) return NULL;
+  Pix* box_pix = pixClipRectangle(page_pix, clip_box, NULL);
   boxDestroy(&clip_box);
+  if (box_pix == NULL) return NULL;
   if (num_rotations > 0) {
     Pix* rot_pix = pixRotateOrth(box_pix, num_rotations);
     pixDestroy(&box_pix);
     box_pix = rot_pix;
-  }
-  // Convert sub-8-bit images to 8 bit.
-  int depth = pixGetDepth(box_pix);
-  if (depth < 8) {
-    Pix* grey;
-    grey = pixConvertTo8(box_pix, false);
-    pixDestroy(&box_pix);
-    box_pix = grey;
-  }
-  bool vertical_text = false;
-  if (num_rotations > 0) {
     // Rotated the clipped revised box back to internal coordinates.
     FCOORD rotation(block.re_rotation().x(), -block.re_rotation().y());
     revised_box->rotate(rotation);
     if (num_rotations != 2)
-      vertical_text = true;
+      *vertical_text = true;
   }
-  return new ImageData(vertical_text, box_pix);
+  return box_pix;
 }
 
 #ifndef ANDROID_BUILD
@@ -234,15 +242,36 @@ void Tesseract::LSTMRecognizeWord(const BLOCK& block, ROW *row, WERD_RES *word,
     if (baseline + row->x_height() + row->ascenders() > word_box.top())
       word_box.set_top(baseline + row->x_height() + row->ascenders());
   }
-  ImageData* im_data = GetRectImage(word_box, block, kImagePadding, &word_box);
-  if (im_data == NULL) return;
-  lstm_recognizer_->RecognizeLine(*im_data, true, classify_debug_level > 0,
+  // Cut the line straight from the page image, without going through the
+  // PNG encoding of an ImageData.
+  bool vertical_text;
+  Pix* line_pix = GetRectPix(LineSourcePix(), word_box, block, kImagePadding,
+                             &word_box, &vertical_text);
+  if (line_pix == NULL) return;
+  lstm_recognizer_->set_blank_run_compression(lstm_blank_run_compression);
+  lstm_recognizer_->RecognizeLine(line_pix, true, classify_debug_level > 0,
                                   kWorstDictCertainty / kCertaintyScale,
                                   word_box, words);
-  delete im_data;
+  pixDestroy(&line_pix);
   SearchWords(words);
 }
 
+// Returns the page image to cut LSTM line images from. It is BestPix(),
+// converted once per page to 8 bit grey unless the network takes color, so
+// the conversion is not repeated on every line. The cache is destroyed by
+// everything that replaces an image BestPix() may return.
+Pix* Tesseract::LineSourcePix() {
+  if (pix_line_source_ == NULL) {
+    Pix* best_pix = BestPix();
+    int depth = pixGetDepth(best_pix);
+    if (depth == 8 || (depth == 32 && lstm_recognizer_->IsColorInput()))
+      pix_line_source_ = pixClone(best_pix);
+    else
+      pix_line_source_ = pixConvertTo8(best_pix, false);
+  }
+  return pix_line_source_;
+}
+
 // Apply segmentation search to the given set of words, within the constraints
 // of the existing ratings matrix. If there is already a best_choice on a word
 // leaves it untouched and just sets the done/accepted etc flags.
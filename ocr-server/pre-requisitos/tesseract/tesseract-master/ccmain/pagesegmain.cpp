@@ -153,6 +153,7 @@ int Tesseract::SegmentPage(const STRING* input_file, BLOCK_LIST* blocks,
       Pix* pixcleaned = RemoveEnclosingCircle(pix_binary_);
       if (pixcleaned != NULL) {
         pixDestroy(&pix_binary_);
+        pixDestroy(&pix_line_source_);
         pix_binary_ = pixcleaned;
       }
     }
@@ -224,6 +224,10 @@ Tesseract::Tesseract()
                   this->params()),
       BOOL_MEMBER(lstm_use_matrix, 1,
                   "Use ratings matrix/beam search with lstm", this->params()),
+      INT_MEMBER(lstm_blank_run_compression, 0,
+                 "Shorten blank runs longer than this many line heights before"
+                 " lstm recognition (0=off)",
+                 this->params()),
       STRING_MEMBER(outlines_odd, "%| ", "Non standard number of outlines",
                     this->params()),
       STRING_MEMBER(outlines_2, "ij!?%\":;", "Non standard number of outlines",
@@ -603,6 +607,7 @@ Tesseract::Tesseract()
       pix_grey_(NULL),
       pix_original_(NULL),
       pix_thresholds_(NULL),
+      pix_line_source_(NULL),
       source_resolution_(0),
       textord_(this),
       right_to_left_(false),
@@ -649,6 +654,7 @@ void Tesseract::Clear() {
   pixDestroy(&pix_binary_);
   pixDestroy(&pix_grey_);
   pixDestroy(&pix_thresholds_);
+  pixDestroy(&pix_line_source_);
   pixDestroy(&scaled_color_);
   deskew_ = FCOORD(1.0f, 0.0f);
   reskew_ = FCOORD(1.0f, 0.0f);
@@ -707,6 +713,7 @@ void Tesseract::PrepareForPageseg() {
     if (pageseg_strategy > max_pageseg_strategy)
       max_pageseg_strategy = pageseg_strategy;
     pixDestroy(&sub_langs_[i]->pix_binary_);
+    pixDestroy(&sub_langs_[i]->pix_line_source_);
     sub_langs_[i]->pix_binary_ = pixClone(pix_binary());
   }
   // Perform shiro-rekha (top-line) splitting and replace the current image by
@@ -716,6 +723,7 @@ void Tesseract::PrepareForPageseg() {
   if (splitter_.Split(true, &pixa_debug_)) {
     ASSERT_HOST(splitter_.splitted_image());
     pixDestroy(&pix_binary_);
+    pixDestroy(&pix_line_source_);
     pix_binary_ = pixClone(splitter_.splitted_image());
   }
 }
@@ -746,6 +754,7 @@ void Tesseract::PrepareForTessOCR(BLOCK_LIST* block_list,
   // Restore pix_binary to the binarized original pix for future reference.
   ASSERT_HOST(splitter_.orig_pix());
   pixDestroy(&pix_binary_);
+  pixDestroy(&pix_line_source_);
   pix_binary_ = pixClone(splitter_.orig_pix());
   // If the pageseg and ocr strategies are different, refresh the block list
   // (from the last SegmentImage call) with blobs from the real image to be used
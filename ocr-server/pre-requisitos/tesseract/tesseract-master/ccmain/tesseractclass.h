@@ -187,6 +187,7 @@ class Tesseract : public Wordrec {
   // Destroy any existing pix and return a pointer to the pointer.
   Pix** mutable_pix_binary() {
     pixDestroy(&pix_binary_);
+    pixDestroy(&pix_line_source_);
     return &pix_binary_;
   }
   Pix* pix_binary() const {
@@ -198,12 +199,14 @@ class Tesseract : public Wordrec {
   void set_pix_grey(Pix* grey_pix) {
     pixDestroy(&pix_grey_);
     pix_grey_ = grey_pix;
+    pixDestroy(&pix_line_source_);
   }
   Pix* pix_original() const { return pix_original_; }
   // Takes ownership of the given original_pix.
   void set_pix_original(Pix* original_pix) {
     pixDestroy(&pix_original_);
     pix_original_ = original_pix;
+    pixDestroy(&pix_line_source_);
     // Clone to sublangs as well.
     for (int i = 0; i < sub_langs_.size(); ++i)
       sub_langs_[i]->set_pix_original(original_pix ? pixClone(original_pix)
@@ -345,6 +348,14 @@ class Tesseract : public Wordrec {
   // is also returned to enable calculation of output bounding boxes.
   ImageData* GetRectImage(const TBOX& box, const BLOCK& block, int padding,
                           TBOX* revised_box) const;
+  // As GetRectImage, but cuts the image from the given page_pix, and returns
+  // it as a Pix without any change of depth or encoding, setting
+  // *vertical_text instead of the ImageData flag.
+  Pix* GetRectPix(Pix* page_pix, const TBOX& box, const BLOCK& block,
+                  int padding, TBOX* revised_box, bool* vertical_text) const;
+  // Returns the page image to cut LSTM line images from. It is BestPix(),
+  // converted once per page to 8 bit grey unless the network takes color.
+  Pix* LineSourcePix();
   // Recognizes a word or group of words, converting to WERD_RES in *words.
   // Analogous to classify_word_pass1, but can handle a group of words as well.
   void LSTMRecognizeWord(const BLOCK& block, ROW *row, WERD_RES *word,
@@ -916,6 +927,9 @@ class Tesseract : public Wordrec {
              "Run paragraph detection on the post-text-recognition "
              "(more accurate)");
   BOOL_VAR_H(lstm_use_matrix, 1, "Use ratings matrix/beam searct with lstm");
+  INT_VAR_H(lstm_blank_run_compression, 0,
+            "Shorten blank runs longer than this many line heights before"
+            " lstm recognition (0=off)");
   STRING_VAR_H(outlines_odd, "%| ", "Non standard number of outlines");
   STRING_VAR_H(outlines_2, "ij!?%\":;", "Non standard number of outlines");
   BOOL_VAR_H(docqual_excuse_outline_errs, false,
@@ -1194,6 +1208,10 @@ class Tesseract : public Wordrec {
   Pix* pix_original_;
   // Thresholds that were used to generate the thresholded image from grey.
   Pix* pix_thresholds_;
+  // Page image from which LSTM line images are cut, made from BestPix() by
+  // LineSourcePix. Must be destroyed whenever pix_binary_, pix_grey_ or
+  // pix_original_ is replaced, as BestPix() may change.
+  Pix* pix_line_source_;
   // Debug images. If non-empty, will be written on destruction.
   DebugPixa pixa_debug_;
   // Input image resolution after any scaling. The resolution is not well
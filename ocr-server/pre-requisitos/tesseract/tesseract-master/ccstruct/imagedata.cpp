@@ -29,6 +29,7 @@
 #else
 #include <thread>
 #endif
+#include <algorithm>
 
 #include "allheaders.h"
 #include "boxread.h"
@@ -39,6 +40,8 @@
 // Number of documents to read ahead while training. Doesn't need to be very
 // large.
 const int kMaxReadAhead = 8;
+// Number of threads reading pages ahead for the CS_STREAMING strategy.
+const int kNumPrefetchThreads = 2;
 
 namespace tesseract {
 
@@ -563,10 +566,105 @@ bool DocumentData::ReCachePages() {
   return !pages_.empty();
 }
 
+// Seeks through the document, without reading any of the images, to find
+// the file offset of each page, so that ReadPage can read them individually.
+// With a custom reader the whole file has to be read, and it is kept for
+// ReadPage.
+bool DocumentData::IndexPages() {
+  SVAutoLock lock(&pages_mutex_);
+  page_offsets_.truncate(0);
+  file_data_.truncate(0);
+  TFile fp;
+  FILE* file = NULL;
+  bool open_ok;
+  if (reader_ == NULL) {
+    file = fopen(document_name_.string(), "rb");
+    open_ok = file != NULL && fp.OpenStream(file);
+  } else {
+    open_ok = (*reader_)(document_name_, &file_data_) &&
+              !file_data_.empty() &&
+              fp.Open(&file_data_[0], file_data_.size());
+  }
+  int num_pages = 0;
+  bool index_ok = open_ok &&
+                  PointerVector<ImageData>::DeSerializeSize(&fp, &num_pages) &&
+                  num_pages >= 0;
+  if (!index_ok) {
+    tprintf("Deserialize header failed: %s\n", document_name_.string());
+  }
+  for (int page = 0; index_ok && page < num_pages; ++page) {
+    page_offsets_.push_back(fp.FTell());
+    if (!PointerVector<ImageData>::DeSerializeSkip(&fp)) {
+      tprintf("Index failed: %s read %d/%d pages\n", document_name_.string(),
+              page, num_pages);
+      page_offsets_.truncate(0);
+      index_ok = false;
+    }
+  }
+  if (index_ok) page_offsets_.push_back(fp.FTell());
+  if (file != NULL) fclose(file);
+  return index_ok;
+}
+
+// Reads and returns a new copy of the given page, using the offsets found by
+// IndexPages. The caller takes ownership. Returns NULL on error.
+ImageData* DocumentData::ReadPage(int index) const {
+  if (index < 0 || index >= NumIndexedPages()) return NULL;
+  inT64 start = page_offsets_[index];
+  inT64 end = page_offsets_[index + 1];
+  TFile fp;
+  FILE* file = NULL;
+  bool read_ok;
+  if (reader_ == NULL) {
+    // Read just the bytes of this page.
+    file = fopen(document_name_.string(), "rb");
+    if (file == NULL) {
+      tprintf("Can't open file %s\n", document_name_.string());
+      return NULL;
+    }
+    read_ok = fp.OpenStream(file) && fp.FSeek(start);
+  } else {
+    read_ok = file_data_.size() >= end &&
+              fp.Open(&file_data_[start], end - start);
+  }
+  ImageData* page = NULL;
+  inT8 non_null = 0;
+  if (!read_ok || fp.FRead(&non_null, sizeof(non_null), 1) != 1) {
+    tprintf("Read of page %d failed: %s\n", index, document_name_.string());
+  } else if (non_null) {
+    page = new ImageData;
+    if (!page->DeSerialize(&fp)) {
+      tprintf("Deserialize of page %d failed: %s\n", index,
+              document_name_.string());
+      delete page;
+      page = NULL;
+    } else if (page->imagefilename().length() == 0) {
+      page->set_imagefilename(document_name_);
+      page->set_page_number(index);
+    }
+  }
+  if (file != NULL) fclose(file);
+  return page;
+}
+
+// Thread function to call PrefetchPages.
+void* PrefetchPagesFunc(void* data) {
+  DocumentCache* cache = static_cast<DocumentCache*>(data);
+  cache->PrefetchPages();
+  return NULL;
+}
+
 // A collection of DocumentData that knows roughly how much memory it is using.
 DocumentCache::DocumentCache(inT64 max_memory)
-    : num_pages_per_doc_(0), max_memory_(max_memory) {}
-DocumentCache::~DocumentCache() {}
+    : num_pages_per_doc_(0),
+      max_memory_(max_memory),
+      page_order_epoch_(-1),
+      num_prefetch_threads_(0),
+      stop_prefetch_(false),
+      streamed_memory_(0),
+      last_page_id_(-1),
+      awaited_page_id_(-1) {}
+DocumentCache::~DocumentCache() { ClearStreamedPages(); }
 
 // Adds all the documents in the list of filenames, counting memory.
 // The reader is used to read the files.
@@ -586,6 +684,24 @@ bool DocumentCache::LoadDocuments(const GenericVector<STRING>& filenames,
     document->SetDocument(filename.string(), fair_share_memory, reader);
     AddToCache(document);
   }
+  if (cache_strategy_ == CS_STREAMING) {
+    // Index all the pages up front, so they can be shuffled across documents.
+    doc_page_starts_.clear();
+    int total_pages = 0;
+    for (int d = 0; d < documents_.size(); ++d) {
+      doc_page_starts_.push_back(total_pages);
+      if (!documents_[d]->IndexPages()) return false;
+      total_pages += documents_[d]->NumIndexedPages();
+    }
+    doc_page_starts_.push_back(total_pages);
+    tprintf("Indexed %d pages in %d documents\n", total_pages,
+            documents_.size());
+    SVAutoLock lock(&streaming_mutex_);
+    while (num_prefetch_threads_ < kNumPrefetchThreads &&
+           SVSync::StartThread(PrefetchPagesFunc, this)) {
+      ++num_prefetch_threads_;
+    }
+  }
   if (!documents_.empty()) {
     // Try to get the first page now to verify the list of filenames.
     if (GetPageBySerial(0) != NULL) return true;
@@ -618,6 +734,8 @@ int DocumentCache::TotalPages() {
     if (num_pages_per_doc_ == 0) GetPageSequential(0);
     return num_pages_per_doc_ * documents_.size();
   }
+  if (cache_strategy_ == CS_STREAMING)
+    return doc_page_starts_.empty() ? 0 : doc_page_starts_.back();
   int total_pages = 0;
   int num_docs = documents_.size();
   for (int d = 0; d < num_docs; ++d) {
@@ -698,6 +816,172 @@ const ImageData* DocumentCache::GetPageSequential(int serial) {
   return doc;
 }
 
+// Returns a page by serial number, selecting them from a shuffled order of all
+// the pages in all the documents, with a new order each epoch. Pages are read
+// individually on demand, with read-ahead by a fixed pool of threads, and
+// only the most recently used are kept, up to max_memory_.
+const ImageData* DocumentCache::GetPageStreaming(int serial) {
+  int total_pages = doc_page_starts_.empty() ? 0 : doc_page_starts_.back();
+  if (total_pages == 0 || serial < 0) return NULL;
+  SVAutoLock lock(&streaming_mutex_);
+  int epoch = serial / total_pages;
+  if (epoch != page_order_epoch_) ShufflePageOrder(epoch);
+  int page_id = page_order_[serial % total_pages];
+  ImageData* page = FindStreamedPage(page_id);
+  if (page == NULL && pages_in_flight_.count(page_id) > 0) {
+    auto queued =
+        std::find(prefetch_queue_.begin(), prefetch_queue_.end(), page_id);
+    if (queued != prefetch_queue_.end()) {
+      // Not started yet, so read it here rather than wait behind the others.
+      prefetch_queue_.erase(queued);
+      pages_in_flight_.erase(page_id);
+    } else {
+      // A prefetch thread is reading it, and will signal page_ready_ when
+      // it is done.
+      awaited_page_id_ = page_id;
+      streaming_mutex_.Unlock();
+      page_ready_.Wait();
+      streaming_mutex_.Lock();
+      awaited_page_id_ = -1;
+      page = FindStreamedPage(page_id);
+    }
+  }
+  if (page == NULL) {
+    // Read it now, without holding up any background reads.
+    pages_in_flight_.insert(page_id);
+    streaming_mutex_.Unlock();
+    int doc_index = StreamedDocIndex(page_id);
+    page = documents_[doc_index]->ReadPage(page_id -
+                                           doc_page_starts_[doc_index]);
+    streaming_mutex_.Lock();
+    pages_in_flight_.erase(page_id);
+    if (page != NULL) AddStreamedPage(page_id, page);
+  }
+  last_page_id_ = page_id;
+  for (int offset = 1; offset <= kMaxReadAhead && offset < total_pages;
+       ++offset) {
+    PrefetchPage(serial + offset);
+  }
+  return page;
+}
+
+// Sets page_order_ to the shuffled order of pages for the given epoch.
+void DocumentCache::ShufflePageOrder(int epoch) {
+  int total_pages = doc_page_starts_.back();
+  page_order_.resize(total_pages);
+  for (int i = 0; i < total_pages; ++i) page_order_[i] = i;
+  TRand random;
+  // The same epoch always gets the same order.
+  random.set_seed(static_cast<uinT64>(epoch) + 1);
+  for (int i = total_pages - 1; i > 0; --i) {
+    std::swap(page_order_[i], page_order_[random.IntRand() % (i + 1)]);
+  }
+  page_order_epoch_ = epoch;
+}
+
+// Queues a background read of the page at the given serial number, unless
+// it is already in memory or being read.
+void DocumentCache::PrefetchPage(int serial) {
+  int total_pages = page_order_.size();
+  // Don't look into the next epoch, as that would change page_order_.
+  if (serial / total_pages != page_order_epoch_) return;
+  int page_id = page_order_[serial % total_pages];
+  if (streamed_page_index_.count(page_id) > 0 ||
+      pages_in_flight_.count(page_id) > 0) {
+    return;
+  }
+  pages_in_flight_.insert(page_id);
+  prefetch_queue_.push_back(page_id);
+  prefetch_signal_.Signal();
+}
+
+// Body of each of the prefetch threads: reads the pages in prefetch_queue_
+// until ClearStreamedPages stops them.
+void DocumentCache::PrefetchPages() {
+  while (true) {
+    prefetch_signal_.Wait();
+    streaming_mutex_.Lock();
+    if (stop_prefetch_) break;
+    // GetPageStreaming may have taken the page off the queue itself.
+    if (prefetch_queue_.empty()) {
+      streaming_mutex_.Unlock();
+      continue;
+    }
+    int page_id = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    streaming_mutex_.Unlock();
+    int doc_index = StreamedDocIndex(page_id);
+    ImageData* page =
+        documents_[doc_index]->ReadPage(page_id - doc_page_starts_[doc_index]);
+    streaming_mutex_.Lock();
+    if (page != NULL) {
+      if (FindStreamedPage(page_id) == NULL)
+        AddStreamedPage(page_id, page);
+      else
+        delete page;
+    }
+    pages_in_flight_.erase(page_id);
+    if (page_id == awaited_page_id_) page_ready_.Signal();
+    streaming_mutex_.Unlock();
+  }
+  --num_prefetch_threads_;
+  streaming_mutex_.Unlock();
+  prefetch_exited_.Signal();
+}
+
+// Returns the page with the given id if it is in memory, moving it to the
+// front of the LRU list, or NULL otherwise.
+ImageData* DocumentCache::FindStreamedPage(int page_id) {
+  auto it = streamed_page_index_.find(page_id);
+  if (it == streamed_page_index_.end()) return NULL;
+  streamed_pages_.splice(streamed_pages_.begin(), streamed_pages_, it->second);
+  return it->second->second;
+}
+
+// Adds the given page to the front of the LRU list, taking ownership, and
+// deletes least recently used pages to fit max_memory_. Neither the new page
+// nor the page last returned by GetPageStreaming is ever deleted.
+void DocumentCache::AddStreamedPage(int page_id, ImageData* page) {
+  streamed_pages_.push_front(std::make_pair(page_id, page));
+  streamed_page_index_[page_id] = streamed_pages_.begin();
+  streamed_memory_ += page->MemoryUsed();
+  auto it = streamed_pages_.end();
+  while (max_memory_ > 0 && streamed_memory_ > max_memory_ &&
+         it != streamed_pages_.begin()) {
+    --it;
+    if (it->first == page_id || it->first == last_page_id_) continue;
+    streamed_memory_ -= it->second->MemoryUsed();
+    delete it->second;
+    streamed_page_index_.erase(it->first);
+    it = streamed_pages_.erase(it);
+  }
+}
+
+// Stops the prefetch threads and deletes all streamed pages.
+void DocumentCache::ClearStreamedPages() {
+  streaming_mutex_.Lock();
+  stop_prefetch_ = true;
+  for (int page_id : prefetch_queue_) pages_in_flight_.erase(page_id);
+  prefetch_queue_.clear();
+  int num_threads = num_prefetch_threads_;
+  streaming_mutex_.Unlock();
+  // Each thread exits at its next wake-up, and signals prefetch_exited_.
+  for (int t = 0; t < num_threads; ++t) prefetch_signal_.Signal();
+  for (int t = 0; t < num_threads; ++t) prefetch_exited_.Wait();
+  SVAutoLock lock(&streaming_mutex_);
+  stop_prefetch_ = false;
+  for (auto it = streamed_pages_.begin(); it != streamed_pages_.end(); ++it)
+    delete it->second;
+  streamed_pages_.clear();
+  streamed_page_index_.clear();
+  pages_in_flight_.clear();
+  streamed_memory_ = 0;
+  last_page_id_ = -1;
+  doc_page_starts_.clear();
+  page_order_.clear();
+  page_order_epoch_ = -1;
+}
+
 // Helper counts the number of adjacent cached neighbours of index looking in
 // direction dir, ie index+dir, index+2*dir etc.
 int DocumentCache::CountNeighbourDocs(int index, int dir) {
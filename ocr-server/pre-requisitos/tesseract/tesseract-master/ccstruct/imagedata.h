@@ -20,6 +20,13 @@
 #ifndef TESSERACT_IMAGE_IMAGEDATA_H_
 #define TESSERACT_IMAGE_IMAGEDATA_H_
 
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "genericvector.h"
 #include "normalis.h"
@@ -50,6 +57,12 @@ enum CachingStrategy {
   // get used more often than samples in larger files.
   // Best for smaller data sets that mostly fit in memory.
   CS_ROUND_ROBIN,
+  // Reads each sample from disk on demand, in an order shuffled across all the
+  // files, and keeps only the most recently used samples up to max_memory.
+  // Requires an initial pass over all the files to index the samples, but
+  // does not require shuffled samples and needs only bounded memory.
+  // Best for large data sets that are not shuffled between files.
+  CS_STREAMING,
 };
 
 class WordFeature {
@@ -267,6 +280,22 @@ class DocumentData {
   // Shuffles all the pages in the document.
   void Shuffle();
 
+  // Seeks through the document, without reading any of the images, to find
+  // the file offset of each page, so that ReadPage can read them
+  // individually. With a custom reader the whole file has to be read, and it
+  // is kept for ReadPage. Returns false on error.
+  bool IndexPages();
+  // Returns the number of pages found by IndexPages.
+  int NumIndexedPages() const {
+    return page_offsets_.empty() ? 0 : page_offsets_.size() - 1;
+  }
+  // Reads and returns a new copy of the given page, using the offsets found by
+  // IndexPages. Only the bytes of the requested page are read from the file,
+  // or copied from the file kept by IndexPages if a custom reader was
+  // supplied. Safe to call from multiple threads.
+  // The caller takes ownership. Returns NULL on error.
+  ImageData* ReadPage(int index) const;
+
  private:
   // Sets the value of total_pages_ behind a mutex.
   void set_total_pages(int total) {
@@ -296,6 +325,10 @@ class DocumentData {
   inT64 max_memory_;
   // Saved reader from LoadDocument to allow re-caching.
   FileReader reader_;
+  // File offsets of each page found by IndexPages, plus the end of the last.
+  GenericVector<inT64> page_offsets_;
+  // The whole file, kept by IndexPages only when reader_ is set.
+  GenericVector<char> file_data_;
   // Mutex that protects pages_ and pages_offset_ against multiple parallel
   // loads, and provides a wait for page.
   SVMutex pages_mutex_;
@@ -310,12 +343,15 @@ class DocumentData {
 // access different documents in parallel, as one may de-cache the other's
 // content.
 class DocumentCache {
+  friend void* PrefetchPagesFunc(void* data);
+
  public:
   explicit DocumentCache(inT64 max_memory);
   ~DocumentCache();
 
   // Deletes all existing documents from the cache.
   void Clear() {
+    ClearStreamedPages();
     documents_.clear();
     num_pages_per_doc_ = 0;
   }
@@ -335,6 +371,8 @@ class DocumentCache {
   const ImageData* GetPageBySerial(int serial) {
     if (cache_strategy_ == CS_SEQUENTIAL)
       return GetPageSequential(serial);
+    else if (cache_strategy_ == CS_STREAMING)
+      return GetPageStreaming(serial);
     else
       return GetPageRoundRobin(serial);
   }
@@ -355,6 +393,35 @@ class DocumentCache {
   // Requires the samples to be shuffled between the files to give a random or
   // uniform distribution of data. Less disk-intensive than GetPageRoundRobin.
   const ImageData* GetPageSequential(int serial);
+  // Returns a page by serial number, selecting them from a shuffled order of
+  // all the pages in all the documents, with a new order each epoch. Pages are
+  // read individually on demand, with read-ahead in background threads, and
+  // only the most recently used are kept, up to max_memory_. The returned
+  // page remains valid until the next call.
+  const ImageData* GetPageStreaming(int serial);
+  // Sets page_order_ to the shuffled order of pages for the given epoch.
+  void ShufflePageOrder(int epoch);
+  // Queues a background read of the page at the given serial number, unless
+  // it is already in memory or being read. Requires streaming_mutex_ locked.
+  void PrefetchPage(int serial);
+  // Body of each of the prefetch threads: reads the pages in prefetch_queue_
+  // until ClearStreamedPages stops them.
+  void PrefetchPages();
+  // Returns the index in documents_ of the document with the given global
+  // page id.
+  int StreamedDocIndex(int page_id) const {
+    return std::upper_bound(doc_page_starts_.begin(), doc_page_starts_.end(),
+                            page_id) - doc_page_starts_.begin() - 1;
+  }
+  // Returns the page with the given id if it is in memory, moving it to the
+  // front of the LRU list, or NULL otherwise. Requires streaming_mutex_ locked.
+  ImageData* FindStreamedPage(int page_id);
+  // Adds the given page to the front of the LRU list, taking ownership, and
+  // deletes least recently used pages to fit max_memory_. Requires
+  // streaming_mutex_ locked.
+  void AddStreamedPage(int page_id, ImageData* page);
+  // Stops the prefetch threads and deletes all streamed pages.
+  void ClearStreamedPages();
 
   // Helper counts the number of adjacent cached neighbour documents_ of index
   // looking in direction dir, ie index+dir, index+2*dir etc.
@@ -369,6 +436,43 @@ class DocumentCache {
   int num_pages_per_doc_;
   // Max memory allowed in this cache.
   inT64 max_memory_;
+
+  // The rest is only used by CS_STREAMING.
+  // Index in the global page order of the first page of each document.
+  std::vector<int> doc_page_starts_;
+  // Global page ids in the order they are to be used in page_order_epoch_.
+  std::vector<int> page_order_;
+  int page_order_epoch_;
+  // Pages in memory by global page id, most recently used at the front.
+  std::list<std::pair<int, ImageData*> > streamed_pages_;
+  std::unordered_map<int, std::list<std::pair<int, ImageData*> >::iterator>
+      streamed_page_index_;
+  // Global page ids that are queued or being read.
+  std::set<int> pages_in_flight_;
+  // Global page ids waiting for one of the prefetch threads, oldest first.
+  std::deque<int> prefetch_queue_;
+  // Number of running threads in the fixed pool that reads the pages in
+  // prefetch_queue_.
+  int num_prefetch_threads_;
+  // True while the prefetch threads are being told to exit.
+  bool stop_prefetch_;
+  // Total MemoryUsed of streamed_pages_.
+  inT64 streamed_memory_;
+  // Id of the page last returned by GetPageStreaming, which must not be
+  // deleted until the next call.
+  int last_page_id_;
+  // Id of the page being read by a prefetch thread that GetPageStreaming is
+  // waiting for, or -1.
+  int awaited_page_id_;
+  // Protects all the streaming members above against the background reads.
+  SVMutex streaming_mutex_;
+  // Signalled once for each page added to prefetch_queue_ and for each
+  // thread to stop, to wake the prefetch threads.
+  SVSemaphore prefetch_signal_;
+  // Signalled when awaited_page_id_ has been read.
+  SVSemaphore page_ready_;
+  // Signalled by each prefetch thread as it exits.
+  SVSemaphore prefetch_exited_;
 };
 
 }  // namespace tesseract
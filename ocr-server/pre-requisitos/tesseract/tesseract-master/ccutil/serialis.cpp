@@ -23,9 +23,28 @@
 
 namespace tesseract {
 
+// fseek and ftell with 64 bit offsets, as long is only 32 bits on Windows.
+static int FSeek64(FILE* fp, inT64 offset, int origin) {
+#ifdef _WIN32
+  return _fseeki64(fp, offset, origin);
+#else
+  return fseeko(fp, offset, origin);
+#endif
+}
+static inT64 FTell64(FILE* fp) {
+#ifdef _WIN32
+  return _ftelli64(fp);
+#else
+  return ftello(fp);
+#endif
+}
+
 TFile::TFile()
     : offset_(0),
       data_(NULL),
+      stream_(NULL),
+      stream_start_(0),
+      stream_end_(0),
       data_is_owned_(false),
       is_writing_(false),
       swap_(false) {}
@@ -41,6 +60,7 @@ bool TFile::Open(const STRING& filename, FileReader reader) {
     data_is_owned_ = true;
   }
   offset_ = 0;
+  stream_ = NULL;
   is_writing_ = false;
   swap_ = false;
   if (reader == NULL)
@@ -51,6 +71,7 @@ bool TFile::Open(const STRING& filename, FileReader reader) {
 
 bool TFile::Open(const char* data, int size) {
   offset_ = 0;
+  stream_ = NULL;
   if (!data_is_owned_) {
     data_ = new GenericVector<char>;
     data_is_owned_ = true;
@@ -64,12 +85,13 @@ bool TFile::Open(const char* data, int size) {
 
 bool TFile::Open(FILE* fp, inT64 end_offset) {
   offset_ = 0;
-  inT64 current_pos = ftell(fp);
+  stream_ = NULL;
+  inT64 current_pos = FTell64(fp);
   if (end_offset < 0) {
-    if (fseek(fp, 0, SEEK_END))
+    if (FSeek64(fp, 0, SEEK_END))
       return false;
-    end_offset = ftell(fp);
-    if (fseek(fp, current_pos, SEEK_SET))
+    end_offset = FTell64(fp);
+    if (FSeek64(fp, current_pos, SEEK_SET))
       return false;
   }
   int size = end_offset - current_pos;
@@ -83,8 +105,26 @@ bool TFile::Open(FILE* fp, inT64 end_offset) {
   return static_cast<int>(fread(&(*data_)[0], 1, size, fp)) == size;
 }
 
+bool TFile::OpenStream(FILE* fp) {
+  stream_start_ = FTell64(fp);
+  if (stream_start_ < 0 || FSeek64(fp, 0, SEEK_END)) return false;
+  stream_end_ = FTell64(fp);
+  if (FSeek64(fp, stream_start_, SEEK_SET)) return false;
+  stream_ = fp;
+  offset_ = stream_start_;
+  is_writing_ = false;
+  swap_ = false;
+  return true;
+}
+
 char* TFile::FGets(char* buffer, int buffer_size) {
   ASSERT_HOST(!is_writing_);
+  if (stream_ != NULL) {
+    if (buffer_size <= 0 || fgets(buffer, buffer_size, stream_) == NULL)
+      return NULL;
+    offset_ += strlen(buffer);
+    return buffer;
+  }
   int size = 0;
   while (size + 1 < buffer_size && offset_ < data_->size()) {
     buffer[size++] = (*data_)[offset_++];
@@ -109,6 +149,17 @@ int TFile::FRead(void* buffer, int size, int count) {
   ASSERT_HOST(!is_writing_);
   int required_size = size * count;
   if (required_size <= 0) return 0;
+  if (stream_ != NULL) {
+    if (stream_end_ - offset_ < required_size)
+      required_size = stream_end_ - offset_;
+    if (buffer != NULL) {
+      required_size = fread(buffer, 1, required_size, stream_);
+    } else if (FSeek64(stream_, offset_ + required_size, SEEK_SET)) {
+      return 0;
+    }
+    offset_ += required_size;
+    return required_size / size;
+  }
   if (data_->size() - offset_ < required_size)
     required_size = data_->size() - offset_;
   if (required_size > 0 && buffer != NULL)
@@ -119,11 +170,29 @@ int TFile::FRead(void* buffer, int size, int count) {
 
 void TFile::Rewind() {
   ASSERT_HOST(!is_writing_);
+  if (stream_ != NULL) {
+    FSeek(stream_start_);
+    return;
+  }
   offset_ = 0;
 }
 
+bool TFile::FSeek(inT64 offset) {
+  ASSERT_HOST(!is_writing_);
+  if (stream_ != NULL) {
+    if (offset < stream_start_ || offset > stream_end_ ||
+        FSeek64(stream_, offset, SEEK_SET))
+      return false;
+  } else if (offset < 0 || offset > data_->size()) {
+    return false;
+  }
+  offset_ = offset;
+  return true;
+}
+
 void TFile::OpenWrite(GenericVector<char>* data) {
   offset_ = 0;
+  stream_ = NULL;
   if (data != NULL) {
     if (data_is_owned_) delete data_;
     data_ = data;
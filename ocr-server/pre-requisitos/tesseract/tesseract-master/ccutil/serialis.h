@@ -61,6 +61,10 @@ class TFile {
   bool Open(const char* data, int size);
   // From an open file and an end offset.
   bool Open(FILE* fp, inT64 end_offset);
+  // Unlike the Open methods, reads directly from an open file, which must
+  // stay open while *this is used, so that a large file need not fit in
+  // memory. Data skipped with a NULL FRead buffer is seeked over unread.
+  bool OpenStream(FILE* fp);
   // Sets the value of the swap flag, so that FReadEndian does the right thing.
   void set_swap(bool value) { swap_ = value; }
 
@@ -75,6 +79,12 @@ class TFile {
   int FReadEndian(void* buffer, int size, int count);
   // Replicates fread, returning the number of items read.
   int FRead(void* buffer, int size, int count);
+  // Replicates ftell, returning the number of bytes read so far, or the
+  // offset in the file after OpenStream.
+  inT64 FTell() const { return offset_; }
+  // Replicates fseek(SEEK_SET) to an offset as returned by FTell.
+  // Returns false if offset is out of range.
+  bool FSeek(inT64 offset);
   // Resets the TFile as if it has been Opened, but nothing read.
   // Only allowed while reading!
   void Rewind();
@@ -90,10 +100,15 @@ class TFile {
   int FWrite(const void* buffer, int size, int count);
 
  private:
-  // The number of bytes used so far.
-  int offset_;
+  // The number of bytes used so far, or the file offset after OpenStream.
+  inT64 offset_;
   // The buffered data from the file.
   GenericVector<char>* data_;
+  // The file read by OpenStream, or NULL. Not owned.
+  FILE* stream_;
+  // File offsets of the start and end of the data of stream_.
+  inT64 stream_start_;
+  inT64 stream_end_;
   // True if the data_ pointer is owned by *this.
   bool data_is_owned_;
   // True if the TFile is open for writing.
@@ -308,4 +308,28 @@ void FullyConnected::CountAlternators(const Network& other, double* same,
   weights_.CountAlternators(fc->weights_, same, changed);
 }
 
+// Zeroes the weight deltas, leaving any momentum intact.
+void FullyConnected::ZeroDeltas() {
+  weights_.ZeroDeltas();
+}
+
+// Adds the weight deltas of other, which must be an identical network.
+void FullyConnected::AddDeltas(const Network& other) {
+  ASSERT_HOST(other.type() == type_);
+  const FullyConnected* fc = static_cast<const FullyConnected*>(&other);
+  weights_.AddDeltas(fc->weights_);
+}
+
+// Multiplies the weight deltas by factor.
+void FullyConnected::ScaleDeltas(double factor) {
+  weights_.ScaleDeltas(factor);
+}
+
+// Copies the weights of src, which must be an identical network.
+void FullyConnected::CopyWeights(const Network& src) {
+  ASSERT_HOST(src.type() == type_);
+  const FullyConnected* fc = static_cast<const FullyConnected*>(&src);
+  weights_.CopyWeights(fc->weights_);
+}
+
 }  // namespace tesseract.
@@ -113,6 +113,14 @@ class FullyConnected : public Network {
   // *changed.
   virtual void CountAlternators(const Network& other, double* same,
                                 double* changed) const;
+  // Zeroes the weight deltas, leaving any momentum intact.
+  void ZeroDeltas() override;
+  // Adds the weight deltas of other, which must be an identical network.
+  void AddDeltas(const Network& other) override;
+  // Multiplies the weight deltas by factor.
+  void ScaleDeltas(double factor) override;
+  // Copies the weights of src, which must be an identical network.
+  void CopyWeights(const Network& src) override;
 
  protected:
   // Weight arrays of size [no, ni + 1].
@@ -23,4 +23,32 @@ namespace tesseract {
 double TanhTable[kTableSize];
 double LogisticTable[kTableSize];
 
+// Tables of Tanh and Logistic for the quantized LSTM, built once on first use.
+struct IntFunctionTables {
+  IntFunctionTables() {
+    for (int i = 1 - kTableSize; i < kTableSize; ++i) {
+      double x = i / kScaleFactor;
+      tanh_table[i + kTableSize - 1] = IntCastRounded(tanh(x) * kIntGateScale);
+      logistic_table[i + kTableSize - 1] =
+          IntCastRounded(kIntGateScale / (1.0 + exp(-x)));
+    }
+  }
+
+  inT16 tanh_table[2 * kTableSize - 1];
+  inT16 logistic_table[2 * kTableSize - 1];
+};
+
+static const IntFunctionTables& GetIntFunctionTables() {
+  static const IntFunctionTables tables;
+  return tables;
+}
+
+const inT16* IntTanhTable() {
+  return GetIntFunctionTables().tanh_table + kTableSize - 1;
+}
+
+const inT16* IntLogisticTable() {
+  return GetIntFunctionTables().logistic_table + kTableSize - 1;
+}
+
 }  // namespace tesseract.
@@ -41,6 +41,30 @@ const double kScaleFactor = 256.0;
 extern double TanhTable[];
 extern double LogisticTable[];
 
+// Fixed-point scale of the gate values and cell state in the quantized LSTM.
+// Gates in [-1, 1] then fit in 16 bits, and state * gate fits in 32 bits for
+// the clipped range of the state.
+const int kIntGateScale = 4096;
+// Returns the fully-populated tables of Tanh and Logistic, pre-multiplied by
+// kIntGateScale, for the quantized LSTM. The returned pointer is to the middle
+// of the table, so it may be indexed by IntTableIndex in
+// [-(kTableSize - 1), kTableSize - 1]. No interpolation is needed, as the
+// error is already less than the int8 output resolution.
+const inT16* IntTanhTable();
+const inT16* IntLogisticTable();
+
+// Returns the index into an IntTanhTable/IntLogisticTable for the given x.
+inline int IntTableIndex(double x) {
+  return ClipToRange(IntCastRounded(x * kScaleFactor), 1 - kTableSize,
+                     kTableSize - 1);
+}
+
+// Looks up each of the n input values in the given int table.
+inline void IntTableLookup(const inT16* table, int n, const double* input,
+                           int* output) {
+  for (int i = 0; i < n; ++i) output[i] = table[IntTableIndex(input[i])];
+}
+
 // Non-linearity (sigmoid) functions with cache tables and clipping.
 inline double Tanh(double x) {
   if (x < 0.0) return -Tanh(-x);
@@ -27,6 +27,13 @@ namespace tesseract {
 
 // Max height for variable height inputs before scaling anyway.
 const int kMaxInputHeight = 48;
+// Max fraction of the pixels in a column that may be covered by horizontal
+// rules for it to count as blank in CompressBlankRuns. Allows for underlines
+// and form rules.
+const double kMaxBlankInkFraction = 0.125;
+// Min difference between the darkest and lightest pixels in a line image for
+// CompressBlankRuns to consider that it contains any ink at all.
+const int kMinBlankRunContrast = 32;
 
 Input::Input(const STRING& name, int ni, int no)
     : Network(NT_INPUT, name, ni, no), cached_x_scale_(1) {}
@@ -107,6 +114,34 @@ Pix* Input::PrepareLSTMInputs(const ImageData& image_data,
   return pix;
 }
 
+// As above, but from a line image that is already decoded.
+/* static */
+Pix* Input::PrepareLSTMInputs(const Pix* line_pix, const Network* network,
+                              int min_width, TRand* randomizer,
+                              float* image_scale) {
+  Pix* var_pix = const_cast<Pix*>(line_pix);
+  int input_height = pixGetHeight(var_pix);
+  // Note that NumInputs() is defined as input image height.
+  int target_height = network->NumInputs();
+  if (target_height == 0) target_height = MIN(input_height, kMaxInputHeight);
+  *image_scale = static_cast<float>(target_height) / input_height;
+  Pix* pix = pixScale(var_pix, *image_scale, *image_scale);
+  if (pix == nullptr) {
+    tprintf("Scaling pix of size %d, %d by factor %g made null pix!!\n",
+            pixGetWidth(var_pix), input_height, *image_scale);
+    return nullptr;
+  }
+  int width = pixGetWidth(pix);
+  int height = pixGetHeight(pix);
+  if (width <= min_width || height < min_width) {
+    tprintf("Image too small to scale!! (%dx%d vs min width of %d)\n", width,
+            height, min_width);
+    pixDestroy(&pix);
+    return nullptr;
+  }
+  return pix;
+}
+
 // Converts the given pix to a NetworkIO of height and depth appropriate to the
 // given StaticShape:
 // If depth == 3, convert to 24 bit color, otherwise normalized grey.
@@ -150,4 +185,114 @@ void Input::PreparePixInput(const StaticShape& shape, const Pix* pix,
   pixDestroy(&normed_pix);
 }
 
+// Returns a copy of the 8-bit pix in which every run of at least min_run
+// blank columns is shortened to sep_width columns. See input.h.
+/* static */
+Pix* Input::CompressBlankRuns(const Pix* pix, int min_run, int sep_width,
+                              int x_scale,
+                              std::vector<std::pair<int, int>>* gaps) {
+  gaps->clear();
+  Pix* var_pix = const_cast<Pix*>(pix);
+  if (pixGetDepth(var_pix) != 8 || pixGetColormap(var_pix) != nullptr)
+    return nullptr;
+  if (x_scale < 1) x_scale = 1;
+  // The separator must leave room to align the cut to x_scale.
+  if (sep_width < 2 * x_scale) sep_width = 2 * x_scale;
+  int width = pixGetWidth(var_pix);
+  int height = pixGetHeight(var_pix);
+  int wpl = pixGetWpl(var_pix);
+  l_uint32* data = pixGetData(var_pix);
+  if (min_run < sep_width + x_scale || width < min_run) return nullptr;
+  // Threshold half way between the extremes, and take the minority side of
+  // it as ink, so that either polarity of text is handled.
+  int min_pixel = 255, max_pixel = 0;
+  for (int y = 0; y < height; ++y) {
+    l_uint32* line = data + y * wpl;
+    for (int x = 0; x < width; ++x) {
+      int pixel = GET_DATA_BYTE(line, x);
+      if (pixel < min_pixel) min_pixel = pixel;
+      if (pixel > max_pixel) max_pixel = pixel;
+    }
+  }
+  if (max_pixel - min_pixel < kMinBlankRunContrast) return nullptr;
+  int threshold = (min_pixel + max_pixel) / 2;
+  int num_dark = 0;
+  for (int y = 0; y < height; ++y) {
+    l_uint32* line = data + y * wpl;
+    for (int x = 0; x < width; ++x) {
+      if (GET_DATA_BYTE(line, x) < threshold) ++num_dark;
+    }
+  }
+  bool dark_ink = num_dark * 2 <= width * height;
+  // Only ink in a horizontal run of at least one line height counts as part
+  // of a rule. Characters, specks and the dots of a leader are all shorter,
+  // so any column they touch is not blank. A dotted leader is therefore a
+  // series of blank runs no wider than the spaces between its dots, which
+  // are far below min_run, and it is kept in full, while an underline or
+  // form rule is blank wherever nothing else touches it.
+  std::vector<int> rule_counts(width, 0);
+  std::vector<bool> other_ink(width, false);
+  for (int y = 0; y < height; ++y) {
+    l_uint32* line = data + y * wpl;
+    int x = 0;
+    while (x < width) {
+      if ((GET_DATA_BYTE(line, x) < threshold) != dark_ink) {
+        ++x;
+        continue;
+      }
+      int ink_start = x;
+      while (x < width && (GET_DATA_BYTE(line, x) < threshold) == dark_ink)
+        ++x;
+      bool is_rule = x - ink_start >= height;
+      for (int i = ink_start; i < x; ++i) {
+        if (is_rule)
+          ++rule_counts[i];
+        else
+          other_ink[i] = true;
+      }
+    }
+  }
+  int max_ink = static_cast<int>(height * kMaxBlankInkFraction);
+  // Find the runs and the columns to keep.
+  std::vector<bool> keep(width, true);
+  int removed_total = 0;
+  int x = 0;
+  while (x < width) {
+    if (other_ink[x] || rule_counts[x] > max_ink) {
+      ++x;
+      continue;
+    }
+    int run_start = x;
+    while (x < width && !other_ink[x] && rule_counts[x] <= max_ink) ++x;
+    int run_length = x - run_start;
+    if (run_length < min_run) continue;
+    int num_removed = (run_length - sep_width) / x_scale * x_scale;
+    if (num_removed <= 0) continue;
+    // Keep the ends of the run, so the separator still looks like a space.
+    int cut_start = run_start + (run_length - num_removed) / 2;
+    // Align the cut to the output timesteps.
+    cut_start = (cut_start + x_scale - 1) / x_scale * x_scale;
+    if (cut_start < run_start || cut_start + num_removed > x) continue;
+    for (int i = 0; i < num_removed; ++i) keep[cut_start + i] = false;
+    gaps->push_back(std::make_pair((cut_start - removed_total) / x_scale,
+                                   num_removed / x_scale));
+    removed_total += num_removed;
+  }
+  if (removed_total == 0) return nullptr;
+  Pix* result = pixCreate(width - removed_total, height, 8);
+  int result_wpl = pixGetWpl(result);
+  for (int y = 0; y < height; ++y) {
+    l_uint32* line = data + y * wpl;
+    l_uint32* result_line = pixGetData(result) + y * result_wpl;
+    int result_x = 0;
+    for (int src_x = 0; src_x < width; ++src_x) {
+      if (keep[src_x]) {
+        SET_DATA_BYTE(result_line, result_x, GET_DATA_BYTE(line, src_x));
+        ++result_x;
+      }
+    }
+  }
+  return result;
+}
+
 }  // namespace tesseract.
@@ -83,6 +83,10 @@ class Input : public Network {
   static Pix* PrepareLSTMInputs(const ImageData& image_data,
                                 const Network* network, int min_width,
                                 TRand* randomizer, float* image_scale);
+  // As above, but from a line image that is already decoded.
+  static Pix* PrepareLSTMInputs(const Pix* line_pix, const Network* network,
+                                int min_width, TRand* randomizer,
+                                float* image_scale);
   // Converts the given pix to a NetworkIO of height and depth appropriate to
   // the given StaticShape:
   // If depth == 3, convert to 24 bit color, otherwise normalized grey.
@@ -91,6 +95,22 @@ class Input : public Network {
   // NOTE: It isn't safe for multiple threads to call this on the same pix.
   static void PreparePixInput(const StaticShape& shape, const Pix* pix,
                               TRand* randomizer, NetworkIO* input);
+  // Returns a copy of the 8-bit pix in which every run of at least min_run
+  // blank columns is shortened to sep_width columns (half taken from each
+  // end of the run), so the recurrent layers don't have to step over long
+  // stretches of whitespace or underline. A column is blank if its only ink
+  // belongs to horizontal rules at least as long as the line is high, and
+  // covers a small fraction of the column, so underlines and form rules are
+  // blank, but the dots of a leader are not. The number of columns removed
+  // from each run is a multiple of x_scale, so that network output timesteps
+  // stay aligned.
+  // For each shortened run, gaps receives a pair of the output timestep at
+  // which timesteps were removed and the number removed, as required by
+  // NetworkIO::CopyWithXExpansion to map the outputs back to the image.
+  // Returns nullptr if nothing could be removed.
+  static Pix* CompressBlankRuns(const Pix* pix, int min_run, int sep_width,
+                                int x_scale,
+                                std::vector<std::pair<int, int>>* gaps);
 
  private:
   // Input shape determines how images are dealt with.
@@ -230,6 +230,11 @@ void LSTM::Forward(bool debug, const NetworkIO& input,
   else
     output->Resize(input, no_);
   ResizeForward(input);
+  if (input.int_mode() && !IsTraining() && !Is2D()) {
+    ForwardInt(input, scratch, output);
+    if (debug) DisplayForward(*output);
+    return;
+  }
   // Temporary storage of forward computation for each gate.
   NetworkScratch::FloatVec temp_lines[WT_COUNT];
   for (int i = 0; i < WT_COUNT; ++i) temp_lines[i].Init(ns_, scratch);
@@ -407,6 +412,98 @@ void LSTM::Forward(bool debug, const NetworkIO& input,
   if (debug) DisplayForward(*output);
 }
 
+// Runs the forward pass of a 1-D LSTM on an int-mode input, keeping the gates
+// and state in fixed point, using table lookups for the non-linearities, and
+// passing the outputs on as int8. The gate pre-activations are still double,
+// as that is what the int weight matrices produce after applying their scales.
+void LSTM::ForwardInt(const NetworkIO& input, NetworkScratch* scratch,
+                      NetworkIO* output) {
+  const inT16* tanh_table = IntTanhTable();
+  const inT16* logistic_table = IntLogisticTable();
+  // The gate pre-activations are produced as double by the weight matrices,
+  // and converted by IntTableIndex straight to an index in the tables.
+  NetworkScratch::FloatVec temp_lines[WT_COUNT];
+  for (int i = 0; i < WT_COUNT; ++i) temp_lines[i].Init(ns_, scratch);
+  // Gate values and state scaled by kIntGateScale, and int8 output.
+  GenericVector<int> gates[WT_COUNT];
+  for (int i = 0; i < WT_COUNT; ++i) gates[i].init_to_size(ns_, 0);
+  GenericVector<int> curr_state;
+  curr_state.init_to_size(ns_, 0);
+  GenericVector<inT8> curr_output;
+  curr_output.init_to_size(ns_, 0);
+  const int kIntStateClip = IntCastRounded(kStateClip * kIntGateScale);
+  // Divisor to convert the state to an index into tanh_table.
+  const int kIntStateDivisor = kIntGateScale / IntCastRounded(kScaleFactor);
+  // Used only if a softmax LSTM.
+  NetworkScratch::FloatVec softmax_output;
+  NetworkScratch::IO int_output;
+  if (softmax_ != NULL) {
+    softmax_output.Init(no_, scratch);
+    ZeroVector<double>(no_, softmax_output);
+    int_output.Resize2d(true, 1, gate_weights_[CI].RoundInputs(ns_), scratch);
+    softmax_->SetupForward(input, NULL);
+  }
+  StrideMap::Index src_index(input_map_);
+  // Used only by NT_LSTM_SUMMARY.
+  StrideMap::Index dest_index(output->stride_map());
+  do {
+    int t = src_index.t();
+    // Setup the padded input in source.
+    source_.CopyTimeStepGeneral(t, 0, ni_, input, t, 0);
+    if (softmax_ != NULL) {
+      source_.WriteTimeStepPart(t, ni_, nf_, softmax_output);
+    }
+    source_.WriteTimeStepPart(t, ni_ + nf_, ns_, &curr_output[0]);
+    // Matrix multiply the inputs with the source, and look up the gates.
+    PARALLEL_IF_OPENMP(GFS)
+    gate_weights_[CI].MatrixDotVector(source_.i(t), temp_lines[CI]);
+    IntTableLookup(tanh_table, ns_, temp_lines[CI], &gates[CI][0]);
+    SECTION_IF_OPENMP
+    gate_weights_[GI].MatrixDotVector(source_.i(t), temp_lines[GI]);
+    IntTableLookup(logistic_table, ns_, temp_lines[GI], &gates[GI][0]);
+    SECTION_IF_OPENMP
+    gate_weights_[GF1].MatrixDotVector(source_.i(t), temp_lines[GF1]);
+    IntTableLookup(logistic_table, ns_, temp_lines[GF1], &gates[GF1][0]);
+    SECTION_IF_OPENMP
+    gate_weights_[GO].MatrixDotVector(source_.i(t), temp_lines[GO]);
+    IntTableLookup(logistic_table, ns_, temp_lines[GO], &gates[GO][0]);
+    END_PARALLEL_IF_OPENMP
+
+    for (int i = 0; i < ns_; ++i) {
+      // Apply the forget gate to the state, add the gated cell input and clip.
+      int state = DivRounded(curr_state[i] * gates[GF1][i] +
+                                 gates[CI][i] * gates[GI][i],
+                             kIntGateScale);
+      curr_state[i] = ClipToRange(state, -kIntStateClip, kIntStateClip);
+      int index = ClipToRange(DivRounded(curr_state[i], kIntStateDivisor),
+                              1 - kTableSize, kTableSize - 1);
+      int value = DivRounded(tanh_table[index] * gates[GO][i], kIntGateScale);
+      curr_output[i] = DivRounded(value * MAX_INT8, kIntGateScale);
+    }
+    if (softmax_ != NULL) {
+      int_output->WriteTimeStepPart(0, 0, ns_, &curr_output[0]);
+      softmax_->ForwardTimeStep(NULL, int_output->i(0), t, softmax_output);
+      output->WriteTimeStep(t, softmax_output);
+      if (type_ == NT_LSTM_SOFTMAX_ENCODED) {
+        CodeInBinary(no_, nf_, softmax_output);
+      }
+    } else if (type_ == NT_LSTM_SUMMARY) {
+      // Output only at the end of a row.
+      if (src_index.IsLast(FD_WIDTH)) {
+        output->WriteTimeStepPart(dest_index.t(), 0, ns_, &curr_output[0]);
+        dest_index.Increment();
+      }
+    } else {
+      output->WriteTimeStepPart(t, 0, ns_, &curr_output[0]);
+    }
+    // Always zero the states at the end of every row.
+    if (src_index.IsLast(FD_WIDTH)) {
+      ZeroVector<int>(ns_, &curr_state[0]);
+      ZeroVector<inT8>(ns_, &curr_output[0]);
+    }
+  } while (src_index.Increment());
+}
+
 // Runs backward propagation of errors on the deltas line.
 // See NetworkCpp for a detailed discussion of the arguments.
 bool LSTM::Backward(bool debug, const NetworkIO& fwd_deltas,
@@ -668,6 +765,46 @@ void LSTM::CountAlternators(const Network& other, double* same,
   }
 }
 
+// Zeroes the weight deltas, leaving any momentum intact.
+void LSTM::ZeroDeltas() {
+  for (int w = 0; w < WT_COUNT; ++w) {
+    if (w == GFS && !Is2D()) continue;
+    gate_weights_[w].ZeroDeltas();
+  }
+  if (softmax_ != NULL) softmax_->ZeroDeltas();
+}
+
+// Adds the weight deltas of other, which must be an identical network.
+void LSTM::AddDeltas(const Network& other) {
+  ASSERT_HOST(other.type() == type_);
+  const LSTM* lstm = static_cast<const LSTM*>(&other);
+  for (int w = 0; w < WT_COUNT; ++w) {
+    if (w == GFS && !Is2D()) continue;
+    gate_weights_[w].AddDeltas(lstm->gate_weights_[w]);
+  }
+  if (softmax_ != NULL) softmax_->AddDeltas(*lstm->softmax_);
+}
+
+// Multiplies the weight deltas by factor.
+void LSTM::ScaleDeltas(double factor) {
+  for (int w = 0; w < WT_COUNT; ++w) {
+    if (w == GFS && !Is2D()) continue;
+    gate_weights_[w].ScaleDeltas(factor);
+  }
+  if (softmax_ != NULL) softmax_->ScaleDeltas(factor);
+}
+
+// Copies the weights of src, which must be an identical network.
+void LSTM::CopyWeights(const Network& src) {
+  ASSERT_HOST(src.type() == type_);
+  const LSTM* lstm = static_cast<const LSTM*>(&src);
+  for (int w = 0; w < WT_COUNT; ++w) {
+    if (w == GFS && !Is2D()) continue;
+    gate_weights_[w].CopyWeights(lstm->gate_weights_[w]);
+  }
+  if (softmax_ != NULL) softmax_->CopyWeights(*lstm->softmax_);
+}
+
 // Prints the weights for debug purposes.
 void LSTM::PrintW() {
   tprintf("Weight state:%s\n", name_.string());
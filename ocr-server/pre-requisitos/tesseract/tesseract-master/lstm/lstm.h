@@ -111,6 +111,14 @@ class LSTM : public Network {
   // *changed.
   virtual void CountAlternators(const Network& other, double* same,
                                 double* changed) const;
+  // Zeroes the weight deltas, leaving any momentum intact.
+  void ZeroDeltas() override;
+  // Adds the weight deltas of other, which must be an identical network.
+  void AddDeltas(const Network& other) override;
+  // Multiplies the weight deltas by factor.
+  void ScaleDeltas(double factor) override;
+  // Copies the weights of src, which must be an identical network.
+  void CopyWeights(const Network& src) override;
   // Prints the weights for debug purposes.
   void PrintW();
   // Prints the weight deltas for debug purposes.
@@ -124,6 +132,13 @@ class LSTM : public Network {
  private:
   // Resizes forward data to cope with an input image of the given width.
   void ResizeForward(const NetworkIO& input);
+  // Runs the forward pass of a 1-D LSTM on an int-mode input, keeping the gates
+  // and state in fixed point, using table lookups for the non-linearities, and
+  // passing the outputs on as int8. The gate pre-activations still come from
+  // the weight matrices as double, and are only quantized to index the tables.
+  // Only usable when not training, as nothing is saved for backprop.
+  void ForwardInt(const NetworkIO& input, NetworkScratch* scratch,
+                  NetworkIO* output);
 
  private:
   // Size of padded input to weight matrices = ni_ + no_ for 1-D operation
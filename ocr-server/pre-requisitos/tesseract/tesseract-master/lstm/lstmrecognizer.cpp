@@ -60,6 +60,7 @@ LSTMRecognizer::LSTMRecognizer()
       adam_beta_(0.0f),
       dict_(NULL),
       search_(NULL),
+      blank_run_compression_(0),
       debug_win_(NULL) {}
 
 LSTMRecognizer::~LSTMRecognizer() {
@@ -190,6 +191,36 @@ void LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
   if (!RecognizeLine(image_data, invert, debug, false, false, &scale_factor,
                      &inputs, &outputs))
     return;
+  DecodeLineToWords(outputs, scale_factor, debug, worst_dict_cert, line_box,
+                    words);
+}
+
+// As above, but the line image is given directly as a Pix, which avoids
+// encoding and decoding it as an ImageData.
+void LSTMRecognizer::RecognizeLine(const Pix* line_pix, bool invert,
+                                   bool debug, double worst_dict_cert,
+                                   const TBOX& line_box,
+                                   PointerVector<WERD_RES>* words) {
+  NetworkIO outputs;
+  float scale_factor;
+  NetworkIO inputs;
+  SetRandomSeed();
+  Pix* pix = Input::PrepareLSTMInputs(line_pix, network_,
+                                      network_->XScaleFactor(), &randomizer_,
+                                      &scale_factor);
+  if (!RecognizeScaledLine(pix, invert, debug, false, false, &scale_factor,
+                           &inputs, &outputs))
+    return;
+  DecodeLineToWords(outputs, scale_factor, debug, worst_dict_cert, line_box,
+                    words);
+}
+
+// Decodes the outputs of a line to the words, using the beam search.
+void LSTMRecognizer::DecodeLineToWords(const NetworkIO& outputs,
+                                       float scale_factor, bool debug,
+                                       double worst_dict_cert,
+                                       const TBOX& line_box,
+                                       PointerVector<WERD_RES>* words) {
   if (search_ == NULL) {
     search_ =
         new RecodeBeamSearch(recoder_, null_char_, SimpleTextOutput(), dict_);
@@ -230,13 +261,25 @@ bool LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
                                    bool debug, bool re_invert, bool upside_down,
                                    float* scale_factor, NetworkIO* inputs,
                                    NetworkIO* outputs) {
-  // Maximum width of image to train on.
-  const int kMaxImageWidth = 2560;
   // This ensures consistent recognition results.
   SetRandomSeed();
+  Pix* pix = Input::PrepareLSTMInputs(image_data, network_,
+                                      network_->XScaleFactor(), &randomizer_,
+                                      scale_factor);
+  return RecognizeScaledLine(pix, invert, debug, re_invert, upside_down,
+                             scale_factor, inputs, outputs);
+}
+
+// Runs the network on the given pix, already scaled to the network input
+// height by scale_factor, taking ownership of the pix.
+bool LSTMRecognizer::RecognizeScaledLine(Pix* pix, bool invert, bool debug,
+                                         bool re_invert, bool upside_down,
+                                         float* scale_factor,
+                                         NetworkIO* inputs,
+                                         NetworkIO* outputs) {
+  // Maximum width of image to train on.
+  const int kMaxImageWidth = 2560;
   int min_width = network_->XScaleFactor();
-  Pix* pix = Input::PrepareLSTMInputs(image_data, network_, min_width,
-                                      &randomizer_, scale_factor);
   if (pix == NULL) {
     tprintf("Line cannot be recognized!!\n");
     return false;
@@ -250,6 +293,19 @@ bool LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
   if (upside_down) pixRotate180(pix, pix);
   // Reduction factor from image to coords.
   *scale_factor = min_width / *scale_factor;
+  // Shorten long blank runs, keeping a separator of one line height, so the
+  // recurrent layers only see the inked parts of sparse lines.
+  std::vector<std::pair<int, int>> blank_gaps;
+  if (blank_run_compression_ > 0 && !network_->IsTraining()) {
+    int line_height = pixGetHeight(pix);
+    Pix* compressed_pix = Input::CompressBlankRuns(
+        pix, blank_run_compression_ * line_height, line_height, min_width,
+        &blank_gaps);
+    if (compressed_pix != nullptr) {
+      pixDestroy(&pix);
+      pix = compressed_pix;
+    }
+  }
   inputs->set_int_mode(IsIntMode());
   SetRandomSeed();
   Input::PreparePixInput(network_->InputShape(), pix, &randomizer_, inputs);
@@ -290,6 +346,11 @@ bool LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
     DisplayForward(*inputs, labels, coords, "LSTMForward", &debug_win_);
     DebugActivationPath(*outputs, labels, coords);
   }
+  if (!blank_gaps.empty()) {
+    // Map the outputs back to the coordinates of the uncompressed image.
+    NetworkIO compressed_outputs(*outputs);
+    outputs->CopyWithXExpansion(compressed_outputs, blank_gaps);
+  }
   return true;
 }
 
@@ -81,6 +81,8 @@ class LSTMRecognizer {
   }
   // Returns true if the network is a TensorFlow network.
   bool IsTensorFlow() const { return network_->type() == NT_TENSORFLOW; }
+  // Returns true if the network takes color input.
+  bool IsColorInput() const { return network_->InputShape().depth() == 3; }
   // Returns a vector of layer ids that can be passed to other layer functions
   // to access a specific layer.
   GenericVector<STRING> EnumerateLayers() const {
@@ -152,6 +154,11 @@ class LSTMRecognizer {
     return network_->NumInputs();
   }
   int null_char() const { return null_char_; }
+  // Sets the min length, in multiples of the line height, of a run of blank
+  // columns that will be shortened before recognition. 0 disables it.
+  void set_blank_run_compression(int min_run_heights) {
+    blank_run_compression_ = min_run_heights;
+  }
 
   // Loads a model from mgr, including the dictionary only if lang is not null.
   bool Load(const char* lang, TessdataManager* mgr);
@@ -185,6 +192,11 @@ class LSTMRecognizer {
   void RecognizeLine(const ImageData& image_data, bool invert, bool debug,
                      double worst_dict_cert, const TBOX& line_box,
                      PointerVector<WERD_RES>* words);
+  // As above, but the line image is given directly as a Pix, which avoids
+  // encoding and decoding it as an ImageData.
+  void RecognizeLine(const Pix* line_pix, bool invert, bool debug,
+                     double worst_dict_cert, const TBOX& line_box,
+                     PointerVector<WERD_RES>* words);
 
   // Helper computes min and mean best results in the output.
   void OutputStats(const NetworkIO& outputs,
@@ -221,6 +233,17 @@ class LSTMRecognizer {
                          GenericVector<int>* xcoords);
 
  protected:
+  // Runs the network on the given pix, already scaled to the network input
+  // height by scale_factor, taking ownership of the pix. Otherwise as the
+  // ImageData version of RecognizeLine above.
+  bool RecognizeScaledLine(Pix* pix, bool invert, bool debug, bool re_invert,
+                           bool upside_down, float* scale_factor,
+                           NetworkIO* inputs, NetworkIO* outputs);
+  // Decodes the outputs of a line to the words, using the beam search.
+  void DecodeLineToWords(const NetworkIO& outputs, float scale_factor,
+                         bool debug, double worst_dict_cert,
+                         const TBOX& line_box, PointerVector<WERD_RES>* words);
+
   // Sets the random seed from the sample_iteration_;
   void SetRandomSeed() {
     inT64 seed = static_cast<inT64>(sample_iteration_) * 0x10000001;
@@ -301,6 +324,9 @@ class LSTMRecognizer {
   Dict* dict_;
   // Beam search held between uses to optimize memory allocation/use.
   RecodeBeamSearch* search_;
+  // Min length, in line heights, of blank column runs to shorten before
+  // running the network, or 0 to disable. Ignored when training.
+  int blank_run_compression_;
 
   // == Debugging parameters.==
   // Recognition debug display window.
@@ -482,6 +482,8 @@ bool LSTMTrainer::Serialize(SerializeAmount serialize_amount,
 // NOTE: It is assumed that the trainer is never read cross-endian.
 bool LSTMTrainer::DeSerialize(const TessdataManager* mgr, TFile* fp) {
   if (!LSTMRecognizer::DeSerialize(mgr, fp)) return false;
+  // network_ is new, so any replicas are out of date.
+  replicas_stale_ = true;
   if (fp->FRead(&learning_iteration_, sizeof(learning_iteration_), 1) != 1) {
     // Special case. If we successfully decoded the recognizer, but fail here
     // then it means we were just given a recognizer, so issue a warning and
@@ -794,6 +796,31 @@ bool LSTMTrainer::EncodeString(const STRING& str, const UNICHARSET& unicharset,
 // Returns a Trainability enum to indicate the suitability of the sample.
 Trainability LSTMTrainer::TrainOnLine(const ImageData* trainingdata,
                                       bool batch) {
+  bool backprop = false;
+  Trainability trainable = ComputeLineDeltas(trainingdata, &backprop);
+  if (trainable == UNENCODABLE || trainable == NOT_BOXED) {
+    return trainable;  // Sample was unusable.
+  }
+  if (backprop) {
+    network_->Update(learning_rate_, batch ? -1.0f : momentum_, adam_beta_,
+                     training_iteration_ + 1);
+  }
+#ifndef GRAPHICS_DISABLED
+  if (debug_interval_ == 1 && debug_win_ != NULL) {
+    delete debug_win_->AwaitEvent(SVET_CLICK);
+  }
+#endif  // GRAPHICS_DISABLED
+  // Roll the memory of past means.
+  RollErrorBuffers();
+  return trainable;
+}
+
+// As TrainOnLine, but only runs forward-backward, leaving the weight deltas
+// in the network for the caller to apply. *backprop is set to true iff
+// backward was run, so the deltas are valid.
+Trainability LSTMTrainer::ComputeLineDeltas(const ImageData* trainingdata,
+                                            bool* backprop) {
+  *backprop = false;
   NetworkIO fwd_outputs, targets;
   Trainability trainable =
       PrepareForBackward(trainingdata, &fwd_outputs, &targets);
@@ -810,19 +837,112 @@ Trainability LSTMTrainer::TrainOnLine(const ImageData* trainingdata,
        training_iteration() >
            last_perfect_training_iteration_ + perfect_delay_)) {
     network_->Backward(debug, targets, &scratch_space_, &bp_deltas);
-    network_->Update(learning_rate_, batch ? -1.0f : momentum_, adam_beta_,
-                     training_iteration_ + 1);
-  }
-#ifndef GRAPHICS_DISABLED
-  if (debug_interval_ == 1 && debug_win_ != NULL) {
-    delete debug_win_->AwaitEvent(SVET_CLICK);
+    *backprop = true;
   }
-#endif  // GRAPHICS_DISABLED
-  // Roll the memory of past means.
-  RollErrorBuffers();
   return trainable;
 }
 
+// Sets up num_replicas copies of *this for data-parallel training, instead
+// of LoadAllTrainingData. Each loads its own shard (every num_replicas'th
+// file) of filenames, using an equal share of max_memory, and *this loads
+// nothing. Returns false if any shard fails to load.
+bool LSTMTrainer::InitReplicas(int num_replicas,
+                               const GenericVector<STRING>& filenames,
+                               CachingStrategy cache_strategy,
+                               bool randomly_rotate, inT64 max_memory) {
+  randomly_rotate_ = randomly_rotate;
+  training_data_.Clear();
+  replicas_.clear();
+  if (num_replicas > filenames.size()) num_replicas = filenames.size();
+  for (int r = 0; r < num_replicas; ++r) {
+    LSTMTrainer* replica =
+        new LSTMTrainer(file_reader_, file_writer_, NULL, NULL,
+                        model_base_.string(), checkpoint_name_.string(), 0,
+                        max_memory / num_replicas);
+    replicas_.push_back(replica);
+    GenericVector<STRING> shard;
+    for (int f = r; f < filenames.size(); f += num_replicas)
+      shard.push_back(filenames[f]);
+    if (!replica->LoadAllTrainingData(shard, cache_strategy, randomly_rotate))
+      return false;
+  }
+  return !replicas_.empty() && SyncReplicas();
+}
+
+// Gives each replica a fresh copy of the network and training state of
+// *this, keeping its training data. Returns false on failure.
+bool LSTMTrainer::SyncReplicas() {
+  GenericVector<char> trainer_data;
+  if (!SaveTrainingDump(LIGHT, this, &trainer_data)) return false;
+  for (int r = 0; r < replicas_.size(); ++r) {
+    if (!ReadTrainingDump(trainer_data, replicas_[r])) return false;
+    replicas_[r]->set_perfect_delay(perfect_delay_);
+  }
+  replicas_stale_ = false;
+  return true;
+}
+
+// Trains the next replicas_.size() samples in parallel, one per replica,
+// averages their weight deltas into *this, updates the weights and copies
+// them back to the replicas. Returns the number of usable samples.
+int LSTMTrainer::TrainOnLinesParallel() {
+  // A checkpoint revert or a sub_trainer_ win replaces network_.
+  if (replicas_stale_) {
+    bool synced = SyncReplicas();
+    ASSERT_HOST(synced);
+  }
+  int num_replicas = replicas_.size();
+  GenericVector<Trainability> trainable;
+  trainable.init_to_size(num_replicas, UNENCODABLE);
+  GenericVector<bool> backprop;
+  backprop.init_to_size(num_replicas, false);
+  // Samples serial..serial + num_replicas - 1 each come from a different
+  // shard, so no DocumentCache is used by more than one thread.
+  int serial = sample_iteration_;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_replicas)
+#endif
+  for (int r = 0; r < num_replicas; ++r) {
+    const ImageData* trainingdata = GetSampleBySerial(serial + r);
+    if (trainingdata == NULL) continue;
+    LSTMTrainer* replica = replicas_[r];
+    bool replica_backprop = false;
+    trainable[r] = replica->ComputeLineDeltas(trainingdata, &replica_backprop);
+    backprop[r] = replica_backprop;
+    if (trainable[r] != UNENCODABLE && trainable[r] != NOT_BOXED)
+      replica->RollErrorBuffers();
+  }
+  // Record the samples in order, as if they had been trained sequentially,
+  // and sum the deltas.
+  int num_used = 0;
+  int num_backprop = 0;
+  network_->ZeroDeltas();
+  for (int r = 0; r < num_replicas; ++r) {
+    ++sample_iteration_;
+    if (trainable[r] == UNENCODABLE || trainable[r] == NOT_BOXED) continue;
+    const LSTMTrainer* replica = replicas_[r];
+    for (int type = 0; type < ET_COUNT; ++type) {
+      ErrorTypes error_type = static_cast<ErrorTypes>(type);
+      UpdateErrorBuffer(replica->LastSingleError(error_type), error_type);
+    }
+    RollErrorBuffers();
+    ++num_used;
+    if (backprop[r]) {
+      network_->AddDeltas(*replica->network_);
+      ++num_backprop;
+    }
+  }
+  if (num_backprop > 0) {
+    // Average, so the step is that of a single sample at learning_rate_.
+    if (num_backprop > 1) network_->ScaleDeltas(1.0 / num_backprop);
+    network_->Update(learning_rate_, momentum_, adam_beta_,
+                     training_iteration_);
+    for (int r = 0; r < num_replicas; ++r)
+      replicas_[r]->network_->CopyWeights(*network_);
+  }
+  return num_used;
+}
+
 // Prepares the ground truth, runs forward, and prepares the targets.
 // Returns a Trainability enum to indicate the suitability of the sample.
 Trainability LSTMTrainer::PrepareForBackward(const ImageData* trainingdata,
@@ -1049,6 +1169,7 @@ void LSTMTrainer::EmptyConstructor() {
   checkpoint_iteration_ = 0;
   training_stage_ = 0;
   num_training_stages_ = 2;
+  replicas_stale_ = true;
   InitIterations();
 }
 
@@ -258,8 +258,7 @@ class LSTMTrainer : public LSTMRecognizer {
   // holds the training samples.
   const ImageData* TrainOnLine(LSTMTrainer* samples_trainer, bool batch) {
     int sample_index = sample_iteration();
-    const ImageData* image =
-        samples_trainer->training_data_.GetPageBySerial(sample_index);
+    const ImageData* image = samples_trainer->GetSampleBySerial(sample_index);
     if (image != NULL) {
       Trainability trainable = TrainOnLine(image, batch);
       if (trainable == UNENCODABLE || trainable == NOT_BOXED) {
@@ -271,6 +270,35 @@ class LSTMTrainer : public LSTMRecognizer {
     return image;
   }
   Trainability TrainOnLine(const ImageData* trainingdata, bool batch);
+  // As TrainOnLine, but only runs forward-backward, leaving the weight deltas
+  // in the network for the caller to apply. *backprop is set to true iff
+  // backward was run, so the deltas are valid.
+  Trainability ComputeLineDeltas(const ImageData* trainingdata,
+                                 bool* backprop);
+
+  // Returns the training sample with the given serial number. With replicas,
+  // *this holds no training data of its own and the samples are dealt out
+  // over the shards, so serial s is page s / n of the shard of replica s % n.
+  const ImageData* GetSampleBySerial(int serial) {
+    if (replicas_.empty()) return training_data_.GetPageBySerial(serial);
+    int num_replicas = replicas_.size();
+    return replicas_[serial % num_replicas]->training_data_.GetPageBySerial(
+        serial / num_replicas);
+  }
+
+  // Sets up num_replicas copies of *this for data-parallel training, instead
+  // of LoadAllTrainingData. Each loads its own shard (every num_replicas'th
+  // file) of filenames, using an equal share of max_memory, and *this loads
+  // nothing. Returns false if any shard fails to load.
+  bool InitReplicas(int num_replicas, const GenericVector<STRING>& filenames,
+                    CachingStrategy cache_strategy, bool randomly_rotate,
+                    inT64 max_memory);
+  // Trains the next replicas_.size() samples in parallel, one per replica,
+  // averages their weight deltas into *this, updates the weights and copies
+  // them back to the replicas. The result is a synchronous batch, which is
+  // recorded in the error buffers of *this as if the samples had been
+  // trained one after the other. Returns the number of usable samples.
+  int TrainOnLinesParallel();
 
   // Prepares the ground truth, runs forward, and prepares the targets.
   // Returns a Trainability enum to indicate the suitability of the sample.
@@ -331,6 +359,10 @@ class LSTMTrainer : public LSTMRecognizer {
   // Factored sub-constructor sets up reasonable default values.
   void EmptyConstructor();
 
+  // Gives each replica a fresh copy of the network and training state of
+  // *this, keeping its training data. Returns false on failure.
+  bool SyncReplicas();
+
   // Outputs the string and periodically displays the given network inputs
   // as an image in the given window, and the corresponding labels at the
   // corresponding x_starts.
@@ -448,6 +480,12 @@ class LSTMTrainer : public LSTMRecognizer {
   // A subsidiary trainer running with a different learning rate until either
   // *this or sub_trainer_ hits a new best.
   LSTMTrainer* sub_trainer_;
+  // Copies of *this, each with its own shard of the training data, that run
+  // forward-backward in parallel for TrainOnLinesParallel. Not serialized.
+  PointerVector<LSTMTrainer> replicas_;
+  // True when network_ has been replaced (by DeSerialize) since the replicas
+  // were last given a copy of *this.
+  bool replicas_stale_;
   // Error rate at which last best model was dumped.
   float error_rate_of_last_saved_best_;
   // Current stage of training.
@@ -235,6 +235,16 @@ class Network {
   // *changed.
   virtual void CountAlternators(const Network& other, double* same,
                                 double* changed) const {}
+  // Zeroes the weight deltas, leaving any momentum intact.
+  virtual void ZeroDeltas() {}
+  // Adds the weight deltas of other, which must be an identical network, to
+  // those of *this. Used to sum the deltas of data-parallel replicas.
+  virtual void AddDeltas(const Network& other) {}
+  // Multiplies the weight deltas by factor, eg to average summed deltas.
+  virtual void ScaleDeltas(double factor) {}
+  // Copies the weights of src, which must be an identical network, to *this,
+  // without touching the deltas or momentum.
+  virtual void CopyWeights(const Network& src) {}
 
   // Reads from the given file. Returns NULL in case of error.
   // Determines the type of the serialized class and calls its DeSerialize
@@ -669,6 +669,13 @@ void NetworkIO::WriteTimeStepPart(int t, int offset, int num_features,
   }
 }
 
+// As WriteTimeStepPart, but from int8 values already scaled by MAX_INT8.
+void NetworkIO::WriteTimeStepPart(int t, int offset, int num_features,
+                                  const inT8* input) {
+  ASSERT_HOST(int_mode_);
+  memcpy(i_[t] + offset, input, num_features * sizeof(i_[0][0]));
+}
+
 // Maxpools a single time step from src.
 void NetworkIO::MaxpoolTimeStep(int dest_t, const NetworkIO& src, int src_t,
                                 int* max_line) {
@@ -916,6 +923,30 @@ void NetworkIO::CopyWithXYTranspose(const NetworkIO& src) {
            dest_b_index.AddOffset(1, FD_BATCH));
 }
 
+// Copies the 1-d src to *this, undoing a compression of the x dimension:
+// for each (t, n) pair in gaps (in increasing order of t, in the timesteps
+// of src), n copies of the last timestep before t are inserted before t.
+void NetworkIO::CopyWithXExpansion(
+    const NetworkIO& src, const std::vector<std::pair<int, int>>& gaps) {
+  ASSERT_HOST(src.stride_map_.Size(FD_BATCH) <= 1 &&
+              src.stride_map_.Size(FD_HEIGHT) <= 1);
+  int src_width = src.Width();
+  int width = src_width;
+  for (const auto& gap : gaps) width += gap.second;
+  StrideMap stride_map;
+  stride_map.SetStride(std::vector<std::pair<int, int>>(1, {1, width}));
+  ResizeToMap(src.int_mode(), stride_map, src.NumFeatures());
+  int t = 0;
+  int src_t = 0;
+  for (const auto& gap : gaps) {
+    int gap_t = ClipToRange(gap.first, 0, src_width);
+    for (; src_t < gap_t; ++src_t) CopyTimeStepFrom(t++, src, src_t);
+    int fill_t = MAX(src_t - 1, 0);
+    for (int i = 0; i < gap.second; ++i) CopyTimeStepFrom(t++, src, fill_t);
+  }
+  for (; src_t < src_width; ++src_t) CopyTimeStepFrom(t++, src, src_t);
+}
+
 // Copies src to *this, at the given feature_offset, returning the total
 // feature offset after the copy. Multiple calls will stack outputs from
 // multiple sources in feature space.
@@ -203,6 +203,10 @@ class NetworkIO {
   // num_features elements of input to (*this)[t], starting at offset.
   void WriteTimeStepPart(int t, int offset, int num_features,
                          const double* input);
+  // As WriteTimeStepPart, but from int8 values already scaled by MAX_INT8.
+  // Only valid in int mode.
+  void WriteTimeStepPart(int t, int offset, int num_features,
+                         const inT8* input);
   // Maxpools a single time step from src.
   void MaxpoolTimeStep(int dest_t, const NetworkIO& src, int src_t,
                        int* max_line);
@@ -238,6 +242,11 @@ class NetworkIO {
   void CopyWithXReversal(const NetworkIO& src);
   // Copies src to *this with independent transpose of the x and y dimensions.
   void CopyWithXYTranspose(const NetworkIO& src);
+  // Copies the 1-d src to *this, undoing a compression of the x dimension:
+  // for each (t, n) pair in gaps (in increasing order of t, in the timesteps
+  // of src), n copies of the last timestep before t are inserted before t.
+  void CopyWithXExpansion(const NetworkIO& src,
+                          const std::vector<std::pair<int, int>>& gaps);
   // Copies src to *this, at the given feature_offset, returning the total
   // feature offset after the copy. Multiple calls will stack outputs from
   // multiple sources in feature space.
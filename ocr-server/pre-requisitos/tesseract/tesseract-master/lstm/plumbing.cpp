@@ -243,5 +243,40 @@ void Plumbing::CountAlternators(const Network& other, double* same,
     stack_[i]->CountAlternators(*plumbing->stack_[i], same, changed);
 }
 
+// Zeroes the weight deltas, leaving any momentum intact.
+void Plumbing::ZeroDeltas() {
+  for (int i = 0; i < stack_.size(); ++i) {
+    if (stack_[i]->IsTraining()) stack_[i]->ZeroDeltas();
+  }
+}
+
+// Adds the weight deltas of other, which must be an identical network.
+void Plumbing::AddDeltas(const Network& other) {
+  ASSERT_HOST(other.type() == type_);
+  const Plumbing* plumbing = static_cast<const Plumbing*>(&other);
+  ASSERT_HOST(plumbing->stack_.size() == stack_.size());
+  for (int i = 0; i < stack_.size(); ++i) {
+    if (stack_[i]->IsTraining()) stack_[i]->AddDeltas(*plumbing->stack_[i]);
+  }
+}
+
+// Multiplies the weight deltas by factor.
+void Plumbing::ScaleDeltas(double factor) {
+  for (int i = 0; i < stack_.size(); ++i) {
+    if (stack_[i]->IsTraining()) stack_[i]->ScaleDeltas(factor);
+  }
+}
+
+// Copies the weights of src, which must be an identical network. Layers that
+// are not training never change, so they are skipped.
+void Plumbing::CopyWeights(const Network& src) {
+  ASSERT_HOST(src.type() == type_);
+  const Plumbing* plumbing = static_cast<const Plumbing*>(&src);
+  ASSERT_HOST(plumbing->stack_.size() == stack_.size());
+  for (int i = 0; i < stack_.size(); ++i) {
+    if (stack_[i]->IsTraining()) stack_[i]->CopyWeights(*plumbing->stack_[i]);
+  }
+}
+
 }  // namespace tesseract.
 
@@ -303,6 +303,15 @@ void WeightMatrix::AddDeltas(const WeightMatrix& other) {
   dw_ += other.dw_;
 }
 
+// Copies the float weights of other to *this, leaving dw_ and updates_.
+void WeightMatrix::CopyWeights(const WeightMatrix& other) {
+  ASSERT_HOST(!int_mode_ && !other.int_mode_);
+  ASSERT_HOST(wf_.dim1() == other.wf_.dim1());
+  ASSERT_HOST(wf_.dim2() == other.wf_.dim2());
+  wf_ = other.wf_;
+  wf_t_ = other.wf_t_;
+}
+
 // Sums the products of weight updates in *this and other, splitting into
 // positive (same direction) in *same and negative (different direction) in
 // *changed.
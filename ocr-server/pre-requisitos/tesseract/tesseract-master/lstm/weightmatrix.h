@@ -141,8 +141,14 @@ class WeightMatrix {
   // num_samples is used in the Adam correction factor.
   void Update(double learning_rate, double momentum, double adam_beta,
               int num_samples);
+  // Zeroes dw_, leaving the momentum in updates_ untouched.
+  void ZeroDeltas() { dw_.Clear(); }
   // Adds the dw_ in other to the dw_ is *this.
   void AddDeltas(const WeightMatrix& other);
+  // Multiplies dw_ by factor.
+  void ScaleDeltas(double factor) { dw_ *= factor; }
+  // Copies the float weights of other to *this, leaving dw_ and updates_.
+  void CopyWeights(const WeightMatrix& other);
   // Sums the products of weight updates in *this and other, splitting into
   // positive (same direction) in *same and negative (different direction) in
   // *changed.
@@ -50,6 +50,9 @@ BOOL_PARAM_FLAG(convert_to_int, false,
                 "Convert the recognition model to an integer model.");
 BOOL_PARAM_FLAG(sequential_training, false,
                 "Use the training files sequentially instead of round-robin.");
+BOOL_PARAM_FLAG(streaming_training, false,
+                "Read training samples on demand in an order shuffled across"
+                " all the training files, using at most max_image_MB.");
 INT_PARAM_FLAG(append_index, -1, "Index in continue_from Network at which to"
                " attach the new network defined by net_spec");
 BOOL_PARAM_FLAG(debug_network, false,
@@ -62,6 +65,10 @@ STRING_PARAM_FLAG(old_traineddata, "",
                   " character set that is to be replaced");
 BOOL_PARAM_FLAG(randomly_rotate, false,
                 "Train OSD and randomly turn training samples upside-down");
+INT_PARAM_FLAG(num_replicas, 1, "Number of network replicas to train in"
+               " parallel, each on its own shard of the training files and"
+               " max_image_MB. Their deltas are averaged, so the step per"
+               " batch is that of one sample at the set learning rate");
 
 // Number of training images to train between calls to MaintainCheckpoints.
 const int kNumPagesPerBatch = 100;
@@ -169,11 +176,23 @@ int main(int argc, char **argv) {
       trainer.set_perfect_delay(FLAGS_perfect_sample_delay);
     }
   }
-  if (!trainer.LoadAllTrainingData(filenames,
-                                   FLAGS_sequential_training
-                                       ? tesseract::CS_SEQUENTIAL
-                                       : tesseract::CS_ROUND_ROBIN,
-                                   FLAGS_randomly_rotate)) {
+  tesseract::CachingStrategy cache_strategy = tesseract::CS_ROUND_ROBIN;
+  if (FLAGS_streaming_training)
+    cache_strategy = tesseract::CS_STREAMING;
+  else if (FLAGS_sequential_training)
+    cache_strategy = tesseract::CS_SEQUENTIAL;
+  if (FLAGS_num_replicas > 1) {
+    // The replicas hold all the training data between them.
+    if (!trainer.InitReplicas(FLAGS_num_replicas, filenames, cache_strategy,
+                              FLAGS_randomly_rotate,
+                              static_cast<inT64>(FLAGS_max_image_MB) *
+                                  1048576)) {
+      tprintf("Failed to set up %d training replicas!!\n",
+              static_cast<int>(FLAGS_num_replicas));
+      return 1;
+    }
+  } else if (!trainer.LoadAllTrainingData(filenames, cache_strategy,
+                                          FLAGS_randomly_rotate)) {
     tprintf("Load of images failed!!\n");
     return 1;
   }
@@ -196,7 +215,10 @@ int main(int argc, char **argv) {
     for (int target_iteration = iteration + kNumPagesPerBatch;
          iteration < target_iteration;
          iteration = trainer.training_iteration()) {
-      trainer.TrainOnLine(&trainer, false);
+      if (FLAGS_num_replicas > 1)
+        trainer.TrainOnLinesParallel();
+      else
+        trainer.TrainOnLine(&trainer, false);
     }
     STRING log_str;
     trainer.MaintainCheckpoints(tester_callback, &log_str);
@@ -0,0 +1,147 @@
+///////////////////////////////////////////////////////////////////////
+// File:        imagedata_test.cc
+// Description: Tests the CS_STREAMING strategy of DocumentCache, which reads
+//              the pages of .lstmf files on demand within a memory budget.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+#include "allheaders.h"
+#include "imagedata.h"
+#include "include_gunit.h"
+#include "serialis.h"
+
+namespace tesseract {
+namespace {
+
+// Number of documents written, and pages in the first of them. Each next
+// document has one more page.
+const int kNumDocs = 3;
+const int kNumPagesFirstDoc = 5;
+// Total number of pages in the documents.
+const int kTotalPages = kNumDocs * kNumPagesFirstDoc +
+                        kNumDocs * (kNumDocs - 1) / 2;
+// A memory budget smaller than any page, so only the page just read and the
+// page last returned are kept.
+const inT64 kTinyMemory = 1;
+
+class ImagedataTest : public ::testing::Test {
+ protected:
+  // Writes the documents. Each page is tagged with its document and page
+  // number in its language, and has an image of a width unique to it.
+  void SetUp() override {
+    for (int d = 0; d < kNumDocs; ++d) {
+      DocumentData doc("imagedata_test");
+      for (int p = 0; p < kNumPagesFirstDoc + d; ++p) {
+        ImageData* page = new ImageData(false, pixCreate(PageWidth(d, p), 8, 8));
+        page->set_language(PageTag(d, p).c_str());
+        doc.AddPageToDocument(page);
+      }
+      char filename[64];
+      snprintf(filename, sizeof(filename), "imagedata_test_%d.lstmf", d);
+      ASSERT_TRUE(doc.SaveDocument(filename, NULL));
+      filenames_.push_back(STRING(filename));
+    }
+  }
+  void TearDown() override {
+    for (int d = 0; d < filenames_.size(); ++d)
+      remove(filenames_[d].string());
+  }
+
+  static int PageWidth(int doc, int page) { return 10 + 10 * doc + page; }
+  static std::string PageTag(int doc, int page) {
+    char tag[16];
+    snprintf(tag, sizeof(tag), "d%dp%d", doc, page);
+    return tag;
+  }
+
+  // Reads num_serials pages in serial order with the given memory budget and
+  // reader, and returns their tags. Fails unless each page has the image it
+  // was written with.
+  std::vector<std::string> ReadPages(inT64 max_memory, FileReader reader,
+                                     int num_serials) {
+    std::vector<std::string> tags;
+    DocumentCache cache(max_memory);
+    EXPECT_TRUE(cache.LoadDocuments(filenames_, CS_STREAMING, reader));
+    EXPECT_EQ(kTotalPages, cache.TotalPages());
+    for (int serial = 0; serial < num_serials; ++serial) {
+      const ImageData* page = cache.GetPageBySerial(serial);
+      EXPECT_TRUE(page != NULL);
+      if (page == NULL) break;
+      std::string tag = page->language().string();
+      int doc, page_number;
+      EXPECT_EQ(2, sscanf(tag.c_str(), "d%dp%d", &doc, &page_number)) << tag;
+      Pix* pix = page->GetPix();
+      EXPECT_TRUE(pix != NULL);
+      if (pix != NULL) {
+        EXPECT_EQ(PageWidth(doc, page_number), pixGetWidth(pix)) << tag;
+        pixDestroy(&pix);
+      }
+      tags.push_back(tag);
+    }
+    return tags;
+  }
+
+  // Checks that each epoch of tags has every page exactly once.
+  void ExpectEpochsArePermutations(const std::vector<std::string>& tags) {
+    for (int start = 0; start + kTotalPages <= static_cast<int>(tags.size());
+         start += kTotalPages) {
+      std::set<std::string> epoch(tags.begin() + start,
+                                  tags.begin() + start + kTotalPages);
+      EXPECT_EQ(kTotalPages, epoch.size()) << "epoch from " << start;
+      for (int d = 0; d < kNumDocs; ++d) {
+        for (int p = 0; p < kNumPagesFirstDoc + d; ++p)
+          EXPECT_EQ(1, epoch.count(PageTag(d, p)));
+      }
+    }
+  }
+
+  GenericVector<STRING> filenames_;
+};
+
+// Pages read with a tiny budget, so nearly every page is read again from the
+// file by GetPageStreaming or the prefetch threads, come in the same order
+// and with the same content as with a budget that keeps them all.
+TEST_F(ImagedataTest, StreamingTinyMemory) {
+  const int kNumSerials = 3 * kTotalPages;
+  std::vector<std::string> all_kept = ReadPages(0, NULL, kNumSerials);
+  ASSERT_EQ(kNumSerials, all_kept.size());
+  ExpectEpochsArePermutations(all_kept);
+  std::vector<std::string> tiny = ReadPages(kTinyMemory, NULL, kNumSerials);
+  EXPECT_EQ(all_kept, tiny);
+}
+
+// Documents read through a FileReader are kept in memory and the pages are
+// deserialized from there, in the same order.
+TEST_F(ImagedataTest, StreamingWithReader) {
+  const int kNumSerials = 2 * kTotalPages;
+  std::vector<std::string> seeking = ReadPages(kTinyMemory, NULL, kNumSerials);
+  std::vector<std::string> reader = ReadPages(
+      kTinyMemory, static_cast<FileReader>(LoadDataFromFile), kNumSerials);
+  ASSERT_EQ(kNumSerials, reader.size());
+  EXPECT_EQ(seeking, reader);
+}
+
+// Epochs have different orders.
+TEST_F(ImagedataTest, StreamingShufflesEachEpoch) {
+  std::vector<std::string> tags = ReadPages(kTinyMemory, NULL, 2 * kTotalPages);
+  ASSERT_EQ(2 * kTotalPages, tags.size());
+  EXPECT_FALSE(std::equal(tags.begin(), tags.begin() + kTotalPages,
+                          tags.begin() + kTotalPages));
+}
+
+}  // namespace
+}  // namespace tesseract
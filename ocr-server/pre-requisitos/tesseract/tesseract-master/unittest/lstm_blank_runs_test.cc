@@ -0,0 +1,311 @@
+///////////////////////////////////////////////////////////////////////
+// File:        lstm_blank_runs_test.cc
+// Description: Tests the shortening of long blank column runs before LSTM
+//              recognition, and the mapping of the outputs back to the
+//              columns of the original line image.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include <utility>
+#include <vector>
+#include "allheaders.h"
+#include "helpers.h"
+#include "imagedata.h"
+#include "include_gunit.h"
+#include "input.h"
+#include "lstmrecognizer.h"
+#include "lstmtrainer.h"
+#include "networkio.h"
+#include "pageres.h"
+#include "serialis.h"
+#include "unicharcompress.h"
+#include "unicharset.h"
+
+namespace tesseract {
+namespace {
+
+// Height of the test line images, and of the network input, to which the
+// line images are scaled.
+const int kLineHeight = 32;
+const int kNetworkHeight = 16;
+// Min length of a shortened blank run, in line heights.
+const int kMinRunHeights = 2;
+// Widths of the parts of the test line, in kLineHeight pixels.
+const int kWordWidth = 80;
+const int kGapWidth = 240;
+// Baseline of the characters, and row of the underline.
+const int kBaseline = 24;
+const int kUnderline = 28;
+
+class LSTMBlankRunsTest : public ::testing::Test {
+ protected:
+  // Sets up the charsets of the test networks in mgr_.
+  void SetUp() override {
+    UNICHARSET unicharset;
+    unicharset.unichar_insert("a");
+    unicharset.unichar_insert("b");
+    GenericVector<char> unicharset_data;
+    TFile fp;
+    fp.OpenWrite(&unicharset_data);
+    ASSERT_TRUE(unicharset.save_to_file(&fp));
+    mgr_.OverwriteEntry(TESSDATA_LSTM_UNICHARSET, &unicharset_data[0],
+                        unicharset_data.size());
+    UnicharCompress recoder;
+    ASSERT_TRUE(recoder.ComputeEncoding(unicharset, UNICHAR_BROKEN, NULL));
+    GenericVector<char> recoder_data;
+    fp.OpenWrite(&recoder_data);
+    ASSERT_TRUE(recoder.Serialize(&fp));
+    mgr_.OverwriteEntry(TESSDATA_LSTM_RECODER, &recoder_data[0],
+                        recoder_data.size());
+    code_range_ = recoder.code_range();
+  }
+
+  // Returns a white 8-bit line image of the given size.
+  static Pix* BlankLine(int width, int height) {
+    Pix* pix = pixCreate(width, height, 8);
+    pixSetAll(pix);
+    return pix;
+  }
+  static void FillRect(Pix* pix, int x, int y, int width, int height) {
+    Box* box = boxCreate(x, y, width, height);
+    pixClearInRect(pix, box);
+    boxDestroy(&box);
+  }
+  // Draws a word of random character-like blobs from x, scaled to the line
+  // height, and returns the x after it.
+  int AddWord(Pix* pix, int x, int width) {
+    int scale = pixGetHeight(pix);
+    int end = x + width * scale / kLineHeight;
+    while (x < end) {
+      int blob_width = MIN(3 + random_.IntRand() % 6, end - x) * scale /
+                       kLineHeight;
+      int blob_height = (8 + random_.IntRand() % 12) * scale / kLineHeight;
+      int baseline = kBaseline * scale / kLineHeight;
+      FillRect(pix, x, baseline - blob_height, MAX(blob_width, 1), blob_height);
+      x += MAX(blob_width, 1) + 3 * scale / kLineHeight;
+    }
+    return end;
+  }
+  // Draws a dotted leader of the given width from x.
+  static void AddLeader(Pix* pix, int x, int width) {
+    int scale = pixGetHeight(pix);
+    int dot_size = MAX(3 * scale / kLineHeight, 1);
+    int spacing = 8 * scale / kLineHeight;
+    for (int dot_x = x; dot_x + dot_size <= x + width; dot_x += spacing) {
+      FillRect(pix, dot_x, kBaseline * scale / kLineHeight - dot_size,
+               dot_size, dot_size);
+    }
+  }
+  // Draws an underline of the given width from x.
+  static void AddUnderline(Pix* pix, int x, int width) {
+    int scale = pixGetHeight(pix);
+    FillRect(pix, x, kUnderline * scale / kLineHeight, width,
+             MAX(2 * scale / kLineHeight, 1));
+  }
+
+  // Returns a form line of the given height: words separated by a blank
+  // run, an underline and a dotted leader, each kGapWidth wide.
+  Pix* FormLine(int height) {
+    int gap = kGapWidth * height / kLineHeight;
+    int width = (4 * kWordWidth + 3 * kGapWidth) * height / kLineHeight;
+    Pix* pix = BlankLine(width, height);
+    int x = AddWord(pix, 0, kWordWidth);
+    x = AddWord(pix, x + gap, kWordWidth);
+    AddUnderline(pix, x, gap);
+    x = AddWord(pix, x + gap, kWordWidth);
+    AddLeader(pix, x, gap);
+    AddWord(pix, x + gap, kWordWidth);
+    return pix;
+  }
+
+  // Checks that compressed is pix with the columns given by gaps removed.
+  static void ExpectColumnsRemoved(Pix* pix, Pix* compressed,
+                                   const std::vector<std::pair<int, int>>& gaps) {
+    int height = pixGetHeight(pix);
+    ASSERT_EQ(height, pixGetHeight(compressed));
+    int width = pixGetWidth(compressed);
+    int x = 0;
+    size_t g = 0;
+    for (int c = 0; c < width; ++c) {
+      if (g < gaps.size() && gaps[g].first == c) x += gaps[g++].second;
+      for (int y = 0; y < height; ++y) {
+        l_uint32 expected, actual;
+        pixGetPixel(pix, x, y, &expected);
+        pixGetPixel(compressed, c, y, &actual);
+        ASSERT_EQ(expected, actual) << "at " << c << "," << y;
+      }
+      ++x;
+    }
+    EXPECT_EQ(gaps.size(), g);
+    EXPECT_EQ(pixGetWidth(pix), x);
+  }
+
+  // Sets up recognizer with a new random network of the given spec, which
+  // must be for an input height of kNetworkHeight.
+  void MakeRecognizer(const char* spec, LSTMRecognizer* recognizer) {
+    LSTMTrainer trainer;
+    trainer.InitCharSet(mgr_);
+    char full_spec[64];
+    snprintf(full_spec, sizeof(full_spec), spec, code_range_);
+    ASSERT_TRUE(
+        trainer.InitNetwork(full_spec, -1, 0, 1.0f, 1e-3f, 0.5f, 0.999f));
+    GenericVector<char> model_data;
+    trainer.SaveRecognitionDump(&model_data);
+    TFile fp;
+    fp.Open(&model_data[0], model_data.size());
+    ASSERT_TRUE(recognizer->DeSerialize(&mgr_, &fp));
+  }
+
+  // Runs recognizer on line with blank run compression off and then on, and
+  // returns the outputs of each.
+  static void RecognizeBothWays(Pix* line, LSTMRecognizer* recognizer,
+                                NetworkIO* plain_outputs,
+                                NetworkIO* compressed_outputs) {
+    ImageData image_data(false, pixClone(line));
+    float scale;
+    // The inputs can't be reused, as FromPix adds to their stride map.
+    NetworkIO plain_inputs, compressed_inputs;
+    recognizer->set_blank_run_compression(0);
+    ASSERT_TRUE(recognizer->RecognizeLine(image_data, false, false, false,
+                                          false, &scale, &plain_inputs,
+                                          plain_outputs));
+    recognizer->set_blank_run_compression(kMinRunHeights);
+    ASSERT_TRUE(recognizer->RecognizeLine(image_data, false, false, false,
+                                          false, &scale, &compressed_inputs,
+                                          compressed_outputs));
+    EXPECT_LT(compressed_inputs.Width(), plain_inputs.Width());
+  }
+
+  TRand random_;
+  TessdataManager mgr_;
+  int code_range_;
+};
+
+// The blank run and the underline are shortened, leaving only whole columns
+// of the original, and the dotted leader is kept in full.
+TEST_F(LSTMBlankRunsTest, ShortensBlankAndUnderlinedRuns) {
+  Pix* pix = FormLine(kNetworkHeight);
+  std::vector<std::pair<int, int>> gaps;
+  Pix* compressed = Input::CompressBlankRuns(
+      pix, kMinRunHeights * kNetworkHeight, kNetworkHeight, 1, &gaps);
+  ASSERT_TRUE(compressed != NULL);
+  EXPECT_EQ(2, gaps.size());
+  ExpectColumnsRemoved(pix, compressed, gaps);
+  // Each run keeps a separator of one line height.
+  int gap = kGapWidth * kNetworkHeight / kLineHeight;
+  for (size_t g = 0; g < gaps.size(); ++g)
+    EXPECT_GE(gaps[g].second, gap - kNetworkHeight - 2) << "gap " << g;
+  pixDestroy(&compressed);
+  pixDestroy(&pix);
+}
+
+// A dotted leader is not blank, however long, and nor is white on black
+// text, which is found with the opposite polarity.
+TEST_F(LSTMBlankRunsTest, KeepsDottedLeaders) {
+  int gap = 4 * kGapWidth * kNetworkHeight / kLineHeight;
+  Pix* pix = BlankLine(2 * kWordWidth * kNetworkHeight / kLineHeight + gap,
+                       kNetworkHeight);
+  int x = AddWord(pix, 0, kWordWidth);
+  AddLeader(pix, x, gap);
+  AddWord(pix, x + gap, kWordWidth);
+  std::vector<std::pair<int, int>> gaps;
+  EXPECT_TRUE(Input::CompressBlankRuns(pix, kMinRunHeights * kNetworkHeight,
+                                       kNetworkHeight, 1, &gaps) == NULL);
+  EXPECT_TRUE(gaps.empty());
+  pixInvert(pix, pix);
+  EXPECT_TRUE(Input::CompressBlankRuns(pix, kMinRunHeights * kNetworkHeight,
+                                       kNetworkHeight, 1, &gaps) == NULL);
+  pixDestroy(&pix);
+}
+
+// The timesteps removed from the network input are a multiple of the x
+// scale factor, and the kept columns are still those of the original.
+TEST_F(LSTMBlankRunsTest, AlignsCutsToXScale) {
+  const int kXScale = 4;
+  Pix* pix = FormLine(kNetworkHeight);
+  std::vector<std::pair<int, int>> gaps;
+  Pix* compressed = Input::CompressBlankRuns(
+      pix, kMinRunHeights * kNetworkHeight, kNetworkHeight, kXScale, &gaps);
+  ASSERT_TRUE(compressed != NULL);
+  ASSERT_EQ(2, gaps.size());
+  std::vector<std::pair<int, int>> column_gaps;
+  for (size_t g = 0; g < gaps.size(); ++g) {
+    column_gaps.push_back(std::make_pair(gaps[g].first * kXScale,
+                                         gaps[g].second * kXScale));
+  }
+  ExpectColumnsRemoved(pix, compressed, column_gaps);
+  pixDestroy(&compressed);
+  pixDestroy(&pix);
+}
+
+// With a network that only sees nearby columns, the outputs mapped back
+// from the compressed line are exactly those of the whole line, so the
+// recognized text and its boxes in image coordinates are unchanged. The
+// network has no Convolve, as that pads the image edges with random values,
+// the number of which depends on the line width.
+TEST_F(LSTMBlankRunsTest, RecognitionUnchanged) {
+  LSTMRecognizer recognizer;
+  MakeRecognizer("[1,16,0,1 Mp2,2 O1c%d]", &recognizer);
+  Pix* line = FormLine(kLineHeight);
+  NetworkIO plain_outputs, compressed_outputs;
+  RecognizeBothWays(line, &recognizer, &plain_outputs, &compressed_outputs);
+  ASSERT_EQ(plain_outputs.Width(), compressed_outputs.Width());
+  ASSERT_EQ(plain_outputs.NumFeatures(), compressed_outputs.NumFeatures());
+  std::vector<double> plain(plain_outputs.NumFeatures());
+  std::vector<double> compressed(compressed_outputs.NumFeatures());
+  for (int t = 0; t < plain_outputs.Width(); ++t) {
+    plain_outputs.ReadTimeStep(t, plain.data());
+    compressed_outputs.ReadTimeStep(t, compressed.data());
+    ASSERT_EQ(plain, compressed) << "timestep " << t;
+  }
+
+  TBOX line_box(0, 0, pixGetWidth(line), kLineHeight);
+  PointerVector<WERD_RES> plain_words, compressed_words;
+  recognizer.set_blank_run_compression(0);
+  recognizer.RecognizeLine(line, false, false, -20.0, line_box, &plain_words);
+  recognizer.set_blank_run_compression(kMinRunHeights);
+  recognizer.RecognizeLine(line, false, false, -20.0, line_box,
+                           &compressed_words);
+  ASSERT_FALSE(plain_words.empty());
+  ASSERT_EQ(plain_words.size(), compressed_words.size());
+  for (int w = 0; w < plain_words.size(); ++w) {
+    EXPECT_STREQ(plain_words[w]->best_choice->unichar_string().string(),
+                 compressed_words[w]->best_choice->unichar_string().string());
+    EXPECT_TRUE(plain_words[w]->word->bounding_box() ==
+                compressed_words[w]->word->bounding_box())
+        << "word " << w;
+  }
+  pixDestroy(&line);
+}
+
+// With a recurrent network the outputs still cover the whole line, and are
+// unchanged up to the first shortened run.
+TEST_F(LSTMBlankRunsTest, LSTMOutputsCoverWholeLine) {
+  LSTMRecognizer recognizer;
+  MakeRecognizer("[1,16,0,1 Lfx16 O1c%d]", &recognizer);
+  Pix* line = FormLine(kLineHeight);
+  NetworkIO plain_outputs, compressed_outputs;
+  RecognizeBothWays(line, &recognizer, &plain_outputs, &compressed_outputs);
+  ASSERT_EQ(plain_outputs.Width(), compressed_outputs.Width());
+  std::vector<double> plain(plain_outputs.NumFeatures());
+  std::vector<double> compressed(compressed_outputs.NumFeatures());
+  int first_run = kWordWidth * kNetworkHeight / kLineHeight;
+  for (int t = 0; t < first_run; ++t) {
+    plain_outputs.ReadTimeStep(t, plain.data());
+    compressed_outputs.ReadTimeStep(t, compressed.data());
+    ASSERT_EQ(plain, compressed) << "timestep " << t;
+  }
+  pixDestroy(&line);
+}
+
+}  // namespace
+}  // namespace tesseract
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////
+// File:        lstm_int_test.cc
+// Description: Tests the fixed point forward pass of a 1-D LSTM against
+//              the float forward pass of the same network.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "helpers.h"
+#include "include_gunit.h"
+#include "lstm.h"
+#include "networkio.h"
+#include "networkscratch.h"
+#include "stridemap.h"
+
+namespace tesseract {
+namespace {
+
+// Number of inputs and states of the test networks.
+const int kNumInputs = 16;
+const int kNumStates = 32;
+
+class LSTMIntTest : public ::testing::Test {
+ protected:
+  // Makes a random input in both float and int mode, with num_rows images of
+  // the given width, so the state is also reset between rows.
+  void MakeInputs(int num_rows, int width) {
+    std::vector<std::pair<int, int> > heights_widths;
+    for (int r = 0; r < num_rows; ++r)
+      heights_widths.push_back(std::make_pair(1, width));
+    StrideMap stride_map;
+    stride_map.SetStride(heights_widths);
+    float_input_.ResizeToMap(false, stride_map, kNumInputs);
+    int_input_.ResizeToMap(true, stride_map, kNumInputs);
+    std::vector<double> values(kNumInputs);
+    for (int t = 0; t < float_input_.Width(); ++t) {
+      for (int i = 0; i < kNumInputs; ++i)
+        values[i] = random_.SignedRand(1.0);
+      float_input_.WriteTimeStep(t, values.data());
+      int_input_.WriteTimeStep(t, values.data());
+    }
+  }
+
+  // Runs the float forward pass of a random network of the given type, then
+  // converts it to int and checks that the fixed point forward pass gives
+  // nearly the same outputs.
+  void ExpectIntMatchesFloat(NetworkType type) {
+    LSTM lstm("LSTM", kNumInputs, kNumStates, kNumStates, false, type);
+    lstm.SetEnableTraining(TS_ENABLED);
+    lstm.InitWeights(0.5, &random_);
+    lstm.SetEnableTraining(TS_DISABLED);
+    NetworkScratch float_scratch;
+    NetworkIO float_output;
+    lstm.Forward(false, float_input_, nullptr, &float_scratch, &float_output);
+    lstm.ConvertToInt();
+    NetworkScratch int_scratch;
+    int_scratch.set_int_mode(true);
+    NetworkIO int_output;
+    lstm.Forward(false, int_input_, nullptr, &int_scratch, &int_output);
+    EXPECT_TRUE(int_output.int_mode());
+    ASSERT_EQ(float_output.Width(), int_output.Width());
+    ASSERT_EQ(float_output.NumFeatures(), int_output.NumFeatures());
+    double total_error = 0.0;
+    double max_error = 0.0;
+    std::vector<double> float_values(kNumStates);
+    std::vector<double> int_values(kNumStates);
+    for (int t = 0; t < float_output.Width(); ++t) {
+      float_output.ReadTimeStep(t, float_values.data());
+      int_output.ReadTimeStep(t, int_values.data());
+      for (int i = 0; i < kNumStates; ++i) {
+        double error = fabs(float_values[i] - int_values[i]);
+        total_error += error;
+        if (error > max_error) max_error = error;
+      }
+    }
+    // The outputs have a resolution of 1/MAX_INT8, and the int weights and
+    // the tables add similar errors, which accumulate through the recurrence.
+    EXPECT_LT(total_error / (float_output.Width() * kNumStates), 0.005);
+    EXPECT_LT(max_error, 0.05);
+  }
+
+  TRand random_;
+  NetworkIO float_input_;
+  NetworkIO int_input_;
+};
+
+// Tests a plain 1-D LSTM over a single long row.
+TEST_F(LSTMIntTest, SingleRow) {
+  MakeInputs(1, 500);
+  ExpectIntMatchesFloat(NT_LSTM);
+}
+
+// Tests several rows, which requires the state to be reset at each row end.
+TEST_F(LSTMIntTest, MultipleRows) {
+  MakeInputs(4, 100);
+  ExpectIntMatchesFloat(NT_LSTM);
+}
+
+// Tests the summarizing LSTM, which only outputs at the end of each row.
+TEST_F(LSTMIntTest, Summary) {
+  MakeInputs(4, 100);
+  ExpectIntMatchesFloat(NT_LSTM_SUMMARY);
+}
+
+}  // namespace
+}  // namespace tesseract
@@ -0,0 +1,195 @@
+///////////////////////////////////////////////////////////////////////
+// File:        lstm_replicas_test.cc
+// Description: Tests the data-parallel training of LSTMTrainer, in which
+//              replicas compute the weight deltas that the master averages.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <vector>
+#include "allheaders.h"
+#include "helpers.h"
+#include "imagedata.h"
+#include "include_gunit.h"
+#include "lstmtrainer.h"
+#include "networkio.h"
+#include "serialis.h"
+#include "unicharcompress.h"
+#include "unicharset.h"
+
+namespace tesseract {
+namespace {
+
+// Size of the training image, and the network, which has no Adam, so the
+// step does not depend on the iteration count.
+const int kImageHeight = 16;
+const int kImageWidth = 64;
+const float kWeightRange = 0.5f;
+const float kLearningRate = 0.01f;
+const float kMomentum = 0.5f;
+const char kTruthText[] = "ab ba";
+const char kFilename[] = "lstm_replicas_test.lstmf";
+
+// Gives the test access to the replicas and the network of a trainer.
+class TestTrainer : public LSTMTrainer {
+ public:
+  TestTrainer()
+      : LSTMTrainer(NULL, NULL, NULL, NULL, "lstm_replicas_test",
+                    "lstm_replicas_test_checkpoint", 0, 0) {}
+
+  int num_replicas() const { return replicas_.size(); }
+  // Runs the network of the given replica, or of *this if replica is -1, on
+  // page and returns the outputs.
+  std::vector<float> Outputs(int replica, const ImageData& page) {
+    LSTMTrainer* trainer = replica < 0 ? this : replicas_[replica];
+    float scale;
+    NetworkIO inputs, outputs;
+    EXPECT_TRUE(trainer->RecognizeLine(page, false, false, false, false,
+                                       &scale, &inputs, &outputs));
+    std::vector<float> values;
+    std::vector<double> step(outputs.NumFeatures());
+    for (int t = 0; t < outputs.Width(); ++t) {
+      outputs.ReadTimeStep(t, step.data());
+      values.insert(values.end(), step.begin(), step.end());
+    }
+    return values;
+  }
+  // Replaces the network and training state with a dump, as a checkpoint
+  // revert does.
+  bool Revert(const GenericVector<char>& dump) {
+    return ReadTrainingDump(dump, this);
+  }
+};
+
+class LSTMReplicasTest : public ::testing::Test {
+ protected:
+  // Writes a one-page document of a random image with kTruthText, and sets
+  // up the charsets for kTruthText in mgr_.
+  void SetUp() override {
+    UNICHARSET unicharset;
+    unicharset.unichar_insert("a");
+    unicharset.unichar_insert("b");
+    GenericVector<char> unicharset_data;
+    TFile fp;
+    fp.OpenWrite(&unicharset_data);
+    ASSERT_TRUE(unicharset.save_to_file(&fp));
+    mgr_.OverwriteEntry(TESSDATA_LSTM_UNICHARSET, &unicharset_data[0],
+                        unicharset_data.size());
+    UnicharCompress recoder;
+    ASSERT_TRUE(recoder.ComputeEncoding(unicharset, UNICHAR_BROKEN, NULL));
+    GenericVector<char> recoder_data;
+    fp.OpenWrite(&recoder_data);
+    ASSERT_TRUE(recoder.Serialize(&fp));
+    mgr_.OverwriteEntry(TESSDATA_LSTM_RECODER, &recoder_data[0],
+                        recoder_data.size());
+    code_range_ = recoder.code_range();
+
+    TRand random;
+    Pix* pix = pixCreate(kImageWidth, kImageHeight, 8);
+    for (int y = 0; y < kImageHeight; ++y) {
+      for (int x = 0; x < kImageWidth; ++x)
+        pixSetPixel(pix, x, y, random.IntRand() % 256);
+    }
+    l_uint8* png_data = NULL;
+    size_t png_size = 0;
+    ASSERT_EQ(0, pixWriteMem(&png_data, &png_size, pix, IFF_PNG));
+    pixDestroy(&pix);
+    DocumentData doc("lstm_replicas_test");
+    doc.AddPageToDocument(ImageData::Build(
+        kFilename, 0, "eng", reinterpret_cast<const char*>(png_data),
+        png_size, kTruthText, NULL));
+    lept_free(png_data);
+    ASSERT_TRUE(doc.SaveDocument(kFilename, NULL));
+    // Both replicas read the same page, so the averaged deltas are exactly
+    // those of a single sample.
+    filenames_.push_back(STRING(kFilename));
+    filenames_.push_back(STRING(kFilename));
+  }
+  void TearDown() override { remove(kFilename); }
+
+  // Sets up trainer with a new random network.
+  void InitTrainer(TestTrainer* trainer) {
+    trainer->InitCharSet(mgr_);
+    char spec[64];
+    snprintf(spec, sizeof(spec), "[1,%d,0,1 Lfx16 O1c%d]", kImageHeight,
+             code_range_);
+    ASSERT_TRUE(trainer->InitNetwork(spec, -1, 0, kWeightRange, kLearningRate,
+                                     kMomentum, 0.999f));
+  }
+
+  // Checks that every replica of master has the weights of master.
+  void ExpectReplicasInSync(TestTrainer* master, const ImageData& page) {
+    std::vector<float> master_outputs = master->Outputs(-1, page);
+    for (int r = 0; r < master->num_replicas(); ++r)
+      EXPECT_EQ(master_outputs, master->Outputs(r, page)) << "replica " << r;
+  }
+
+  TessdataManager mgr_;
+  int code_range_;
+  GenericVector<STRING> filenames_;
+};
+
+// Replicas start with the weights of the master, keep them after each
+// parallel step, and take them again after the master network is replaced.
+TEST_F(LSTMReplicasTest, ReplicasStayInSync) {
+  TestTrainer master;
+  InitTrainer(&master);
+  GenericVector<char> initial;
+  ASSERT_TRUE(master.SaveTrainingDump(LIGHT, &master, &initial));
+  ASSERT_TRUE(master.InitReplicas(2, filenames_, CS_SEQUENTIAL, false, 0));
+  ASSERT_EQ(2, master.num_replicas());
+  const ImageData* page = master.GetSampleBySerial(0);
+  ASSERT_TRUE(page != NULL);
+  ExpectReplicasInSync(&master, *page);
+  std::vector<float> initial_outputs = master.Outputs(-1, *page);
+  for (int step = 0; step < 3; ++step) {
+    EXPECT_EQ(2, master.TrainOnLinesParallel());
+    ExpectReplicasInSync(&master, *page);
+  }
+  EXPECT_NE(initial_outputs, master.Outputs(-1, *page));
+  // After a revert the replicas are stale, and the next step starts from the
+  // reverted weights, not those the replicas still hold.
+  ASSERT_TRUE(master.Revert(initial));
+  EXPECT_EQ(initial_outputs, master.Outputs(-1, *page));
+  EXPECT_NE(initial_outputs, master.Outputs(0, *page));
+  EXPECT_EQ(2, master.TrainOnLinesParallel());
+  ExpectReplicasInSync(&master, *page);
+}
+
+// A parallel step over two copies of one sample gives the same weights as a
+// single trainer stepping on that sample, as the deltas are averaged.
+TEST_F(LSTMReplicasTest, AveragedDeltasMatchSingleStep) {
+  TestTrainer master;
+  InitTrainer(&master);
+  GenericVector<char> initial;
+  ASSERT_TRUE(master.SaveTrainingDump(LIGHT, &master, &initial));
+  TestTrainer single;
+  ASSERT_TRUE(master.ReadTrainingDump(initial, &single));
+  GenericVector<STRING> single_file;
+  single_file.push_back(STRING(kFilename));
+  ASSERT_TRUE(single.LoadAllTrainingData(single_file, CS_SEQUENTIAL, false));
+  ASSERT_TRUE(master.InitReplicas(2, filenames_, CS_SEQUENTIAL, false, 0));
+  const ImageData* page = single.GetSampleBySerial(0);
+  ASSERT_TRUE(page != NULL);
+  std::vector<float> initial_outputs = single.Outputs(-1, *page);
+  EXPECT_EQ(initial_outputs, master.Outputs(-1, *page));
+
+  EXPECT_EQ(2, master.TrainOnLinesParallel());
+  EXPECT_EQ(TRAINABLE, single.TrainOnLine(page, false));
+  std::vector<float> single_outputs = single.Outputs(-1, *page);
+  EXPECT_NE(initial_outputs, single_outputs);
+  EXPECT_EQ(single_outputs, master.Outputs(-1, *page));
+  ExpectReplicasInSync(&master, *page);
+}
+
+}  // namespace
+}  // namespace tesseract
@@ -84,7 +84,7 @@ void SVMutex::Unlock() {
 }
 
 // Create new thread.
-void SVSync::StartThread(void* (*func)(void*), void* arg) {
+bool SVSync::StartThread(void* (*func)(void*), void* arg) {
 #ifdef _WIN32
   LPTHREAD_START_ROUTINE f = (LPTHREAD_START_ROUTINE)func;
   DWORD threadid;
@@ -94,12 +94,51 @@ void SVSync::StartThread(void* (*func)(void*), void* arg) {
                                   arg,         // argument to thread function
                                   0,           // use default creation flags
                                   &threadid);  // returns the thread identifier
+  return newthread != NULL;
 #else
   pthread_t helper;
   pthread_attr_t attr;
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-  pthread_create(&helper, &attr, func, arg);
+  bool started = pthread_create(&helper, &attr, func, arg) == 0;
+  pthread_attr_destroy(&attr);
+  return started;
+#endif
+}
+
+SVSemaphore::SVSemaphore() {
+#ifdef _WIN32
+  semaphore_ = CreateSemaphore(0, 0, 10, 0);
+#elif defined(__APPLE__)
+  char name[50];
+  snprintf(name, sizeof(name), "%ld", random());
+  sem_unlink(name);
+  semaphore_ = sem_open(name, O_CREAT , S_IWUSR, 0);
+  if (semaphore_ == SEM_FAILED) {
+    perror("sem_open");
+  }
+#else
+  sem_init(&semaphore_, 0, 0);
+#endif
+}
+
+void SVSemaphore::Signal() {
+#ifdef _WIN32
+  ReleaseSemaphore(semaphore_, 1, NULL);
+#elif defined(__APPLE__)
+  sem_post(semaphore_);
+#else
+  sem_post(&semaphore_);
+#endif
+}
+
+void SVSemaphore::Wait() {
+#ifdef _WIN32
+  WaitForSingleObject(semaphore_, INFINITE);
+#elif defined(__APPLE__)
+  sem_wait(semaphore_);
+#else
+  sem_wait(&semaphore_);
 #endif
 }
 
@@ -170,42 +209,6 @@ void SVSync::StartProcess(const char* executable, const char* args) {
 #endif
 }
 
-SVSemaphore::SVSemaphore() {
-#ifdef _WIN32
-  semaphore_ = CreateSemaphore(0, 0, 10, 0);
-#elif defined(__APPLE__)
-  char name[50];
-  snprintf(name, sizeof(name), "%ld", random());
-  sem_unlink(name);
-  semaphore_ = sem_open(name, O_CREAT , S_IWUSR, 0);
-  if (semaphore_ == SEM_FAILED) {
-    perror("sem_open");
-  }
-#else
-  sem_init(&semaphore_, 0, 0);
-#endif
-}
-
-void SVSemaphore::Signal() {
-#ifdef _WIN32
-  ReleaseSemaphore(semaphore_, 1, NULL);
-#elif defined(__APPLE__)
-  sem_post(semaphore_);
-#else
-  sem_post(&semaphore_);
-#endif
-}
-
-void SVSemaphore::Wait() {
-#ifdef _WIN32
-  WaitForSingleObject(semaphore_, INFINITE);
-#elif defined(__APPLE__)
-  sem_wait(semaphore_);
-#else
-  sem_wait(&semaphore_);
-#endif
-}
-
 // Place a message in the message buffer (and flush it).
 void SVNetwork::Send(const char* msg) {
   mutex_send_.Lock();
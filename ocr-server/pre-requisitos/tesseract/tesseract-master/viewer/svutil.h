@@ -57,8 +57,8 @@
 /// The SVSync class provides functionality for Thread & Process Creation
 class SVSync {
  public:
-  /// Create new thread.
-  static void StartThread(void *(*func)(void*), void* arg);
+  /// Create new thread. Returns false if it could not be started.
+  static bool StartThread(void *(*func)(void*), void* arg);
   /// Signals a thread to exit.
   static void ExitThread();
   /// Starts a new process.